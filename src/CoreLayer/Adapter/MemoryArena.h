@@ -0,0 +1,142 @@
+/**
+ * @file MemoryArena.h
+ * @author agent
+ * @brief Bump allocator for short-lived per-thread objects such as BxDFs.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+/// @brief Allocation is a pointer bump inside a retained block; memory is reclaimed all at once by reset().
+/// Objects are handed out through ArenaAllocator, which counts the live ones, so reset() only rewinds
+/// when every object has been released and a shared_ptr that outlives a reset stays valid.
+/// @note Not thread safe: each render thread owns its arena, and objects must be released on that thread.
+class MemoryArena {
+    template<typename T>
+    friend class ArenaAllocator;
+
+public:
+    explicit MemoryArena(size_t _blockSize = 64 * 1024) : blockSize(_blockSize) { }
+
+    MemoryArena(const MemoryArena &) = delete;
+
+    MemoryArena &operator=(const MemoryArena &) = delete;
+
+    ~MemoryArena() {
+        // leak rather than free memory something still points to
+        if (outstanding != 0) return;
+        for (auto &block : blocks)
+            ::operator delete(block.data);
+    }
+
+    void *allocate(size_t bytes, size_t align) {
+        while (true) {
+            if (blockIndex < blocks.size()) {
+                const Block &block = blocks[blockIndex];
+                uintptr_t base = reinterpret_cast<uintptr_t>(block.data);
+                uintptr_t p = (base + used + align - 1) & ~uintptr_t(align - 1);
+                if (p + bytes <= base + block.size) {
+                    used = p + bytes - base;
+                    return reinterpret_cast<void *>(p);
+                }
+                // move on to the next retained block, or a new one
+                ++blockIndex;
+                used = 0;
+                continue;
+            }
+            size_t size = std::max(blockSize, bytes + align);
+            blocks.push_back({static_cast<char *>(::operator new(size)), size});
+        }
+    }
+
+    /// @brief rewind to the first block.
+    /// @return false, without rewinding, while objects from this arena are still alive.
+    bool reset() {
+        if (outstanding != 0) return false;
+        blockIndex = 0;
+        used = 0;
+        return true;
+    }
+
+    size_t getReservedBytes() const {
+        size_t bytes = 0;
+        for (const auto &block : blocks)
+            bytes += block.size;
+        return bytes;
+    }
+
+    /// @brief arena of the calling thread, null outside of a Scope.
+    static MemoryArena *current() { return currentArena; }
+
+    /// @brief makes an arena the current one of the calling thread for the lifetime of the scope.
+    class Scope {
+    public:
+        explicit Scope(MemoryArena &arena) : previous(currentArena) { currentArena = &arena; }
+
+        ~Scope() { currentArena = previous; }
+
+        Scope(const Scope &) = delete;
+
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        MemoryArena *previous;
+    };
+
+private:
+    struct Block {
+        char *data;
+        size_t size;
+    };
+
+    static inline thread_local MemoryArena *currentArena = nullptr;
+
+    std::vector<Block> blocks;
+    size_t blockIndex = 0, used = 0;
+    size_t blockSize;
+    int64_t outstanding = 0;
+};
+
+/// @brief std allocator over a MemoryArena, for std::allocate_shared. Deallocation only updates the live count.
+template<typename T>
+class ArenaAllocator {
+    template<typename U>
+    friend class ArenaAllocator;
+
+public:
+    using value_type = T;
+
+    explicit ArenaAllocator(MemoryArena *_arena) : arena(_arena) { }
+
+    template<typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) { }
+
+    T *allocate(size_t n) {
+        ++arena->outstanding;
+        return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *, size_t) {
+        --arena->outstanding;
+    }
+
+    template<typename U>
+    bool operator==(const ArenaAllocator<U> &other) const { return arena == other.arena; }
+
+    template<typename U>
+    bool operator!=(const ArenaAllocator<U> &other) const { return arena != other.arena; }
+
+private:
+    MemoryArena *arena;
+};
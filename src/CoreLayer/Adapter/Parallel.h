@@ -0,0 +1,42 @@
+/**
+ * @file Parallel.h
+ * @author agent
+ * @brief Minimal parallel loop for scene setup work.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+/// @brief Run func(i) for every i in [begin, end), split into contiguous chunks over the hardware threads.
+/// @note Meant for preprocessing before rendering starts; func must be safe to call concurrently.
+template<typename Func>
+void parallelFor(int begin, int end, const Func &func) {
+    int count = end - begin;
+    if (count <= 0) return;
+    int threadNum = std::min<int>(count, std::max(1u, std::thread::hardware_concurrency()));
+    if (threadNum == 1) {
+        for (int i = begin; i < end; ++i) func(i);
+        return;
+    }
+    std::vector<std::thread> threads;
+    threads.reserve(threadNum);
+    for (int t = 0; t < threadNum; ++t) {
+        int chunkBegin = begin + int(int64_t(count) * t / threadNum);
+        int chunkEnd = begin + int(int64_t(count) * (t + 1) / threadNum);
+        threads.emplace_back([chunkBegin, chunkEnd, &func] {
+            for (int i = chunkBegin; i < chunkEnd; ++i) func(i);
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+}
@@ -15,6 +15,7 @@
 #include <cfloat>
 #include "CoreLayer/Math/Common.h"
 #include "FastMath.h"
+#include "SpectrumSIMD.h"
 
 class RGB3;
 class XYZ3;
@@ -29,8 +30,8 @@ using Spectrum = SampledSpectrum;
 using Spectrum = RGBSpectrum;
 #endif
 
-static const double sampledLambdaStart = 400.0;
-static const double sampledLambdaEnd = 700.0;
+static constexpr double sampledLambdaStart = 400.0;
+static constexpr double sampledLambdaEnd = 700.0;
 
 // The number of uniform samples for SampledSpectrum.
 #define SPECTRUM_SAMPLES CMAKE_DEF_SPECTRUM_SAMPLES
@@ -43,6 +44,80 @@ static const int nSpectrumSamples = 3;
 /// \brief types of spectrum. different strategies will be applied.
 enum class SpectrumType { REFLECTANCE, ILLUMINANT };
 
+#ifdef USING_HERO_WAVELENGTHS
+#ifndef USING_SAMPLED_SPECTRUM
+#error "USING_HERO_WAVELENGTHS requires USING_SAMPLED_SPECTRUM"
+#endif
+
+/**
+ * @brief Hero wavelength sampling over the bins of SampledSpectrum.
+ * A camera sample carries count bins spread evenly over the spectrum, the first one (the hero) chosen
+ * uniformly. Inside a Scope the SampledSpectrum operators only touch these bins, and estimates over the
+ * whole spectrum (sum, luminance, toXYZ3) scale them by nSpectrumSamples / count. Every bin is carried
+ * with the same probability, so the film accumulates the bins themselves, see Film::deposit.
+ * Outside of a scope (scene loading, film output) spectra are processed in full.
+ */
+struct HeroWavelengths
+{
+	static constexpr int count = 4;
+	static_assert(nSpectrumSamples % count == 0, "the spectrum must split into count strata");
+
+	int bins[count];	///< bins[0] is the hero
+
+	/// @brief path state, set once a vertex of the camera sample dropped the secondary wavelengths.
+	/// Mutable as the wavelengths are only reachable through current().
+	mutable bool secondaryTerminated = false;
+
+	/// @param u uniform sample in [0, 1)
+	static HeroWavelengths sample(double u) {
+		HeroWavelengths hero;
+		int start = std::min(int(u * nSpectrumSamples), nSpectrumSamples - 1);
+		for (int k = 0; k < count; k++)
+			hero.bins[k] = (start + k * (nSpectrumSamples / count)) % nSpectrumSamples;
+		return hero;
+	}
+
+	/// @brief wavelength at the center of a bin, in nm.
+	static double lambda(int bin) {
+		return sampledLambdaStart + (bin + 0.5) * (sampledLambdaEnd - sampledLambdaStart) / nSpectrumSamples;
+	}
+
+	double heroLambda() const { return lambda(bins[0]); }
+
+	/// @brief drop the secondary wavelengths for the rest of the path, see SampledSpectrum::terminateSecondary.
+	/// @return the factor for the hero bin: count the first time, so that the estimate stays unbiased, 1 after
+	/// that since the path throughput already carries it.
+	double terminateSecondary() const {
+		double heroScale = secondaryTerminated ? 1.0 : double(count);
+		secondaryTerminated = true;
+		return heroScale;
+	}
+
+	/// @brief wavelengths of the calling thread, null outside of a Scope.
+	static const HeroWavelengths *current() { return currentWavelengths; }
+
+	/// @brief makes a set of wavelengths the current one of the calling thread for the lifetime of the scope.
+	class Scope {
+	public:
+		explicit Scope(const HeroWavelengths &wavelengths) : previous(currentWavelengths) {
+			currentWavelengths = &wavelengths;
+		}
+
+		~Scope() { currentWavelengths = previous; }
+
+		Scope(const Scope &) = delete;
+
+		Scope &operator=(const Scope &) = delete;
+
+	private:
+		const HeroWavelengths *previous;
+	};
+
+private:
+	static inline thread_local const HeroWavelengths *currentWavelengths = nullptr;
+};
+#endif
+
 
 /**
  * @brief Classical rgb color space
@@ -141,21 +216,101 @@ template <int nSamples>
 class CoefficientSpectrum
 {
 protected:
-	double coefficients[nSamples];
+	/// @brief aligned to the SIMD width, see SpectrumSIMD.h
+	alignas(SpectrumSIMD::alignment(nSamples)) double coefficients[nSamples];
+
+	/// @brief Leaves the coefficients uninitialized, for results that are written in full right away.
+	struct Uninitialized {};
+	explicit CoefficientSpectrum(Uninitialized) {}
+
+	/// @brief bins the operators touch, null for all of them (see HeroWavelengths).
+	static const int *activeBins() {
+#ifdef USING_HERO_WAVELENGTHS
+		if (nSamples == nSpectrumSamples && HeroWavelengths::current())
+			return HeroWavelengths::current()->bins;
+#endif
+		return nullptr;
+	}
+
+	/// @brief number of bins returned by activeBins.
+	static constexpr int activeCount() {
+#ifdef USING_HERO_WAVELENGTHS
+		return HeroWavelengths::count;
+#else
+		return nSamples;
+#endif
+	}
+
+	template <typename Op>
+	static void binary(double *dst, const double *a, const double *b, Op op) {
+		if (const int *bins = activeBins()) {
+			for (int k = 0; k < activeCount(); k++)
+				dst[bins[k]] = op(a[bins[k]], b[bins[k]]);
+			return;
+		}
+		SpectrumSIMD::binary<nSamples>(dst, a, b, op);
+	}
+
+	template <typename Op>
+	static void scalar(double *dst, const double *a, double v, Op op) {
+		if (const int *bins = activeBins()) {
+			for (int k = 0; k < activeCount(); k++)
+				dst[bins[k]] = op(a[bins[k]], v);
+			return;
+		}
+		SpectrumSIMD::scalar<nSamples>(dst, a, v, op);
+	}
+
+	/// @brief dst[i] = op(a[i]) over the active bins.
+	template <typename Op>
+	static void unary(double *dst, const double *a, Op op) {
+		if (const int *bins = activeBins()) {
+			for (int k = 0; k < activeCount(); k++)
+				dst[bins[k]] = op(a[bins[k]]);
+			return;
+		}
+		for (int i = 0; i < nSamples; i++)
+			dst[i] = op(a[i]);
+	}
+
+	/// @return true if pred holds for any active bin.
+	template <typename Pred>
+	bool any(Pred pred) const {
+		if (const int *bins = activeBins()) {
+			for (int k = 0; k < activeCount(); k++)
+				if (pred(coefficients[bins[k]]))
+					return true;
+			return false;
+		}
+		for (int i = 0; i < nSamples; i++)
+			if (pred(coefficients[i]))
+				return true;
+		return false;
+	}
+
+	template <typename Op>
+	CoefficientSpectrum apply(const CoefficientSpectrum&s, Op op) const {
+		CoefficientSpectrum retVal{Uninitialized{}};
+		binary(retVal.coefficients, coefficients, s.coefficients, op);
+		return retVal;
+	}
+
+	template <typename Op>
+	CoefficientSpectrum apply(double v, Op op) const {
+		CoefficientSpectrum retVal{Uninitialized{}};
+		scalar(retVal.coefficients, coefficients, v, op);
+		return retVal;
+	}
 
 public:
 	/// @brief All coefficients initialized as 0.0f.
 	CoefficientSpectrum() {
-		for (int i = 0; i < nSamples; i++) {
-			coefficients[i] = 0.0;
-		}
+		SpectrumSIMD::fill<nSamples>(coefficients, 0.0);
 	}
 
 	/// @brief All coefficients initialized as val.
 	CoefficientSpectrum(double val) {
-		for (int i = 0; i < nSamples; i++) {
-			coefficients[i] = val;
-		}
+		SpectrumSIMD::fill<nSamples>(coefficients, val);
 	}
 
 	/// @brief Access the value of the spectrum at the ith sample point
@@ -172,109 +327,87 @@ public:
 
 	/// @brief Each component of the two spectra is added correspondingly
 	CoefficientSpectrum operator+(const CoefficientSpectrum&s) const {
-		CoefficientSpectrum retVal = *this;
-		for (int i = 0; i < nSamples; i++) {
-			retVal.coefficients[i] += s.coefficients[i];
-		}
-		return retVal;
+		return apply(s, [](auto a, auto b) { return a + b; });
 	}
 
 	/// @brief Subtract each component of the two spectra
 	CoefficientSpectrum operator-(const CoefficientSpectrum&s) const {
-		CoefficientSpectrum retVal = *this;
-		for (int i = 0; i < nSamples; i++) {
-			retVal.coefficients[i] -= s.coefficients[i];
-		}
-		return retVal;
+		return apply(s, [](auto a, auto b) { return a - b; });
 	}
 
 	/// @brief Each component of the two spectra is multiplied correspondingly
 	CoefficientSpectrum operator*(const CoefficientSpectrum&s) const {
-		CoefficientSpectrum retVal = *this;
-		for (int i = 0; i < nSamples; i++) {
-			retVal.coefficients[i] *= s.coefficients[i];
-		}
-		return retVal;
+		return apply(s, [](auto a, auto b) { return a * b; });
 	}
 
 	/// @brief Each component of the spectra is divided by the corresponding component of the other spectra
 	/// @attention There may be NaNs in result
 	CoefficientSpectrum operator/(const CoefficientSpectrum&s) const {
-		CoefficientSpectrum retVal = *this;
-		for (int i = 0; i < nSamples; i++) {
-			retVal.coefficients[i] /= s.coefficients[i];	// NaN
-		}
-		return retVal;
+		return apply(s, [](auto a, auto b) { return a / b; });	// NaN
 	}
 
 	/// @brief Each component of the two spectra is added correspondingly
 	CoefficientSpectrum& operator+=(const CoefficientSpectrum&s) {
-		for (int i = 0; i < nSamples; i++) {
-			this->coefficients[i] += s.coefficients[i];
-		}
+		binary(coefficients, coefficients, s.coefficients, [](auto a, auto b) { return a + b; });
 		return *this;
 	}
 
 	/// @brief Subtract each component of the two spectra
 	CoefficientSpectrum& operator-=(const CoefficientSpectrum&s) {
-		for (int i = 0; i < nSamples; i++) {
-			this->coefficients[i] -= s.coefficients[i];
-		}
+		binary(coefficients, coefficients, s.coefficients, [](auto a, auto b) { return a - b; });
 		return *this;
 	}
 
 	/// @brief Each component of the two spectra is multiplied correspondingly
 	CoefficientSpectrum& operator*=(const CoefficientSpectrum&s) {
-		for (int i = 0; i < nSamples; i++) {
-			this->coefficients[i] *= s.coefficients[i];
-		}
+		binary(coefficients, coefficients, s.coefficients, [](auto a, auto b) { return a * b; });
 		return *this;
 	}
 
 	/// @attention There may be NaNs in result
 	CoefficientSpectrum& operator/=(const CoefficientSpectrum&s) {
-		for (int i = 0; i < nSamples; i++) {
-			this->coefficients[i] /= s.coefficients[i];	// NaN
-		}
+		binary(coefficients, coefficients, s.coefficients, [](auto a, auto b) { return a / b; });	// NaN
 		return *this;
 	}
 
 	/// @brief Scale each component of the spectra (multiple by v)
 	CoefficientSpectrum operator*(double v) const {
-		CoefficientSpectrum retVal = *this;
-		for (int i = 0; i < nSamples; i++) {
-			retVal.coefficients[i] *= v;
-		}
-		return retVal;
+		return apply(v, [](auto a, double v) { return a * v; });
 	}
 
 	/// @brief Scale each component of the spectra (divide v)
 	/// @attention There may be NaNs in result
 	CoefficientSpectrum operator/(double v) const {
-		CoefficientSpectrum retVal = *this;
-		for (int i = 0; i < nSamples; i++) {
-			retVal.coefficients[i] /= v;	// NaN
-		}
-		return retVal;
+		return apply(v, [](auto a, double v) { return a / v; });	// NaN
 	}
 
 	/// @brief Scale each component of the spectra (multiple by v)
 	CoefficientSpectrum& operator*=(double v) {
-		for (int i = 0; i < nSamples; i++) {
-			this->coefficients[i] *= v;
-		}
+		scalar(coefficients, coefficients, v, [](auto a, double v) { return a * v; });
 		return *this;
 	}
 
 	/// @brief Scale each component of the spectra (divide v)
 	/// @attention There may be NaNs in result
 	CoefficientSpectrum& operator/=(double v) {
-		for (int i = 0; i < nSamples; i++) {
-			this->coefficients[i] /= v;	// NaN
-		}
+		scalar(coefficients, coefficients, v, [](auto a, double v) { return a / v; });	// NaN
 		return *this;
 	}
 
+	/// @brief a * b + c in one pass, with fused multiply-adds where the target has them
+	friend CoefficientSpectrum fma(const CoefficientSpectrum& a, const CoefficientSpectrum& b, const CoefficientSpectrum& c) {
+		CoefficientSpectrum ret{Uninitialized{}};
+		if (const int *bins = activeBins()) {
+			for (int k = 0; k < activeCount(); k++) {
+				int i = bins[k];
+				ret.coefficients[i] = a.coefficients[i] * b.coefficients[i] + c.coefficients[i];
+			}
+			return ret;
+		}
+		SpectrumSIMD::fma<nSamples>(ret.coefficients, a.coefficients, b.coefficients, c.coefficients);
+		return ret;
+	}
+
 	/// @brief Scale each component of the spectra (multiple by v)
 	friend CoefficientSpectrum operator*(double v, const CoefficientSpectrum& s) {
 		return s * v;
@@ -284,42 +417,32 @@ public:
 	/// @attention Does not check whether the value on each component is greater than zero
 	friend CoefficientSpectrum sqrt(const CoefficientSpectrum& s) {
 		CoefficientSpectrum ret;
-		for (int i = 0; i < nSamples; i++)
-			ret[i] = fm::sqrt(s[i]);
+		unary(ret.coefficients, s.coefficients, [&](double x) { return fm::sqrt(x); });
 		return ret;
 	}
 
 	/// @brief Call fm::pow() on each component
 	friend CoefficientSpectrum pow(const CoefficientSpectrum&s, double e) {
 		CoefficientSpectrum ret;
-		for (int i = 0; i < nSamples; i++)
-			ret[i] = fm::pow(s[i], e);
+		unary(ret.coefficients, s.coefficients, [&](double x) { return fm::pow(x, e); });
 		return ret;
 	}
 
 	/// @brief Call fm::exp() on each component
 	friend CoefficientSpectrum exp(const CoefficientSpectrum&s) {
 		CoefficientSpectrum ret;
-		for (int i = 0; i < nSamples; i++)
-			ret[i] = fm::exp(s[i]);
+		unary(ret.coefficients, s.coefficients, [&](double x) { return fm::exp(x); });
 		return ret;
 	}
 
 	/// @brief Returns true if all components are not equal to zero
 	bool isBlack() const {
-		for (int i = 0; i < nSamples; i++) {
-			if (coefficients[i] != 0.0) 
-				return false;
-		}
-		return true;
+		return !any([](double x) { return x != 0.0; });
 	}
 
 	/// @brief Returns true if any component is NaN
 	bool hasNaN() const {
-		for (int i = 0; i <nSamples; i++)
-			if (std::isnan(coefficients[i]))
-				return true;
-		return false;
+		return any([](double x) { return std::isnan(x); });
 	}
 
 	/// @brief Clamp each component of the spectra to a given range
@@ -327,20 +450,23 @@ public:
 	/// @param high Upper bound of the range (default max of double)
 	inline CoefficientSpectrum clamp(double low = 0.0, double high = DBL_MAX) const {
 		CoefficientSpectrum retVal;
-		for (int i = 0; i < nSamples; i++) {
-			retVal[i] = (coefficients[i]>low)?(coefficients[i]):(low);
-			retVal[i] = (coefficients[i]<high)?(retVal[i]):(high);
-		}
+		unary(retVal.coefficients, coefficients, [&](double x) {
+			double y = (x>low)?(x):(low);
+			return (x<high)?(y):(high);
+		});
 		return retVal;
 	}
 
 	/// @brief Returns the summary of each component
+	/// @note With hero wavelengths, an estimate from the active bins
 	double sum() const {
-		double sum = 0;
-		for (int i = 0; i < nSamples; i++) {
-			sum += coefficients[i];
+		if (const int *bins = activeBins()) {
+			double s = 0;
+			for (int k = 0; k < activeCount(); k++)
+				s += coefficients[bins[k]];
+			return s * nSamples / activeCount();
 		}
-		return sum;
+		return SpectrumSIMD::sum<nSamples>(coefficients);
 	}
 
 	/// @brief Returns the average of each component
@@ -393,38 +519,20 @@ struct SpectrumSample
 class SampledSpectrum
 	: public CoefficientSpectrum<nSpectrumSamples>
 {
-	// these spectrums should be calculated at compile time.
-	static SampledSpectrum X;
-	static SampledSpectrum Y;
-	static SampledSpectrum Z;
-
-	static SampledSpectrum rgbRefl2SpectWhite;
-	static SampledSpectrum rgbRefl2SpectCyan;
-	static SampledSpectrum rgbRefl2SpectMagenta;
-	static SampledSpectrum rgbRefl2SpectYellow;
-	static SampledSpectrum rgbRefl2SpectRed;
-	static SampledSpectrum rgbRefl2SpectGreen;
-	static SampledSpectrum rgbRefl2SpectBlue;
-
-	static SampledSpectrum rgbIllum2SpectWhite;
-	static SampledSpectrum rgbIllum2SpectCyan;
-	static SampledSpectrum rgbIllum2SpectMagenta;
-	static SampledSpectrum rgbIllum2SpectYellow;
-	static SampledSpectrum rgbIllum2SpectRed;
-	static SampledSpectrum rgbIllum2SpectGreen;
-	static SampledSpectrum rgbIllum2SpectBlue;
-
 public:
 	friend class RGB3;
 	friend class XYZ3;
 
 	/// \brief Global init of static values. should be called before any constructor of SampledSpectrum.
+	/// The CIE curves are binned at compile time, and the rgb to spectrum table fitted at build time
+	/// (see tools/RGBToSpectrumTable), so this only points at the table unless the build fits it here.
 	static void init();
 
 	SampledSpectrum();
 
 	SampledSpectrum(double val);
 
+	/// @brief Sigmoid-polynomial upsampling of rgb, only the active bins are evaluated.
 	SampledSpectrum(const RGB3& rgb,SpectrumType type=SpectrumType::REFLECTANCE);
 
 	SampledSpectrum(const CoefficientSpectrum& s);
@@ -437,6 +545,12 @@ public:
 	virtual RGB3 toRGB3() const override;
 
     virtual double luminance() const override;
+
+#ifdef USING_HERO_WAVELENGTHS
+	/// @brief Keep only the hero bin, scaled by heroScale from HeroWavelengths::terminateSecondary.
+	/// For events whose sampling depends on the wavelength, such as dispersion.
+	void terminateSecondary(double heroScale);
+#endif
 };
 
 /// @brief RGB spectrum. The value of RGB spectrum is the same as RGB3.
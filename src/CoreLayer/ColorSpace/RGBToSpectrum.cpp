@@ -0,0 +1,151 @@
+/**
+ * @file RGBToSpectrum.cpp
+ * @author agent
+ * @brief Fitting of the sigmoid-polynomial table.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ *
+ */
+
+#include "RGBToSpectrum.h"
+#include "CoreLayer/Math/Common.h"
+#include <algorithm>
+
+namespace {
+
+double smoothStep(double x) {
+    return x * x * (3 - 2 * x);
+}
+
+/// @brief rgb of the spectrum given by coefficients c.
+struct SigmoidFit {
+    const std::vector<double> *rgbWeights;
+    const std::vector<double> &lambdas;
+
+    void rgb(const double c[3], double out[3]) const {
+        out[0] = out[1] = out[2] = 0;
+        for (size_t i = 0; i < lambdas.size(); i++) {
+            // evaluated in double, the finite differences below need the precision
+            double v = (c[0] * lambdas[i] + c[1]) * lambdas[i] + c[2];
+            double s = 0.5 + v / (2 * std::sqrt(1 + v * v));
+            for (int k = 0; k < 3; k++)
+                out[k] += rgbWeights[k][i] * s;
+        }
+    }
+
+    /// @brief Gauss-Newton on the rgb residual, starting from c.
+    void solve(const double target[3], double c[3]) const {
+        for (int iteration = 0; iteration < 30; iteration++) {
+            double r[3];
+            rgb(c, r);
+            for (int k = 0; k < 3; k++)
+                r[k] -= target[k];
+            if (r[0] * r[0] + r[1] * r[1] + r[2] * r[2] < 1e-12)
+                break;
+
+            double J[3][3];
+            const double eps = 1e-5;
+            for (int j = 0; j < 3; j++) {
+                double cp[3] = {c[0], c[1], c[2]}, cm[3] = {c[0], c[1], c[2]};
+                cp[j] += eps;
+                cm[j] -= eps;
+                double rp[3], rm[3];
+                rgb(cp, rp);
+                rgb(cm, rm);
+                for (int k = 0; k < 3; k++)
+                    J[k][j] = (rp[k] - rm[k]) / (2 * eps);
+            }
+
+            // J d = r by Cramer's rule
+            auto det3 = [](const double m[3][3]) {
+                return m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+                       - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+                       + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+            };
+            double det = det3(J);
+            if (std::abs(det) < 1e-30)
+                break;
+            for (int j = 0; j < 3; j++) {
+                double Jj[3][3];
+                for (int k = 0; k < 3; k++)
+                    for (int l = 0; l < 3; l++)
+                        Jj[k][l] = l == j ? r[k] : J[k][l];
+                c[j] -= det3(Jj) / det;
+            }
+
+            // keep the sigmoid away from overflow, the spectrum is a box at this point anyway
+            double maxCoefficient = std::max({std::abs(c[0]), std::abs(c[1]), std::abs(c[2])});
+            if (maxCoefficient > 200)
+                for (int j = 0; j < 3; j++)
+                    c[j] *= 200 / maxCoefficient;
+        }
+    }
+};
+
+}// namespace
+
+void RGBToSpectrumTable::fit(const std::vector<double> rgbWeights[3], const std::vector<double> &lambdas,
+                             float *zNodes, float *coefficients)
+{
+    for (int k = 0; k < resolution; k++)
+        zNodes[k] = smoothStep(smoothStep(double(k) / (resolution - 1)));
+
+    SigmoidFit fit{rgbWeights, lambdas};
+    //* every (x, y) column is fitted along z from a mid brightness outwards, each cell starting from its
+    //* neighbour, so the columns are independent
+#pragma omp parallel for collapse(2) schedule(dynamic)
+    for (int l = 0; l < 3; l++) {
+        for (int j = 0; j < resolution; j++) {
+            double y = double(j) / (resolution - 1);
+            for (int i = 0; i < resolution; i++) {
+                double x = double(i) / (resolution - 1);
+                auto fitCell = [&](int k, double c[3]) {
+                    double target[3];
+                    target[l] = zNodes[k];
+                    target[(l + 1) % 3] = x * zNodes[k];
+                    target[(l + 2) % 3] = y * zNodes[k];
+                    fit.solve(target, c);
+                    for (int n = 0; n < 3; n++)
+                        coefficients[index(l, k, j, i) + n] = c[n];
+                };
+                const int start = resolution / 5;
+                double c[3] = {0, 0, 0};
+                for (int k = start; k < resolution; k++)
+                    fitCell(k, c);
+                for (int n = 0; n < 3; n++)
+                    c[n] = coefficients[index(l, start, j, i) + n];
+                for (int k = start - 1; k >= 0; k--)
+                    fitCell(k, c);
+            }
+        }
+    }
+}
+
+RGBSigmoidPolynomial RGBToSpectrumTable::lookup(const double v[3]) const
+{
+    int l = 0;
+    if (v[1] > v[l]) l = 1;
+    if (v[2] > v[l]) l = 2;
+    double z = v[l];
+    double x = std::min(v[(l + 1) % 3] / z, 1.0) * (resolution - 1);
+    double y = std::min(v[(l + 2) % 3] / z, 1.0) * (resolution - 1);
+    int xi = std::min(int(x), resolution - 2), yi = std::min(int(y), resolution - 2);
+    int zi = std::clamp(int(std::upper_bound(zNodes, zNodes + resolution, float(z)) - zNodes) - 1, 0, resolution - 2);
+    float dx = x - xi, dy = y - yi;
+    float dz = std::min((z - zNodes[zi]) / (zNodes[zi + 1] - zNodes[zi]), 1.0);
+
+    const int sx = 3, sy = 3 * resolution, sz = 3 * resolution * resolution;
+    const float *base = &coefficients[index(l, zi, yi, xi)];
+    float c[3];
+    for (int n = 0; n < 3; n++) {
+        const float *p = base + n;
+        float c00 = p[0] + dx * (p[sx] - p[0]), c01 = p[sy] + dx * (p[sy + sx] - p[sy]);
+        float c10 = p[sz] + dx * (p[sz + sx] - p[sz]), c11 = p[sz + sy] + dx * (p[sz + sy + sx] - p[sz + sy]);
+        float c0 = c00 + dy * (c01 - c00), c1 = c10 + dy * (c11 - c10);
+        c[n] = c0 + dz * (c1 - c0);
+    }
+    return {c[0], c[1], c[2]};
+}
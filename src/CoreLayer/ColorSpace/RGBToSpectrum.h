@@ -0,0 +1,85 @@
+/**
+ * @file RGBToSpectrum.h
+ * @author agent
+ * @brief Sigmoid-polynomial rgb to spectrum conversion.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ *
+ */
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+/// @brief Smooth bounded spectrum sigmoid(c0 x^2 + c1 x + c2), x the wavelength mapped to [0, 1] over
+/// the sampled range. Jakob, W. and Hanika, J. 2019. A Low-Dimensional Function Space for Efficient
+/// Spectral Upsampling. Computer Graphics Forum 38 (2).
+struct RGBSigmoidPolynomial
+{
+	float c0 = 0, c1 = 0, c2 = 0;
+
+	/// @note evaluated in float, which is plenty for a spectrum and twice as wide in SIMD
+	float operator()(float x) const {
+		float v = (c0 * x + c1) * x + c2;
+		return 0.5f + v / (2 * std::sqrt(1 + v * v));
+	}
+};
+
+/// @brief Sigmoid-polynomial coefficients over the rgb cube, fitted for the sampled spectrum.
+/// The cube is split by its largest component, each part sampled on a resolution^3 grid over the
+/// largest component (denser near 0 and 1) and the ratios of the other two to it.
+/// A lookup is a trilinear interpolation of 3 coefficients, so rgb inputs (texels, constants) stay rgb
+/// and only the wavelengths in flight are evaluated.
+/// The fit takes a while, so the build runs it once for the configured sample count
+/// (tools/RGBToSpectrumTable) and links the result in as precomputed.
+class RGBToSpectrumTable
+{
+public:
+	static constexpr int resolution = 32;
+	static constexpr size_t coefficientCount = size_t(3) * resolution * resolution * resolution * 3;
+
+	/// @brief table over fitted data, which must outlive it.
+	/// @param zNodes resolution values
+	/// @param coefficients coefficientCount values
+	constexpr RGBToSpectrumTable(const float *zNodes, const float *coefficients)
+		: zNodes(zNodes), coefficients(coefficients) {}
+
+	/// @brief fits the table, rgbWeights[c][i] is the c-th rgb component of a unit value at bin i,
+	/// normalized so that a constant spectrum of 1 is white.
+	/// @param lambdas wavelength of every bin, mapped to [0, 1]
+	/// @param zNodes output, resolution values
+	/// @param coefficients output, coefficientCount values
+	static void fit(const std::vector<double> rgbWeights[3], const std::vector<double> &lambdas,
+					float *zNodes, float *coefficients);
+
+	/// @param rgb components in [0, 1], not all 0
+	RGBSigmoidPolynomial lookup(const double rgb[3]) const;
+
+	const float *getZNodes() const { return zNodes; }
+
+	const float *getCoefficients() const { return coefficients; }
+
+	/// @brief the table of the sampled spectrum, null before SampledSpectrum::init.
+	static const RGBToSpectrumTable *get() { return instance; }
+
+	static void setInstance(const RGBToSpectrumTable *table) { instance = table; }
+
+	/// @brief defined in the source generated by tools/RGBToSpectrumTable, if the build precomputes the table
+	/// (MOER_PRECOMPUTED_RGB_TO_SPECTRUM).
+	static const RGBToSpectrumTable precomputed;
+
+private:
+	/// @return offset of the coefficients of a grid node
+	static size_t index(int maxComponent, int z, int y, int x) {
+		return (((size_t(maxComponent) * resolution + z) * resolution + y) * resolution + x) * 3;
+	}
+
+	const float *zNodes;		///< values of the largest component on the grid
+	const float *coefficients;	///< [largest component][z][y][x][c0, c1, c2]
+
+	static inline const RGBToSpectrumTable *instance = nullptr;
+};
@@ -0,0 +1,126 @@
+/**
+ * @file SpectrumSIMD.h
+ * @author agent
+ * @brief Vectorized kernels behind CoefficientSpectrum.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ *
+ */
+#pragma once
+
+#include <cstring>
+
+//* The element-wise operators are inlined into every shading expression, so their instruction set is
+//* chosen at compile time: AVX-512, AVX or SSE2/NEON through the GCC/Clang vector extensions, depending on
+//* the flags the build enables (see MOER_SIMD in CMakeLists.txt). Other compilers get plain loops, which
+//* they vectorize themselves.
+//* The out-of-line reductions of Spectrum.cpp carry MOER_TARGET_CLONES instead, which builds one copy per
+//* instruction set and picks the best one at load time, so a portable binary still uses AVX2/AVX-512 there.
+
+#if defined(__GNUC__) && defined(__x86_64__) && defined(__linux__) && !defined(__clang__)
+#   define MOER_TARGET_CLONES __attribute__((target_clones("avx512f", "arch=haswell", "default")))
+#else
+#   define MOER_TARGET_CLONES
+#endif
+
+namespace SpectrumSIMD {
+
+#if defined(__GNUC__) || defined(__clang__)
+#   define MOER_SPECTRUM_VECTOR 1
+#   if defined(__AVX512F__)
+constexpr int width = 8;
+#   elif defined(__AVX__)
+constexpr int width = 4;
+#   else
+constexpr int width = 2;
+#   endif
+typedef double Pack __attribute__((vector_size(width * sizeof(double))));
+
+inline Pack load(const double *p) {
+    Pack v;
+    std::memcpy(&v, p, sizeof(Pack));
+    return v;
+}
+
+inline void store(double *p, const Pack &v) {
+    std::memcpy(p, &v, sizeof(Pack));
+}
+
+inline double reduce(const Pack &v) {
+    double s = 0;
+    for (int k = 0; k < width; ++k)
+        s += v[k];
+    return s;
+}
+#else
+constexpr int width = 1;
+#endif
+
+/// @brief alignment of the coefficients of a spectrum with n samples, short spectra keep the natural one.
+constexpr int alignment(int n) {
+    return n >= 2 * width ? int(width * sizeof(double)) : int(alignof(double));
+}
+
+/// @brief dst[i] = op(a[i], b[i]), op is applied to whole packs and then to the tail.
+template<int n, typename Op>
+inline void binary(double *dst, const double *a, const double *b, Op op) {
+    int i = 0;
+#ifdef MOER_SPECTRUM_VECTOR
+    for (; i + width <= n; i += width)
+        store(dst + i, op(load(a + i), load(b + i)));
+#endif
+    for (; i < n; ++i)
+        dst[i] = op(a[i], b[i]);
+}
+
+/// @brief dst[i] = op(a[i], v).
+template<int n, typename Op>
+inline void scalar(double *dst, const double *a, double v, Op op) {
+    int i = 0;
+#ifdef MOER_SPECTRUM_VECTOR
+    for (; i + width <= n; i += width)
+        store(dst + i, op(load(a + i), v));
+#endif
+    for (; i < n; ++i)
+        dst[i] = op(a[i], v);
+}
+
+/// @brief dst[i] = a[i] * b[i] + c[i], contracted into fused multiply-adds when the target has them.
+template<int n>
+inline void fma(double *dst, const double *a, const double *b, const double *c) {
+    int i = 0;
+#ifdef MOER_SPECTRUM_VECTOR
+    for (; i + width <= n; i += width)
+        store(dst + i, load(a + i) * load(b + i) + load(c + i));
+#endif
+    for (; i < n; ++i)
+        dst[i] = a[i] * b[i] + c[i];
+}
+
+template<int n>
+inline void fill(double *dst, double v) {
+    for (int i = 0; i < n; ++i)
+        dst[i] = v;
+}
+
+template<int n>
+inline double sum(const double *a) {
+    int i = 0;
+    double s = 0;
+#ifdef MOER_SPECTRUM_VECTOR
+    if (n >= 2 * width) {
+        Pack acc = load(a);
+        for (i = width; i + width <= n; i += width)
+            acc += load(a + i);
+        s = reduce(acc);
+    }
+#endif
+    for (; i < n; ++i)
+        s += a[i];
+    return s;
+}
+
+}// namespace SpectrumSIMD
@@ -0,0 +1,73 @@
+/**
+ * @file AffineTransform.cpp
+ * @author agent
+ * @brief AffineTransform3D impl.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ *
+ */
+
+#include "AffineTransform.h"
+#include "Eigen/Dense"
+
+AffineTransform3D::AffineTransform3D()
+	: AffineTransform3D(Vec3d(1, 0, 0), Vec3d(0, 1, 0), Vec3d(0, 0, 1), Vec3d(0, 0, 0))
+{
+}
+
+AffineTransform3D::AffineTransform3D(const double *matrixData)
+{
+	for (int c = 0; c < 4; c++)
+		forward[c] = Column{Float(matrixData[4 * c]), Float(matrixData[4 * c + 1]), Float(matrixData[4 * c + 2]), 0};
+	invert();
+}
+
+AffineTransform3D::AffineTransform3D(const Vec3d &column0, const Vec3d &column1, const Vec3d &column2,
+									 const Vec3d &translation)
+{
+	const Vec3d *columns[4] = {&column0, &column1, &column2, &translation};
+	for (int c = 0; c < 4; c++)
+		forward[c] = Column{columns[c]->x, columns[c]->y, columns[c]->z, 0};
+	invert();
+}
+
+AffineTransform3D AffineTransform3D::operator*(const AffineTransform3D &rhs) const
+{
+	AffineTransform3D result;
+	for (int c = 0; c < 3; c++)
+		result.forward[c] = fma3(forward, rhs.forward[c][0], rhs.forward[c][1], rhs.forward[c][2]);
+	result.forward[3] = fma3(forward, rhs.forward[3][0], rhs.forward[3][1], rhs.forward[3][2]) + forward[3];
+	result.invert();
+	return result;
+}
+
+AffineTransform3D AffineTransform3D::inverse() const
+{
+	AffineTransform3D result = *this;
+	std::swap(result.forward, result.backward);
+	//* the inverse-transpose of the inverse is the transpose
+	for (int c = 0; c < 3; c++)
+		result.normal[c] = Column{forward[0][c], forward[1][c], forward[2][c], 0};
+	return result;
+}
+
+void AffineTransform3D::invert()
+{
+	//* inverted in double, a transform is built once and applied many times
+	Eigen::Matrix3d linear;
+	for (int c = 0; c < 3; c++)
+		for (int r = 0; r < 3; r++)
+			linear(r, c) = forward[c][r];
+	Eigen::Vector3d translation(forward[3][0], forward[3][1], forward[3][2]);
+	Eigen::Matrix3d inverseLinear = linear.inverse();
+	Eigen::Vector3d inverseTranslation = -inverseLinear * translation;
+
+	for (int c = 0; c < 3; c++) {
+		backward[c] = Column{Float(inverseLinear(0, c)), Float(inverseLinear(1, c)), Float(inverseLinear(2, c)), 0};
+		normal[c] = Column{Float(inverseLinear(c, 0)), Float(inverseLinear(c, 1)), Float(inverseLinear(c, 2)), 0};
+	}
+	backward[3] = Column{Float(inverseTranslation[0]), Float(inverseTranslation[1]), Float(inverseTranslation[2]), 0};
+}
@@ -0,0 +1,98 @@
+/**
+ * @file AffineTransform.h
+ * @author agent
+ * @brief Compact affine transform with cached inverse, for per-ray and per-hit transforms.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ *
+ */
+#pragma once
+
+#include "Geometry.h"
+
+/// \ingroup Geometry
+/// \brief 3x4 affine transform (linear part and translation) of Float, together with its inverse and the
+/// inverse-transpose that transforms normals. All three are computed once, so applying the transform or its
+/// inverse is a few multiply-adds on 4-wide columns, instead of the 4x4 Eigen product of TransformMatrix3D
+/// (and the 3x3 inverse it takes for every normal).
+class AffineTransform3D
+{
+public:
+	/// @brief identity
+	AffineTransform3D();
+
+	/// @brief from a 4x4 column-major matrix as stored by Matrix4x4, the last row is ignored.
+	explicit AffineTransform3D(const double *matrixData);
+
+	/// @brief x -> linear * x + translation, linear given by its columns.
+	AffineTransform3D(const Vec3d &column0, const Vec3d &column1, const Vec3d &column2, const Vec3d &translation);
+
+	Point3d operator*(const Point3d &p) const {
+		return toPoint(fma3(forward, p.x, p.y, p.z) + forward[3]);
+	}
+
+	Vec3d operator*(const Vec3d &v) const {
+		return toVector(fma3(forward, v.x, v.y, v.z));
+	}
+
+	/// @note not normalized, as for TransformMatrix3D.
+	Normal3d operator*(const Normal3d &n) const {
+		Column r = fma3(normal, n.x, n.y, n.z);
+		return Normal3d(r[0], r[1], r[2]);
+	}
+
+	/// @brief applies this transform after rhs.
+	AffineTransform3D operator*(const AffineTransform3D &rhs) const;
+
+	Point3d inversePoint(const Point3d &p) const {
+		return toPoint(fma3(backward, p.x, p.y, p.z) + backward[3]);
+	}
+
+	Vec3d inverseVector(const Vec3d &v) const {
+		return toVector(fma3(backward, v.x, v.y, v.z));
+	}
+
+	AffineTransform3D inverse() const;
+
+private:
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(MOER_FLOAT_IS_FLOAT) || defined(__AVX__))
+	/// @brief x, y, z and an unused lane: one SSE register of float, or one AVX register of double.
+	typedef Float Column __attribute__((vector_size(4 * sizeof(Float))));
+#else
+	/// @brief the same four lanes as a plain struct, for compilers without vector extensions and for double
+	/// without AVX, where a 32-byte vector fits no register and its calling convention would depend on -mavx.
+	struct Column {
+		Float v[4] = {0, 0, 0, 0};
+		Float &operator[](int i) { return v[i]; }
+		Float operator[](int i) const { return v[i]; }
+		Column operator+(const Column &rhs) const {
+			Column r;
+			for (int i = 0; i < 4; i++) r.v[i] = v[i] + rhs.v[i];
+			return r;
+		}
+		Column operator*(Float s) const {
+			Column r;
+			for (int i = 0; i < 4; i++) r.v[i] = v[i] * s;
+			return r;
+		}
+	};
+#endif
+
+	static Column fma3(const Column m[], Float x, Float y, Float z) {
+		return m[0] * x + m[1] * y + m[2] * z;
+	}
+
+	static Point3d toPoint(const Column &c) { return Point3d(c[0], c[1], c[2]); }
+
+	static Vec3d toVector(const Column &c) { return Vec3d(c[0], c[1], c[2]); }
+
+	/// @brief fills backward and normal from forward.
+	void invert();
+
+	Column forward[4];	///< columns of the linear part, then the translation
+	Column backward[4];	///< the same for the inverse
+	Column normal[3];	///< columns of the inverse-transpose of the linear part
+};
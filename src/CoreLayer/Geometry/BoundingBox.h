@@ -115,7 +115,7 @@ static BoundingBox3<BaseType> BoundingBoxPointUnion(const BoundingBox3<BaseType>
     return BoundingBox3(_pMin, _pMax);
 }
 
-using BoundingBox3f = BoundingBox3<double>;
+using BoundingBox3f = BoundingBox3<Float>;
 
 //Axis-aligned bounding box 2D base type
 template <typename BaseType>
@@ -196,4 +196,4 @@ static BoundingBox2<BaseType> BoundingBoxPointUnion(const BoundingBox2<BaseType>
     return BoundingBox2(_pMin, _pMax);
 }
 
-using BoundingBox2d = BoundingBox2<double>;
+using BoundingBox2d = BoundingBox2<Float>;
@@ -24,11 +24,11 @@ struct TVector2;
 template <typename T>
 struct TVector3;
 using Vec2f = TVector2<float>;
-using Vec2d = TVector2<double>;
+using Vec2d = TVector2<Float>;
 using Vec2i = TVector2<int>;
 using Vec3f = TVector3<float>;
-using Vec3d = TVector3<double>;
-using Vec4d = TVector4<double>;
+using Vec3d = TVector3<Float>;
+using Vec4d = TVector4<Float>;
 using Vec3i = TVector3<int>;
 // Point.h
 template <typename T>
@@ -36,10 +36,10 @@ struct TPoint2;
 template <typename T>
 struct TPoint3;
 using Point2f = TPoint2<float>;
-using Point2d = TPoint2<double>;
+using Point2d = TPoint2<Float>;
 using Point2i = TPoint2<int>;
 using Point3f = TPoint3<float>;
-using Point3d = TPoint3<double>;
+using Point3d = TPoint3<Float>;
 using Point3i = TPoint3<int>;
 // Normal.h
 struct Normal3d;
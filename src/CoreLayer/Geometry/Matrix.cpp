@@ -222,6 +222,7 @@ void TransformMatrix3D::update()
 		dirty = false;
 		// Scale->Rotate->Translate
 		matrixAll = matrixTranslate * matrixRotate * matrixScale;
+		affine = AffineTransform3D(matrixAll.getTransformData());
 	}
 }
 
@@ -269,23 +270,30 @@ void TransformMatrix3D::setRotateAxis(const Vec3d &axis, const Angle &angle)
 Vec3d TransformMatrix3D::operator*(const Vec3d &v)
 {
 	update();
-	return matrixAll * v;
+	return affine * v;
 }
 
 Point3d TransformMatrix3D::operator*(const Point3d &p)
 {
 	update();
-	return matrixAll * p;
+	return affine * p;
 }
 
 Normal3d TransformMatrix3D::operator*(const Normal3d &n)
 {
 	update();
-	return matrixAll * n;
+	return affine * n;
+}
+
+const AffineTransform3D &TransformMatrix3D::getAffine()
+{
+	update();
+	return affine;
 }
 
 TransformMatrix3D::TransformMatrix3D(const double * transformData) {
     matrixAll = Matrix4x4(transformData);
+    affine = AffineTransform3D(transformData);
     dirty = false;
 }
 
@@ -13,6 +13,7 @@
 
 #include "Geometry.h"
 #include "Angle.h"
+#include "AffineTransform.h"
 #include "Eigen/Dense"
 
 enum class EulerType
@@ -74,6 +75,9 @@ class TransformMatrix3D
 	/// @brief the matrix that applies rotate, scale and translate.
 	Matrix4x4 matrixAll;
 
+	/// @brief matrixAll as an affine transform, with its inverse. Applies the operators below.
+	AffineTransform3D affine;
+
 	Matrix4x4 matrixRotate;
 	Matrix4x4 matrixScale;
 	Matrix4x4 matrixTranslate;
@@ -104,6 +108,9 @@ public:
 	Matrix4x4 getRotate() const;
 	Matrix4x4 getTranslate() const;
 
+	/// @brief compact form of the whole transform. Entities keep a copy to transform rays and hits with.
+	const AffineTransform3D &getAffine();
+
 	Vec3d operator*(const Vec3d &v) ;
 	Point3d operator*(const Point3d &p);
 	Normal3d operator*(const Normal3d &n);
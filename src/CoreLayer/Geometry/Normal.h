@@ -16,12 +16,12 @@
 
 /// \ingroup Geometry
 /// \brief Normal
-struct Normal3d : public TVector3<double> {
+struct Normal3d : public TVector3<Float> {
     
     Normal3d() { }
 
-    Normal3d (const TVector3<double> &v) : TVector3<double>(normalize(v)) { }
+    Normal3d (const TVector3<Float> &v) : TVector3<Float>(normalize(v)) { }
 
-    Normal3d (double _x, double _y, double _z) : Normal3d(TVector3<double> {_x, _y, _z})  { }
+    Normal3d (Float _x, Float _y, Float _z) : Normal3d(TVector3<Float> {_x, _y, _z})  { }
     
 }; 
\ No newline at end of file
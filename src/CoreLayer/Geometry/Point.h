@@ -27,6 +27,9 @@ struct TPoint2 {
 
     explicit TPoint2(T t) : x(t), y(t) { }
 
+    template <typename U>
+    explicit TPoint2(const TPoint2<U> &p) : x(p.x), y(p.y) { }
+
     /*--- operator overloading ---*/
     TPoint2 operator+(const TVector2<T> &rhs) const {
         return TPoint2(x+rhs.x, y+rhs.y);
@@ -107,9 +110,9 @@ std::ostream& operator<<(std::ostream &os, const TPoint2<T> &p) {
     return os;
 }
 
-template <typename T>
-TPoint2<T> operator*(T t, const TPoint2<T> &v) {
-    return TPoint2(t*v.x, t*v.y);
+template <typename T, typename S, typename = std::enable_if_t<std::is_arithmetic_v<S>>>
+TPoint2<T> operator*(S t, const TPoint2<T> &v) {
+    return TPoint2<T>(t*v.x, t*v.y);
 }
 
 template<>
@@ -139,6 +142,9 @@ struct TPoint3 {
 
     explicit TPoint3(T t) : x(t), y(t), z(t) { }
 
+    template <typename U>
+    explicit TPoint3(const TPoint3<U> &p) : x(p.x), y(p.y), z(p.z) { }
+
     /*--- operator overloading ---*/
     TPoint3 operator+(const TVector3<T> &rhs) const {
         return TPoint3(x+rhs.x, y+rhs.y, z+rhs.z);
@@ -219,9 +225,9 @@ std::ostream& operator<<(std::ostream &os, const TPoint3<T> &p) {
     return os;
 }
 
-template <typename T>
-TPoint3<T> operator*(T t, const TPoint3<T> &v) {
-    return TPoint3(t*v.x, t*v.y, t*v.z);
+template <typename T, typename S, typename = std::enable_if_t<std::is_arithmetic_v<S>>>
+TPoint3<T> operator*(S t, const TPoint3<T> &v) {
+    return TPoint3<T>(t*v.x, t*v.y, t*v.z);
 }
 
 template<>
@@ -237,9 +243,9 @@ inline TPoint3<int>& TPoint3<int>::operator/=(int i) {
     return *this; 
 }
 
-inline TPoint3<double> 
+inline TPoint3<Float> 
 eigenToPoint3d(Eigen::DenseBase<Eigen::MatrixXd>::ConstColXpr col) {
-    return TPoint3<double>{
+    return TPoint3<Float>(
         col.x(), col.y(), col.z()
-    };
+    );
 }
\ No newline at end of file
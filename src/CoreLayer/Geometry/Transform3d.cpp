@@ -46,7 +46,7 @@ Transform3D::Transform3D() : matrix(std::make_shared<TransformMatrix3D>())
 {
 }
 
-Point3d Transform3D::getTranslate()
+Point3d Transform3D::getTranslate() const
 {
     Point3d p(0.0);
     return *matrix * p;
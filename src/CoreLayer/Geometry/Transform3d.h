@@ -50,7 +50,7 @@ public:
 	/// @brief inform this object that transform setting is DONE and 'you' can apply all transformation without redundant calculation. apply() should be called within.
 	void done();
 
-	Point3d getTranslate();
+	Point3d getTranslate() const;
 
     // apply matrix to this object. Cache should be managed locally.
     virtual void apply() {}
@@ -12,7 +12,9 @@
 #pragma once
 #include <assert.h>
 #include "FastMath.h"
+#include "CoreLayer/Math/Common.h"
 #include <iostream>
+#include <type_traits>
 #include "Eigen/Dense"
 
 /// \ingroup Geometry
@@ -30,6 +32,9 @@ struct TVector2 {
 
     explicit TVector2(T t) : x(t), y(t) { }
 
+    template <typename U>
+    explicit TVector2(const TVector2<U> &v) : x(v.x), y(v.y) { }
+
     /*---operator overloading---*/
     TVector2 operator+(const TVector2 &rhs) const {
         return TVector2(x + rhs.x, y + rhs.y);
@@ -111,8 +116,9 @@ std::ostream& operator<<(std::ostream& os, const TVector2<T> &v) {
     return os;
 }
 
-template <typename T>
-TVector2<T> operator*(T t, const TVector2<T> &v) {
+/// @brief scalar of any arithmetic type, so that double constants scale Float vectors
+template <typename T, typename S, typename = std::enable_if_t<std::is_arithmetic_v<S>>>
+TVector2<T> operator*(S t, const TVector2<T> &v) {
     return TVector2<T>(v.x * t, v.y * t);
 }
 
@@ -126,10 +132,14 @@ decltype(auto) absDot(const TVector2<T> &v1, const TVector2<T> &v2) {
     return fm::abs(v1.x*v2.x + v1.y * v2.y);
 }
 
+/// @brief floating point type of the results of normalize, Float for integer vectors
+template <typename T>
+using RealOf = std::conditional_t<std::is_floating_point_v<T>, T, Float>;
+
 template <typename T>
-TVector2<double> normalize(const TVector2<T> &v) {
-    double recip = 1.0f / v.length();
-    return TVector2<double> (v.x * recip, v.y * recip);
+TVector2<RealOf<T>> normalize(const TVector2<T> &v) {
+    RealOf<T> recip = RealOf<T>(1) / v.length();
+    return TVector2<RealOf<T>> (v.x * recip, v.y * recip);
 }
 
 template<> 
@@ -157,6 +167,9 @@ struct TVector3 {
 
     explicit TVector3 (T t) : x(t), y(t), z(t) { }
 
+    template <typename U>
+    explicit TVector3 (const TVector3<U> &v) : x(v.x), y(v.y), z(v.z) { }
+
     /*--- operator overloading ---*/
     TVector3 operator+(T value) const {
          return TVector3(x + value , y + value, z + value);
@@ -359,8 +372,8 @@ std::ostream& operator<<(std::ostream &os, const TVector3<T> &v) {
     return os;
 }
 
-template <typename T>
-TVector3<T> operator*(T t, const TVector3<T> &v) {
+template <typename T, typename S, typename = std::enable_if_t<std::is_arithmetic_v<S>>>
+TVector3<T> operator*(S t, const TVector3<T> &v) {
     return TVector3<T>(v.x*t, v.y*t, v.z*t);
 }
 
@@ -375,9 +388,9 @@ decltype(auto) absDot(const TVector3<T> &v1, const TVector3<T> &v2) {
 }
 
 template <typename T>
-TVector3<double> normalize(const TVector3<T> &v) {
-    double recip = 1.0f / v.length();
-    return TVector3<double> (v.x * recip, v.y * recip, v.z * recip);
+TVector3<RealOf<T>> normalize(const TVector3<T> &v) {
+    RealOf<T> recip = RealOf<T>(1) / v.length();
+    return TVector3<RealOf<T>> (v.x * recip, v.y * recip, v.z * recip);
 }
 
 /**
@@ -397,11 +410,11 @@ TVector3<T> cross(const TVector3<T> &v1, const TVector3<T> &v2) {
     );
 }
 
-inline TVector3<double> 
+inline TVector3<Float> 
 eigenToVector3d(Eigen::DenseBase<Eigen::MatrixXd>::ConstColXpr col) {
-    return TVector3<double>{
+    return TVector3<Float>(
         col.x(), col.y(), col.z()
-    };
+    );
 }
 
 
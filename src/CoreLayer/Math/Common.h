@@ -20,6 +20,14 @@
 #include <intrin.h>
 #endif
 
+/// @brief real type of the geometry types, float with MOER_FLOAT_TYPE=float (see CMakeLists.txt).
+/// Names like Vec3d and Point3d are kept for either type.
+#ifdef MOER_FLOAT_IS_FLOAT
+using Float = float;
+#else
+using Float = double;
+#endif
+
 // some constant values
 #ifdef _WIN32
 constexpr double M_PI       =           3.14159265358979323846f;
@@ -31,10 +39,10 @@ constexpr double ONEMINUSEPSILON = 1 - std::numeric_limits<double>::epsilon();
 constexpr double EPSILON = std::numeric_limits<double>::epsilon();
 
 
-template<class T>
-inline T clamp(T x, T minVal, T maxVal) {
+template<class T, class L, class H>
+inline T clamp(T x, L minVal, H maxVal) {
     if(x>=minVal && x<=maxVal ) return  x;
-    return x<minVal?minVal:maxVal;
+    return x<minVal?T(minVal):T(maxVal);
 }
 
 template<class T>
@@ -10,6 +10,8 @@
  */
 #include "LowDiscrepancy.h"
 #include <cassert>
+#include <memory>
+#include <mutex>
 
 
 const int Primes[nPrimes] = {
@@ -249,41 +251,21 @@ static double radicalInverseScrambleLoop(const uint16_t *perm, uint64_t a) {
         invBaseN * (reverseDigits + invBase * perm[0] / (1 - invBase)),
         ONEMINUSEPSILON);
 }
-/**
- * @brief To shuffle vectors in a continuous memory.
- *
- * @tparam T      Value type.
- * @param vecs  Pointer to the first value of first vector.
- * @param count   Number of vectors.
- * @param nDim    Number of dimensions.
- * @param rng     Random number generator.
- */
-template<typename T>
-static void shuffleByPointer(T *vecs, int count, int nDim,
-                             RandomNumberGenerator &rng) {
-    for (int i = 0; i < count; i++) {
-        int other = rng(i, count);
-        for (int j = 0; j < nDim; j++)
-            std::swap(vecs[i * nDim + j], vecs[other * nDim + j]);
-    }
-}
-std::vector<uint16_t> computeScramblePermutations(RandomNumberGenerator &rng) {
-    std::vector<uint16_t> perms;
-    // Count the total size
-    int arrSize = PrimeSums[nPrimes - 1];
-    // for (int i = 0; i < nPrimes; i++) arrSize += Primes[i];
-    perms.resize(arrSize);
-    // Generate permutations
-    uint16_t *p = &perms[0];// Used to travel the vector
-    for (int i = 0; i < nPrimes; i++) {
-        // Permutation for the i-th prime
-        // Init
-        for (int j = 0; j < Primes[i]; j++) p[j] = j;
-        // Shuffle
-        shuffleByPointer(p, Primes[i], 1, rng);
-        p += Primes[i];
-    }
-    return perms;
+const uint16_t *scramblePermutation(int baseIndex) {
+    assert(0 <= baseIndex && baseIndex < nPrimes);
+    // All permutations in a continuous memory, PrimeSums[i] is the end of the i-th one.
+    // Left uninitialized, the whole table is 7MB and most of it is never touched.
+    static std::unique_ptr<uint16_t[]> perms(new uint16_t[PrimeSums[nPrimes - 1]]);
+    static std::once_flag built[nPrimes];
+    uint16_t *p = &perms[PrimeSums[baseIndex] - Primes[baseIndex]];
+    std::call_once(built[baseIndex], [p, baseIndex] {
+        // Fisher-Yates shuffle, seeded by the base so that every run scrambles alike
+        pcg32 rng(baseIndex);
+        for (int j = 0; j < Primes[baseIndex]; j++) p[j] = j;
+        for (int j = 0; j < Primes[baseIndex]; j++)
+            std::swap(p[j], p[j + rng(uint32_t(Primes[baseIndex] - j))]);
+    });
+    return p;
 }
 double radicalInverse(int baseIndex, uint64_t a) {
     assert(0 <= baseIndex && baseIndex < 1024);
@@ -28,13 +28,15 @@ void shuffle(T *array, int nSample, int nDim, RandomNumberGenerator &rng) {
     }
 }
 /**
- * @brief Generate the permutation used to scramble the Hammersley and Halton
- *        sequence.
+ * @brief The permutation used to scramble the digits of the Hammersley and
+ *        Halton sequence in the base of baseIndex-th prime.
+ *        Built from a fixed seed on first use, so that a render only pays
+ *        for the dimensions it draws. Thread-safe.
  *
- * @param rng                     Random number generator.
- * @return std::vector<uint16_t>  Computed permutations, in a continuous memory.
+ * @param baseIndex         Index of primes, used as the base.
+ * @return const uint16_t*  Primes[baseIndex] digits.
  */
-std::vector<uint16_t> computeScramblePermutations(RandomNumberGenerator &rng);
+const uint16_t *scramblePermutation(int baseIndex);
 /**
  * @brief Represent value a under the base of baseIndex-th prime,
  *        then inverse the representation to right of the decimal point.
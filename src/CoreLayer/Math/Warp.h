@@ -54,7 +54,7 @@ inline  Vec3d SquareToCosineHemisphere(const Point2d &sample) {
     float z=sqrt(1-sample.x);
     float phi=sample.y*2*M_PI;
 
-    return {sqrt(sample.x)* cos(phi),sqrt(sample.x)*sin(phi),z};
+    return {Float(sqrt(sample.x)* cos(phi)),Float(sqrt(sample.x)*sin(phi)),z};
 }
 
 inline  float SquareToCosineHemispherePdf(const Vec3d &v) {
@@ -100,5 +100,48 @@ inline Point2d SquareToUniformDiskConcentric(const Point2d &sample) {
     double cosPhi = fm::cos(phi);
     double sinPhi = fm::sin(phi);
 
-    return { r * cosPhi, r * sinPhi };
+    return { Float(r * cosPhi), Float(r * sinPhi) };
+}
+
+// Equal-area octahedral mapping between [0,1]^2 and the unit sphere (Clarberg 2008), as in pbrt-v4.
+// Every texel of a square image indexed this way covers the same solid angle.
+inline Vec3d SquareToEqualAreaSphere(const Point2d &p) {
+    double u = 2 * p.x - 1, v = 2 * p.y - 1;
+    double up = std::abs(u), vp = std::abs(v);
+    double signedDistance = 1 - (up + vp);
+    double d = std::abs(signedDistance);
+    double r = 1 - d;
+    double phi = (r == 0 ? 1 : (vp - up) / r + 1) * M_PI / 4;
+    double z = std::copysign(1 - r * r, signedDistance);
+    double cosPhi = std::copysign(fm::cos(phi), u);
+    double sinPhi = std::copysign(fm::sin(phi), v);
+    double s = r * fm::sqrt(std::max(0.0, 2 - r * r));
+    return {Float(cosPhi * s), Float(sinPhi * s), Float(z)};
+}
+
+// Inverse of SquareToEqualAreaSphere. atan is replaced by a polynomial fit, so no transcendental calls.
+inline Point2d EqualAreaSphereToSquare(const Vec3d &d) {
+    double x = std::abs(d.x), y = std::abs(d.y), z = std::abs(d.z);
+    double r = fm::sqrt(std::max(0.0, 1 - z));
+    double a = std::max(x, y), b = std::min(x, y);
+    b = a == 0 ? 0 : b / a;
+    // 2 / pi * atan(b) on [0,1]
+    double phi = 0.406758566246788489601959989e-5 +
+                 b * (0.636226545274016134946890922156 +
+                 b * (0.61572017898280213493197203466e-2 +
+                 b * (-0.247333733281268944196501420480 +
+                 b * (0.881770664775316294736387951347e-1 +
+                 b * (0.419038818029165735901852432784e-1 +
+                 b * -0.251390972343483509333252996350e-1)))));
+    if (x < y) phi = 1 - phi;
+    double v = phi * r;
+    double u = r - v;
+    if (d.z < 0) {
+        std::swap(u, v);
+        u = 1 - u;
+        v = 1 - v;
+    }
+    u = std::copysign(u, d.x);
+    v = std::copysign(v, d.y);
+    return {Float(0.5 * (u + 1)), Float(0.5 * (v + 1))};
 }
@@ -0,0 +1,104 @@
+#include "LoadProfiler.h"
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#if defined(__linux__)
+#   include <unistd.h>
+#endif
+
+std::shared_ptr<LoadProfiler> LoadProfiler::instance = nullptr;
+
+std::shared_ptr<LoadProfiler> LoadProfiler::getInstance() {
+    if (!instance)
+        instance.reset(new LoadProfiler());
+    return instance;
+}
+
+size_t LoadProfiler::getProcessResidentBytes() {
+#if defined(__linux__)
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, residentPages = 0;
+    if (statm >> pages >> residentPages)
+        return residentPages * size_t(sysconf(_SC_PAGESIZE));
+#endif
+    return 0;
+}
+
+void LoadProfiler::addRecord(const std::string &stage, const std::string &asset, double seconds, size_t bytes) {
+    if (!isEnabled())
+        return;
+    size_t processBytes = getProcessResidentBytes();
+    std::lock_guard<std::mutex> lock(mutex);
+    records.push_back({stage, asset, seconds, bytes, processBytes});
+}
+
+void LoadProfiler::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    records.clear();
+}
+
+static double toMB(size_t bytes) {
+    return bytes / (1024.0 * 1024.0);
+}
+
+void LoadProfiler::print(std::ostream &os) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::map<std::string, std::pair<double, size_t>> stages;
+    auto flags = os.flags();
+    os << std::fixed << std::setprecision(3);
+    os << "---------------- scene load profile ----------------\n";
+    for (const auto &record : records) {
+        os << std::left << std::setw(20) << record.stage << std::right << std::setw(10) << record.seconds * 1000
+           << " ms" << std::setw(12) << toMB(record.bytes) << " MB";
+        if (record.processBytes) os << std::setw(12) << toMB(record.processBytes) << " MB rss";
+        if (!record.asset.empty()) os << "  " << record.asset;
+        os << "\n";
+        stages[record.stage].first += record.seconds;
+        stages[record.stage].second += record.bytes;
+    }
+    os << "---------------- totals ----------------\n";
+    for (const auto &[stage, total] : stages)
+        os << std::left << std::setw(20) << stage << std::right << std::setw(10) << total.first * 1000
+           << " ms" << std::setw(12) << toMB(total.second) << " MB\n";
+    os.flags(flags);
+}
+
+Json LoadProfiler::toJson() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Json json;
+    json["records"] = Json::array();
+    Json totals = Json::object();
+    for (const auto &record : records) {
+        json["records"].push_back({{"stage", record.stage},
+                                   {"asset", record.asset},
+                                   {"seconds", record.seconds},
+                                   {"bytes", record.bytes},
+                                   {"process_bytes", record.processBytes}});
+        if (!totals.contains(record.stage))
+            totals[record.stage] = {{"seconds", 0.0}, {"bytes", 0}};
+        totals[record.stage]["seconds"] = totals[record.stage]["seconds"].get<double>() + record.seconds;
+        totals[record.stage]["bytes"] = totals[record.stage]["bytes"].get<size_t>() + record.bytes;
+    }
+    json["totals"] = totals;
+    return json;
+}
+
+bool LoadProfiler::saveJson(const std::string &path) const {
+    std::ofstream file(path);
+    if (!file) {
+        std::cerr << "Can not write load profile to " << path << std::endl;
+        return false;
+    }
+    file << std::setw(4) << toJson() << std::endl;
+    return true;
+}
+
+ProfileScope::ProfileScope(std::string _stage, std::string _asset)
+    : stage(std::move(_stage)), asset(std::move(_asset)), start(std::chrono::high_resolution_clock::now()) {
+}
+
+ProfileScope::~ProfileScope() {
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    LoadProfiler::getInstance()->addRecord(stage, asset, elapsed.count(), bytes);
+}
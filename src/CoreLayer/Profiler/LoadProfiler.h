@@ -0,0 +1,79 @@
+/**
+ * @file LoadProfiler.h
+ * @author agent
+ * @brief Timing and memory report for scene loading and building.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "CoreLayer/Adapter/JsonUtil.h"
+
+/// @brief Collects per-stage and per-asset records during scene startup.
+/// Stages used by the renderer: json, mesh, texture, nanovdb, apply, accel, light distribution.
+class LoadProfiler {
+    static std::shared_ptr<LoadProfiler> instance;
+
+public:
+    struct Record {
+        std::string stage;
+        std::string asset;
+        double seconds;
+        size_t bytes;               ///< memory held by the asset itself, 0 if unknown
+        size_t processBytes;        ///< resident set size of the process after the record, 0 if unsupported
+    };
+
+    // @brief singleton pattern get.
+    static std::shared_ptr<LoadProfiler> getInstance();
+
+    /// @note thread safe, out-of-core meshes are loaded from render threads.
+    void addRecord(const std::string &stage, const std::string &asset, double seconds, size_t bytes = 0);
+
+    void reset();
+
+    /// @brief records are dropped while disabled, e.g. out-of-core meshes reloaded during rendering.
+    void setEnabled(bool _enabled) { enabled.store(_enabled, std::memory_order_relaxed); }
+
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    /// @brief per-asset lines followed by per-stage totals.
+    void print(std::ostream &os) const;
+
+    Json toJson() const;
+
+    bool saveJson(const std::string &path) const;
+
+    /// @brief resident set size of the current process in bytes, 0 on unsupported platforms.
+    static size_t getProcessResidentBytes();
+
+private:
+    mutable std::mutex mutex;
+    std::vector<Record> records;
+    std::atomic<bool> enabled{true};
+};
+
+/// @brief Scoped timer that adds a record to the LoadProfiler on destruction.
+class ProfileScope {
+public:
+    ProfileScope(std::string stage, std::string asset = "");
+
+    ~ProfileScope();
+
+    void setBytes(size_t _bytes) { bytes = _bytes; }
+
+private:
+    std::string stage, asset;
+    size_t bytes = 0;
+    std::chrono::high_resolution_clock::time_point start;
+};
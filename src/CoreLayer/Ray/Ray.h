@@ -11,8 +11,10 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <cfloat>
+#include <limits>
 #include "CoreLayer/Geometry/Geometry.h"
 
 
@@ -36,6 +38,15 @@ struct Ray
 	Ray(const Point3d &_origin, const Vec3d &_direction, double _timeMin = .0f, double _timeMax = DBL_MAX);
 };
 
+/// \brief distance a ray spawned at p is moved off the surface. A fixed 1e-4 falls under the rounding
+/// error of float coordinates a few thousand units away from the origin, so it grows with |p| there.
+inline double rayOriginOffset(const Point3d &p)
+{
+	const double relative = 64 * std::numeric_limits<Float>::epsilon();
+	double magnitude = std::max({std::abs(double(p.x)), std::abs(double(p.y)), std::abs(double(p.z))});
+	return std::max(1e-4, magnitude * relative);
+}
+
 /// \brief ray differential
 struct RayDifferential : public Ray
 {
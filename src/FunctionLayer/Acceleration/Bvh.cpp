@@ -225,7 +225,8 @@ std::optional<Intersection> Bvh::Intersect(const Ray& r) const{
 					
 					if (its.has_value()) {
 						flag = true;
-						double t = (its->position[0] - r.origin[0]) / r.direction[0];
+						//* projected on the whole direction, a single component is unstable when it is close to 0
+						double t = dot(its->position - r.origin, r.direction) / r.direction.length2();
 						if (R.timeMax > t) {
 							R.timeMax = t;
 							result = its;
@@ -4,12 +4,15 @@ Ray DifferentialPinholeCamera::generateRay(const Point2i &filmResolution, const
     double x = (double)(pixelPosition.x + sample.xy.x) / filmResolution.x,
            y = (double)(pixelPosition.y + sample.xy.y) / filmResolution.y;
     
-    Point3d pointOnFilm = sampleToFilm * Point3d {x, y, 0},
+    Point3d pointOnFilm = sampleToFilm * Point3d {Float(x), Float(y), 0},
             origin = Point3d {0, 0, 0};
     
     Vec3d dir = cameraToWorld * normalize(pointOnFilm - origin);
-    Vec3d dirX = cameraToWorld * normalize((sampleToFilm * Point3d {x + 1.f, y, 0}) - origin);
-    Vec3d dirY = cameraToWorld * normalize((sampleToFilm * Point3d {x, y + 1.f, 0}) - origin);
+    // offset by one pixel, x and y are in [0,1] film space
+    double dx = 1.0 / filmResolution.x,
+           dy = 1.0 / filmResolution.y;
+    Vec3d dirX = cameraToWorld * normalize((sampleToFilm * Point3d {Float(x + dx), Float(y), 0}) - origin);
+    Vec3d dirY = cameraToWorld * normalize((sampleToFilm * Point3d {Float(x), Float(y + dy), 0}) - origin);
     
     origin = cameraToWorld * origin;
 
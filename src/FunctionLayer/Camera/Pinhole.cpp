@@ -4,7 +4,7 @@ Ray PinholeCamera::generateRay(const Point2i &filmResolution, const Point2i &pix
     double x = (double)(pixelPosition.x + sample.xy.x) / filmResolution.x,
            y = (double)(pixelPosition.y + sample.xy.y) / filmResolution.y;
     
-    Point3d pointOnFilm = sampleToFilm * Point3d {x, y, 0},
+    Point3d pointOnFilm = sampleToFilm * Point3d {Float(x), Float(y), 0},
             origin = Point3d {0, 0, 0};
     
     Vec3d dir =  normalize(pointOnFilm - origin);
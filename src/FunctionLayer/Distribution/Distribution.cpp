@@ -1,14 +1,79 @@
 #include "Distribution.h"
+#include "CoreLayer/Adapter/Parallel.h"
 
-Distribution2D::Distribution2D(const double * data, int nu, int nv) {
-    pConditionalV.reserve(nv);
-    for(int i=0;i<nv;i++){
-        pConditionalV.emplace_back(std::make_unique<Distribution1D>(data+nu*i,nu));
+void buildAliasBins(const double *f, int n, double sum, AliasBin *bins) {
+    std::vector<double> scaled(n);
+    std::vector<int> small, large;
+    for (int i = 0; i < n; ++i) {
+        bins[i].alias = i;
+        scaled[i] = sum > 0 ? f[i] * n / sum : 1.0;
+        (scaled[i] < 1 ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty()) {
+        int s = small.back(), l = large.back();
+        small.pop_back();
+        bins[s].prob = scaled[s];
+        bins[s].alias = l;
+        scaled[l] = (scaled[l] + scaled[s]) - 1;
+        if (scaled[l] < 1) {
+            large.pop_back();
+            small.push_back(l);
+        }
+    }
+    // leftovers are 1 up to round-off
+    for (int i : small) bins[i].prob = 1;
+    for (int i : large) bins[i].prob = 1;
+}
+
+AliasTable1D::AliasTable1D(const double *f, int n) : bins(n), pdfs(n) {
+    funcInt = 0;
+    for (int i = 0; i < n; ++i) funcInt += f[i];
+    for (int i = 0; i < n; ++i)
+        pdfs[i] = funcInt > 0 ? f[i] / funcInt : 1.0 / n;
+    buildAliasBins(f, n, funcInt, bins.data());
+}
+
+Distribution2D::Distribution2D(const double * data, int nu, int nv, EDistributionSampling sampling) :
+    sampling(sampling), nu(nu), nv(nv), func(data, data + size_t(nu) * nv), rowFuncInt(nv) {
+    //* rows are independent, build them in parallel for large environment maps
+    parallelFor(0, nv, [&](int v) {
+        double sum = 0;
+        for (int u = 0; u < nu; ++u) sum += func[size_t(v) * nu + u];
+        rowFuncInt[v] = sum / nu;
+    });
+    for (double f : rowFuncInt) marginalFuncInt += f;
+    marginalFuncInt /= nv;
+
+    if (sampling == EDistributionSampling::CDF) {
+        //* same construction as Distribution1D, one row after the other
+        conditionalCdf.resize(size_t(nu + 1) * nv);
+        parallelFor(0, nv, [&](int v) {
+            const double *f = &func[size_t(v) * nu];
+            double *cdf = &conditionalCdf[size_t(v) * (nu + 1)];
+            cdf[0] = 0;
+            for (int i = 1; i < nu + 1; ++i) cdf[i] = cdf[i - 1] + f[i - 1] / nu;
+            for (int i = 1; i < nu + 1; ++i)
+                cdf[i] = rowFuncInt[v] == 0 ? double(i) / double(nu) : cdf[i] / cdf[nu];
+        });
+        marginal = std::make_unique<Distribution1D>(rowFuncInt.data(), nv);
+    } else {
+        conditionalBins.resize(size_t(nu) * nv);
+        parallelFor(0, nv, [&](int v) {
+            buildAliasBins(&func[size_t(v) * nu], nu, rowFuncInt[v] * nu, &conditionalBins[size_t(v) * nu]);
+        });
+        marginalBins.resize(nv);
+        marginalPdf.resize(nv);
+        double marginalSum = marginalFuncInt * nv;
+        buildAliasBins(rowFuncInt.data(), nv, marginalSum, marginalBins.data());
+        for (int v = 0; v < nv; ++v)
+            marginalPdf[v] = marginalSum > 0 ? rowFuncInt[v] / marginalSum : 1.0 / nv;
     }
-    std::vector<double> marginalFunc;
-    marginalFunc.reserve(nv);
-    for (int v = 0; v < nv; ++v)
-        marginalFunc.push_back(pConditionalV[v]->funcInt);
-    pMarginal.reset(new Distribution1D(&marginalFunc[0], nv));
 }
 
+size_t Distribution2D::memoryUsage() const {
+    size_t bytes = sizeof(double) * (func.size() + rowFuncInt.size() + conditionalCdf.size() + marginalPdf.size()) +
+                   sizeof(AliasBin) * (conditionalBins.size() + marginalBins.size());
+    if (marginal)
+        bytes += sizeof(double) * (marginal->func.size() + marginal->cdf.size());
+    return bytes;
+}
@@ -78,7 +78,7 @@ struct Distribution1D{
     }
 
     double DiscretePDF(int index) const {
-        if(index>= func.size() || funcInt==0){
+        if(index>= Count() || funcInt==0){
             return 0;
         }
         return func[index] / (funcInt * Count());
@@ -98,31 +98,145 @@ struct Distribution1D{
 };
 
 
+/// @brief One column of an alias table, shared by AliasTable1D and the rows of Distribution2D.
+struct AliasBin {
+    float prob;     ///< probability of keeping this bin
+    int alias;
+};
+
+/// @brief Build alias bins with Vose's method. A zero sum gives a uniform table.
+void buildAliasBins(const double *f, int n, double sum, AliasBin *bins);
+
+/// @brief O(1) draw from alias bins.
+/// @param remapped if not null, receives u rescaled to [0,1) within the chosen bin, so it can be reused
+inline int sampleAliasBins(const AliasBin *bins, int n, double u, double *remapped) {
+    double scaled = u * n;
+    int index = std::min(int(scaled), n - 1);
+    double frac = std::min(scaled - index, 1.0 - 1e-12);
+    const AliasBin &bin = bins[index];
+    if (frac < bin.prob) {
+        if (remapped) *remapped = frac / bin.prob;
+        return index;
+    }
+    if (remapped) *remapped = std::min((frac - bin.prob) / (1 - bin.prob), 1.0 - 1e-12);
+    return bin.alias;
+}
+
+/// @brief Walker/Vose alias table over a discrete distribution. Sampling is O(1).
+struct AliasTable1D{
+    AliasTable1D() = default;
+    AliasTable1D(const double *f, int n);
+
+    /// @param u sample in [0,1)
+    /// @param remapped if not null, receives u rescaled to [0,1) within the chosen bin, so it can be reused
+    int SampleDiscrete(double u, double *pdf, double *remapped = nullptr) const {
+        int index = sampleAliasBins(bins.data(), Count(), u, remapped);
+        if (pdf) *pdf = pdfs[index];
+        return index;
+    }
+
+    /// @brief same contract as Distribution1D::SampleContinuous, pdf is the discrete probability of the bin.
+    double SampleContinuous(double u, double *pdf, int *off = nullptr) const {
+        double remapped;
+        int index = SampleDiscrete(u, pdf, &remapped);
+        if (off) *off = index;
+        return (index + remapped) / Count();
+    }
+
+    double DiscretePDF(int index) const {
+        if (index < 0 || index >= Count()) return 0;
+        return pdfs[index];
+    }
+
+    int Count() const {
+        return int(bins.size());
+    }
+
+    double funcInt = 0;
+
+private:
+    std::vector<AliasBin> bins;
+    std::vector<double> pdfs;     ///< normalized discrete probability of each bin
+};
+
+/// @brief How Distribution2D picks rows and columns.
+enum class EDistributionSampling {
+    CDF,        ///< binary search of the cumulative distribution, O(log n)
+    ALIAS       ///< alias tables, O(1)
+};
+
+/// @brief Piecewise constant 2D distribution. All rows live in one contiguous array,
+/// so a sample touches the marginal and a single row.
 struct Distribution2D{
 public:
+    friend class SceneSnapshot;
+
     // Distribution2D Public Methods
-    Distribution2D(const double *data, int nu, int nv);
+    Distribution2D(const double *data, int nu, int nv,
+                   EDistributionSampling sampling = EDistributionSampling::ALIAS);
+
+    /// @return point in [0,1)^2, pdf receives the discrete probability of its cell.
     Point2d SampleContinuous(const Point2d &u, double *pdf) const {
-        double pdfs[2];
-        int v;
-        double d1 = pMarginal->SampleContinuous(u[1], &pdfs[1], &v);
-        double d0 = pConditionalV[v]->SampleContinuous(u[0], &pdfs[0]);
-        if(pdf)
-            *pdf = pdfs[0] * pdfs[1];
-        return Point2d(d0, d1);
+        if (sampling == EDistributionSampling::ALIAS)
+            return sampleAlias(u, pdf);
+        return sampleCDF(u, pdf);
     }
+
+    /// @return density with respect to [0,1)^2.
     double Pdf(const Point2d &p) const {
-        int iu = std::clamp(int(p[0] * pConditionalV[0]->Count()), 0,
-                       pConditionalV[0]->Count() - 1);
-        int iv = std::clamp(int(p[1] * pMarginal->Count()), 0, pMarginal->Count() - 1);
-        //return pMarginal->DiscretePDF(iv) * pConditionalV[iv]->DiscretePDF(iu);
-        return pConditionalV[iv]->func[iu] / pMarginal->funcInt;
+        int iu = std::clamp(int(p[0] * nu), 0, nu - 1);
+        int iv = std::clamp(int(p[1] * nv), 0, nv - 1);
+        return marginalFuncInt > 0 ? func[size_t(iv) * nu + iu] / marginalFuncInt : 0;
     }
 
+    size_t memoryUsage() const;
+
+    /// @brief mean of the function over [0,1)^2.
+    double integral() const { return marginalFuncInt; }
 
 private:
+    //* filled in by SceneSnapshot
+    Distribution2D() = default;
+
+    Point2d sampleAlias(const Point2d &u, double *pdf) const {
+        double r1, r0;
+        int v = sampleAliasBins(marginalBins.data(), nv, u[1], &r1);
+        int iu = sampleAliasBins(&conditionalBins[size_t(v) * nu], nu, u[0], &r0);
+        if (pdf) {
+            double rowSum = rowFuncInt[v] * nu;
+            *pdf = rowSum > 0 ? marginalPdf[v] * func[size_t(v) * nu + iu] / rowSum : 0;
+        }
+        return Point2d((iu + r0) / nu, (v + r1) / nv);
+    }
+
+    Point2d sampleCDF(const Point2d &u, double *pdf) const {
+        double pdfs[2];
+        int v;
+        double d1 = marginal->SampleContinuous(u[1], &pdfs[1], &v);
+        const double *rowCdf = &conditionalCdf[size_t(v) * (nu + 1)];
+        int iu = FindInterval(nu + 1, [&](int index) { return rowCdf[index] <= u[0]; });
+        double du = u[0] - rowCdf[iu];
+        if (rowCdf[iu + 1] - rowCdf[iu] > 0)
+            du /= rowCdf[iu + 1] - rowCdf[iu];
+        pdfs[0] = rowFuncInt[v] > 0 ? rowCdf[iu + 1] - rowCdf[iu] : 0;
+        if(pdf)
+            *pdf = pdfs[0] * pdfs[1];
+        return Point2d((iu + du) / nu, d1);
+    }
+
     // Distribution2D Private Data
-    std::vector<std::unique_ptr<Distribution1D>> pConditionalV;
-    std::unique_ptr<Distribution1D> pMarginal;
+    EDistributionSampling sampling = EDistributionSampling::ALIAS;
+    int nu = 0, nv = 0;
+    std::vector<double> func;               ///< nu * nv, row major
+    std::vector<double> rowFuncInt;         ///< mean of every row
+    double marginalFuncInt = 0;
+
+    //* CDF sampling
+    std::vector<double> conditionalCdf;     ///< (nu + 1) * nv
+    std::unique_ptr<Distribution1D> marginal;
+
+    //* alias sampling
+    std::vector<AliasBin> conditionalBins;  ///< nu * nv
+    std::vector<AliasBin> marginalBins;
+    std::vector<double> marginalPdf;
 };
-
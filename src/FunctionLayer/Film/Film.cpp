@@ -35,6 +35,13 @@ void Film::deposit(const Point2i &p, const Spectrum &s) {
     }
     int id = p.y * resolution.x + p.x;
     sumWeights[id] += 1.0;
+#ifdef USING_HERO_WAVELENGTHS
+    // each bin is carried by count / nSpectrumSamples of the samples
+    if (HeroWavelengths::current()) {
+        sumValues[id] += s * (double(nSpectrumSamples) / HeroWavelengths::count);
+        return;
+    }
+#endif
     sumValues[id] += s;
 }
 
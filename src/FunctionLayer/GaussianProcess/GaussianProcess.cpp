@@ -55,7 +55,7 @@ Vec3d GPRealization::sampleGradient(Point3d pos, Vec3d rayDir, Sampler &sampler)
         auto realization = gp->sampleCond(gradPs.data(), gradDerivs.data(), gradDirs.data(), gradDirs.size(), {},
                                           points.data(), derivativeTypes.data(), derivativeDirections.data(), values.data(), points.size(), {}, sampler);
         // intersection's gradient is already known since we perform linear interpolation between points
-        sampleGrad = frame.toWorld({realization.values[0], realization.values[1], values[values.size() - 1]});
+        sampleGrad = frame.toWorld({Float(realization.values[0]), Float(realization.values[1]), Float(values[values.size() - 1])});
 
     } else {
         std::array<Vec3d, 3> gradDirs{
@@ -64,7 +64,7 @@ Vec3d GPRealization::sampleGradient(Point3d pos, Vec3d rayDir, Sampler &sampler)
             vec_conv<Vec3d>(frame.n)};
         auto realization = gp->sampleCond(gradPs.data(), gradDerivs.data(), gradDirs.data(), gradDirs.size(), {},
                                           points.data(), derivativeTypes.data(), derivativeDirections.data(), values.data(), points.size(), {}, sampler);
-        sampleGrad = frame.toWorld({realization.values[0], realization.values[1], realization.values[2]});
+        sampleGrad = frame.toWorld({Float(realization.values[0]), Float(realization.values[1]), Float(realization.values[2])});
     }
     return lastSampledGrad = sampleGrad;
 }
@@ -107,7 +107,7 @@ Spectrum AbstractPathIntegrator::Li(const Ray &initialRay, std::shared_ptr<Scene
         {
             break;
         }
-        const double eps = 1e-4; // todo
+        const double eps = rayOriginOffset(its.position);
         ray = Ray(its.position + sampleScatterRecord.wi * eps, sampleScatterRecord.wi);
     }
 
@@ -93,6 +93,8 @@ void GuidedPathIntegrator::renderPerThread(const std::shared_ptr<Scene> & scene)
    */
     sampler->startPixel({0, 0});
     auto ssampler = sampler->clone(0);
+    MemoryArena shadingArena;
+    MemoryArena::Scope arenaScope(shadingArena);
     while(true)
     {
         std::unique_lock tilesLock(tilesMutex);
@@ -114,15 +116,22 @@ void GuidedPathIntegrator::renderPerThread(const std::shared_ptr<Scene> & scene)
             ssampler->startPixel(pixelPosition);
             for (int i = 0; i < spp; i++)
             {
+                auto cameraSample = ssampler->getCameraSample();
+#ifdef USING_HERO_WAVELENGTHS
+                //* wavelengths of this camera sample, in effect until its radiance is deposited
+                HeroWavelengths wavelengths = HeroWavelengths::sample(ssampler->sample1D());
+                HeroWavelengths::Scope wavelengthScope(wavelengths);
+#endif
                 auto L = Li(
                     cam.generateRay(
                         film->getResolution(),
                         pixelPosition,
-                        ssampler->getCameraSample()
+                        cameraSample
                             ), scene
                 );
                 //                L = L.clamp(0.0,1.0);
                 film->deposit(pixelPosition, L);
+                shadingArena.reset();
                 /**
                  * @warning spp used in this for loop belongs to Integrator.
                  *          It is irrelevant with spp passed to Sampler.
@@ -170,7 +179,7 @@ Spectrum GuidedPathIntegrator::Li(const Ray &initialRay, std::shared_ptr<Scene>
         bounceInfos.emplace_back();
         BounceInfo &bInfo = bounceInfos.back();
         bInfo.position = Vec3d(its.position[0], its.position[1], its.position[2]);
-        bInfo.roughness = its.material->getBxDF(its)->getRoughness();
+        bInfo.roughness = its.getBxDF()->getRoughness();
 
         //* ----- Direct Illumination -----
         for (int i = 0; i < nDirectLightSamples; ++i) {
@@ -207,7 +216,7 @@ Spectrum GuidedPathIntegrator::Li(const Ray &initialRay, std::shared_ptr<Scene>
         bInfo.distanceFactor = computeDistanceFactor(its, -ray.direction, sampleScatterRecord.wi);
 
         //* Test whether the bsdf sampling ray hit the emitter
-        const double eps = 1e-4;
+        const double eps = rayOriginOffset(its.position);
         ray = Ray{its.position + sampleScatterRecord.wi * eps, sampleScatterRecord.wi};
         itsOpt = scene->intersect(ray);
 
@@ -276,8 +285,8 @@ PathIntegratorLocalRecord GuidedPathIntegrator::sampleScatter(const Intersection
     thread_local GuidedBxDF guidedBxDF;
 
     Vec3d wo = its.toLocal(-ray.direction);
-    std::shared_ptr<BxDF> bxdf = its.material->getBxDF(its);
-    Vec3d n = its.geometryNormal;
+    const std::shared_ptr<BxDF> &bxdf = its.getBxDF();
+    Vec3d n = its.shFrame.n;
 
     double roughness = bxdf->getRoughness();
 
@@ -303,8 +312,8 @@ PathIntegratorLocalRecord GuidedPathIntegrator::evalScatter(const Intersection &
 {
     thread_local GuidedBxDF guidedBxDF;
 
-    std::shared_ptr<BxDF> bxdf = its.material->getBxDF(its);
-    Normal3d n = its.geometryNormal;
+    const std::shared_ptr<BxDF> &bxdf = its.getBxDF();
+    Normal3d n = its.shFrame.n;
     double wiDotN = std::abs(dot(n, dirScatter));
     Vec3d wi = its.toLocal(dirScatter);
     Vec3d wo = its.toLocal(-ray.direction);
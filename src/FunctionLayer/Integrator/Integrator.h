@@ -38,6 +38,8 @@ public:
 	 * @param _film 
 	 */
     Integrator(std::shared_ptr<Camera> _camera, std::unique_ptr<Film> _film);
+
+    virtual ~Integrator() = default;
     /**
 	 * @brief Start to render the scene
 	 * 
@@ -38,6 +38,9 @@ void MonteCarloIntegrator::renderPerThread(std::shared_ptr<Scene> scene) {
 
     sampler->startPixel({0, 0});
     auto ssampler = sampler->clone(0);
+    //* BxDFs built while shading are placed in this thread's arena, see Material::makeBxDF
+    MemoryArena shadingArena;
+    MemoryArena::Scope arenaScope(shadingArena);
     while (true) {
         auto optionalTile = tileGenerator->generateNextTile();
         if (optionalTile == std::nullopt)
@@ -56,13 +59,20 @@ void MonteCarloIntegrator::renderPerThread(std::shared_ptr<Scene> scene) {
             // sampler->startPixel(pixelPosition);
             ssampler->startPixel(pixelPosition);
             for (int i = 0; i < spp; i++) {
+                auto cameraSample = ssampler->getCameraSample();
+#ifdef USING_HERO_WAVELENGTHS
+                //* wavelengths of this camera sample, in effect until its radiance is deposited
+                HeroWavelengths wavelengths = HeroWavelengths::sample(ssampler->sample1D());
+                HeroWavelengths::Scope wavelengthScope(wavelengths);
+#endif
                 auto L = Li(
                     cam.generateRay(
                         film->getResolution(),
                         pixelPosition,
-                        ssampler->getCameraSample()),
+                        cameraSample),
                     scene);
                 film->deposit(pixelPosition, L);
+                shadingArena.reset();
                 /**
                  * @warning spp used in this for loop belongs to Integrator.
                  *          It is irrelevant with spp passed to Sampler.
@@ -31,7 +31,16 @@ PathIntegratorNew::PathIntegratorNew(std::shared_ptr<Camera> _camera,
 Spectrum PathIntegratorNew::Li(const Ray &initialRay, 
                                std::shared_ptr<Scene> scene) 
 {
-    const double eps = 1e-4;
+    return tracePath(initialRay, scene, true);
+}
+
+/// @brief Radiance along a ray, traced as in Li.
+/// @param countFirstEmission Whether radiance emitted at the first hit (or from the environment) is counted,
+/// false for integrators that estimate the lighting arriving along this ray by other means.
+Spectrum PathIntegratorNew::tracePath(const Ray &initialRay,
+                                      std::shared_ptr<Scene> scene,
+                                      bool countFirstEmission)
+{
     Spectrum L{.0};
     Spectrum throughput{1.0};
     Ray ray = initialRay;
@@ -44,7 +53,7 @@ Spectrum PathIntegratorNew::Li(const Ray &initialRay,
         //* will be counted at the end of the loop
         //* except the ray generated by camera which is considered here.
         //* The radiance of environment map will be counted while no intersection is found but not here.
-        if (nBounces == 0) {
+        if (nBounces == 0 && countFirstEmission) {
             PathIntegratorLocalRecord evalLightRecord = evalEmittance(scene, itsOpt, ray);
             L += throughput * evalLightRecord.f;
         }
@@ -57,14 +66,16 @@ Spectrum PathIntegratorNew::Li(const Ray &initialRay,
         }
         
         auto its = itsOpt.value();
+        if (ray.hasDifferential)
+            its.computeRayDifferential(ray);
 
         nBounces++;
 
         // * Ignore null materials using isNull() flag.
-        if(its.material->getBxDF(its)->isNull()){
+        if(its.material->isNull()){
             nBounces--;
             // * hint: ray should be immersed in medium. However, PathIntegrator will ignore any medium.
-            ray = Ray{its.position + ray.direction * eps, ray.direction};
+            ray = Ray{its.position + ray.direction * rayOriginOffset(its.position), ray.direction};
             itsOpt=scene->intersect(ray);
             continue;
         }
@@ -103,7 +114,7 @@ Spectrum PathIntegratorNew::Li(const Ray &initialRay,
         }
 
         //* Another part of MIS, Test whether the bsdf sampling ray hit the emitter
-        ray = Ray{its.position + sampleScatterRecord.wi * eps, sampleScatterRecord.wi};
+        ray = Ray{its.position + sampleScatterRecord.wi * rayOriginOffset(its.position), sampleScatterRecord.wi};
         itsOpt = scene->intersect(ray);
 
         auto evalLightRecord = evalEmittance(scene, itsOpt, ray);
@@ -153,7 +164,7 @@ PathIntegratorLocalRecord PathIntegratorNew::evalEmittance(std::shared_ptr<Scene
         LEmission = record.s;
         Intersection tmpIts;
         tmpIts.position = ray.origin;
-        pdfDirect = record.pdfDirect * chooseOneLightPdf(scene, light);
+        pdfDirect = record.pdfDirect * chooseOneLightPdf(scene, light, ray.origin);
     }
     // Path integrator will ignore medium transmittance. And (of course) there will be no occlusion.
     // Spectrum transmittance(1.0);
@@ -170,17 +181,23 @@ PathIntegratorLocalRecord PathIntegratorNew::sampleDirectLighting(std::shared_pt
                                                                   const Intersection &its, 
                                                                   const Ray &ray)
 {
-    auto [light, pdfChooseLight] = chooseOneLight(scene, sampler->sample1D());
+    auto [light, pdfChooseLight] = chooseOneLight(scene, sampler->sample1D(), its.position);
+    if (!light)
+        return {-ray.direction, Spectrum(0.0), 0.0, false};
     auto record = light->sampleDirect(its, sampler->sample2D(), ray.timeMin);
     double pdfDirect = record.pdfDirect * pdfChooseLight; // pdfScatter with respect to solid angle
     Vec3d dirScatter = record.wi;
+    //* light behind an opaque surface is not scattered, so its shadow ray is not traced
+    if (!its.material->canScatter(its, -ray.direction, dirScatter))
+        return {dirScatter, Spectrum(0.0), pdfDirect, record.isDeltaPos};
     Spectrum Li = record.s;
     Point3d posL = record.dst;
     Point3d posS = its.position;
     Spectrum transmittance(1.0); // todo: transmittance eval
-    Ray visibilityTestingRay(posL - dirScatter * 1e-4, -dirScatter, ray.timeMin, ray.timeMax);
+    Ray visibilityTestingRay(posL - dirScatter * rayOriginOffset(posL), -dirScatter, ray.timeMin, ray.timeMax);
     auto visibilityTestingIts = scene->intersect(visibilityTestingRay);
-    if (!visibilityTestingIts.has_value() || visibilityTestingIts->object != its.object || (visibilityTestingIts->position - posS).length2() > 1e-6)
+    double tolerance = 10 * rayOriginOffset(posS);
+    if (!visibilityTestingIts.has_value() || visibilityTestingIts->object != its.object || (visibilityTestingIts->position - posS).length2() > tolerance * tolerance)
     {
         transmittance = 0.0;
     }
@@ -202,8 +219,8 @@ PathIntegratorLocalRecord PathIntegratorNew::evalScatter(const Intersection &its
 {
     if (its.material != nullptr)
     {
-        std::shared_ptr<BxDF> bxdf = its.material->getBxDF(its);
-        Normal3d n = its.geometryNormal;
+        const std::shared_ptr<BxDF> &bxdf = its.getBxDF();
+        Normal3d n = its.shFrame.n;
         double wiDotN = fm::abs(dot(n, dirScatter));
         Vec3d wi = its.toLocal(dirScatter);
         Vec3d wo = its.toLocal(-ray.direction);
@@ -230,8 +247,8 @@ PathIntegratorLocalRecord PathIntegratorNew::sampleScatter(const Intersection &i
     if (its.material != nullptr)
     {
         Vec3d wo = its.toLocal(-ray.direction);
-        std::shared_ptr<BxDF> bxdf = its.material->getBxDF(its);
-        Vec3d n = its.geometryNormal;
+        const std::shared_ptr<BxDF> &bxdf = its.getBxDF();
+        Vec3d n = its.shFrame.n;
         BxDFSampleResult bsdfSample = bxdf->sample(wo, sampler->sample2D(),false);
         double pdf = bsdfSample.pdf;
         Vec3d dirScatter = its.toWorld(bsdfSample.directionIn);
@@ -265,29 +282,27 @@ double PathIntegratorNew::russianRoulette(
 /// @brief (discretely) sample a light source.
 /// @param scene Scene description which is used to query scene lights.
 /// @param lightSample A random number within [0,1].
+/// @param position Receiving point, the light BVH picks lights by their estimated contribution there.
 /// @return Pointer of the sampled light source and corresponding (discrete) probility.
 std::pair<std::shared_ptr<Light>, double> 
 PathIntegratorNew::chooseOneLight(std::shared_ptr<Scene> scene,
-                                  double lightSample)
+                                  double lightSample,
+                                  const Point3d &position)
 {
-    // uniformly weighted
-    std::shared_ptr<std::vector<std::shared_ptr<Light>>> lights = scene->getLights();
-    int numLights = lights->size();
-    int lightID = std::min(numLights - 1, (int)(lightSample * numLights));
-    std::shared_ptr<Light> light = lights->operator[](lightID);
-    return {light, 1.0 / numLights};
+    // by estimated power, or by estimated contribution at position with the light BVH
+    return scene->sampleLight(lightSample, position);
 }
 
 /// @brief Calculate the (discrete) probility that a specific light source is sampled.
 /// @param scene Scene description which is used to query scene lights.
 /// @param light The specific light source.
+/// @param position Receiving point the light is chosen for.
 /// @return Corresponding (discrete) probility.
 double PathIntegratorNew::chooseOneLightPdf(std::shared_ptr<Scene> scene,
-                                            std::shared_ptr<Light> light)
+                                            std::shared_ptr<Light> light,
+                                            const Point3d &position)
 {
-    std::shared_ptr<std::vector<std::shared_ptr<Light>>> lights = scene->getLights();
-    int numLights = lights->size();
-    return 1.0 / numLights;
+    return scene->lightPdf(light.get(), position);
 }
 
 /// @brief Eval the effect of environment light source (infinite area light).
@@ -304,7 +319,7 @@ PathIntegratorLocalRecord PathIntegratorNew::evalEnvLights(std::shared_ptr<Scene
     {
         auto record = light->evalEnvironment(ray);
         L += record.s;
-        pdf += record.pdfEmitDir;
+        pdf += record.pdfEmitDir * chooseOneLightPdf(scene, light, ray.origin);
     } 
     return {-ray.direction, L, pdf};
 }
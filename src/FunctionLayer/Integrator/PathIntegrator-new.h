@@ -52,15 +52,19 @@ public:
                                    int nBounce) override;
 
     virtual std::pair<std::shared_ptr<Light>, double> chooseOneLight(std::shared_ptr<Scene> scene,
-                                                                     double lightSample);
+                                                                     double lightSample,
+                                                                     const Point3d &position);
 
     virtual double chooseOneLightPdf(std::shared_ptr<Scene> scene,
-                                     std::shared_ptr<Light> light);
+                                     std::shared_ptr<Light> light,
+                                     const Point3d &position);
 
     virtual PathIntegratorLocalRecord evalEnvLights(std::shared_ptr<Scene> scene,
                                                     const Ray &ray);
 
 protected:
+    Spectrum tracePath(const Ray &ray, std::shared_ptr<Scene> scene, bool countFirstEmission);
+
     const int nPathLengthLimit = 16;
     const double pRussianRoulette = 0.95;
 };
\ No newline at end of file
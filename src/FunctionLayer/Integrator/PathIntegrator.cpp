@@ -47,7 +47,7 @@ PathIntegratorLocalRecord PathIntegrator::evalEmittance(std::shared_ptr<Scene> s
         LEmission = record.s;
         Intersection tmpIts;
         tmpIts.position = ray.origin;
-        pdfDirect = record.pdfDirect * chooseOneLightPdf(scene, light);
+        pdfDirect = record.pdfDirect * chooseOneLightPdf(scene, light, ray.origin);
     }
     Spectrum transmittance(1.0); // todo: transmittance eval
     return {ray.direction, transmittance * LEmission, pdfDirect, false}; 
@@ -57,17 +57,24 @@ PathIntegratorLocalRecord PathIntegrator::sampleDirectLighting(std::shared_ptr<S
                                                                const Intersection &its,
                                                                const Ray &ray)
 {
-    auto [light, pdfChooseLight] = chooseOneLight(scene, sampler->sample1D());
+    auto [light, pdfChooseLight] = chooseOneLight(scene, sampler->sample1D(), its.position);
+    if (!light)
+        return {-ray.direction, Spectrum(0.0), 0.0, false};
     auto record = light->sampleDirect(its, sampler->sample2D(), ray.timeMin);
     double pdfDirect = record.pdfDirect * pdfChooseLight; // pdfScatter with respect to solid angle
     Vec3d dirScatter = record.wi;
+    //* light behind an opaque surface is not scattered, so its shadow ray is not traced
+    if (its.material && !its.material->canScatter(its, -ray.direction, dirScatter))
+        return {dirScatter, Spectrum(0.0), pdfDirect, record.isDeltaPos};
     Spectrum Li = record.s;
     Point3d posL = record.dst;
     Point3d posS = its.position;
     Spectrum transmittance(1.0); // todo: transmittance eval
-    Ray visibilityTestingRay(posL - dirScatter * 1e-4, -dirScatter, ray.timeMin, ray.timeMax);
+    Ray visibilityTestingRay(posL - dirScatter * rayOriginOffset(posL), -dirScatter, ray.timeMin, ray.timeMax);
     auto visibilityTestingIts = scene->intersect(visibilityTestingRay);
-    if (!visibilityTestingIts.has_value() || visibilityTestingIts->object != its.object || (visibilityTestingIts->position - posS).length2() > 1e-6)
+    //* the hit is recomputed from the other end, so it agrees with posS up to the rounding of the coordinates
+    double tolerance = 10 * rayOriginOffset(posS);
+    if (!visibilityTestingIts.has_value() || visibilityTestingIts->object != its.object || (visibilityTestingIts->position - posS).length2() > tolerance * tolerance)
     {
         transmittance = 0.0;
     }
@@ -83,8 +90,8 @@ PathIntegratorLocalRecord PathIntegrator::evalScatter(const Intersection &its,
 {
     if (its.material != nullptr)
     {
-        std::shared_ptr<BxDF> bxdf = its.material->getBxDF(its);
-        Normal3d n = its.geometryNormal;
+        const std::shared_ptr<BxDF> &bxdf = its.getBxDF();
+        Normal3d n = its.shFrame.n;
         double wiDotN = fm::abs(dot(n, dirScatter));
         Vec3d wi = its.toLocal(dirScatter);
         Vec3d wo = its.toLocal(-ray.direction);
@@ -107,8 +114,8 @@ PathIntegratorLocalRecord PathIntegrator::sampleScatter(const Intersection &its,
     if (its.material != nullptr)
     {
         Vec3d wo = its.toLocal(-ray.direction);
-        std::shared_ptr<BxDF> bxdf = its.material->getBxDF(its);
-        Vec3d n = its.geometryNormal;
+        const std::shared_ptr<BxDF> &bxdf = its.getBxDF();
+        Vec3d n = its.shFrame.n;
         BxDFSampleResult bsdfSample = bxdf->sample(wo, sampler->sample2D(),false);
         double pdf = bsdfSample.pdf;
         Vec3d dirScatter = its.toWorld(bsdfSample.directionIn);
@@ -135,22 +142,18 @@ double PathIntegrator::russianRoulette(const Spectrum &throughput,
 }
 
 std::pair<std::shared_ptr<Light>, double> PathIntegrator::chooseOneLight(std::shared_ptr<Scene> scene,
-                                                                         double lightSample)
+                                                                         double lightSample,
+                                                                         const Point3d &position)
 {
-    // uniformly weighted
-    std::shared_ptr<std::vector<std::shared_ptr<Light>>> lights = scene->getLights();
-    int numLights = lights->size();
-    int lightID = std::min(numLights - 1, (int)(lightSample * numLights));
-    std::shared_ptr<Light> light = lights->operator[](lightID);
-    return {light, 1.0 / numLights};
+    // by estimated power, or by estimated contribution at position with the light BVH
+    return scene->sampleLight(lightSample, position);
 }
 
 double PathIntegrator::chooseOneLightPdf(std::shared_ptr<Scene> scene,
-                                         std::shared_ptr<Light> light)
+                                         std::shared_ptr<Light> light,
+                                         const Point3d &position)
 {
-    std::shared_ptr<std::vector<std::shared_ptr<Light>>> lights = scene->getLights();
-    int numLights = lights->size();
-    return 1.0 / numLights;
+    return scene->lightPdf(light.get(), position);
 }
 
 PathIntegratorLocalRecord PathIntegrator::evalEnvLights(std::shared_ptr<Scene> scene,
@@ -163,7 +166,7 @@ PathIntegratorLocalRecord PathIntegrator::evalEnvLights(std::shared_ptr<Scene> s
     {
         auto record = light->evalEnvironment(ray);
         L += record.s;
-        pdf += record.pdfEmitDir;
+        pdf += record.pdfEmitDir * chooseOneLightPdf(scene, light, ray.origin);
     }
     return {-ray.direction, L, pdf};
 }
\ No newline at end of file
@@ -0,0 +1,267 @@
+/**
+ * @file ReSTIRIntegrator.cpp
+ * @author agent
+ * @brief Path integrator with reservoir resampled direct lighting at primary hits
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ */
+
+#include "ReSTIRIntegrator.h"
+#include "CoreLayer/Adapter/MemoryArena.h"
+#include <atomic>
+#include <thread>
+
+/// @brief Run func(y, rng, arena) for every row of the film on threadNum threads.
+/// Each thread has its own random numbers and shading arena.
+template<typename Func>
+static void forEachRow(int height, int threadNum, const Func &func) {
+    std::atomic<int> nextRow{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadNum; t++) {
+        threads.emplace_back([&] {
+            RandomNumberGenerator rng;
+            MemoryArena shadingArena;
+            for (int y = nextRow++; y < height; y = nextRow++)
+                func(y, rng, shadingArena);
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+}
+
+ReSTIRIntegrator::ReSTIRIntegrator(std::shared_ptr<Camera> _camera,
+                                   std::unique_ptr<Film> _film,
+                                   std::unique_ptr<TileGenerator> _tileGenerator,
+                                   std::shared_ptr<Sampler> _sampler,
+                                   int _spp,
+                                   int _renderThreadNum,
+                                   const Json &settings) :
+    PathIntegratorNew(_camera,
+                      std::move(_film),
+                      std::move(_tileGenerator),
+                      _sampler, _spp,
+                      _renderThreadNum)
+{
+    nCandidates = getOptional(settings, "candidates", 32);
+    temporalReuse = getOptional(settings, "temporal", true);
+    nSpatialNeighbours = getOptional(settings, "spatial_neighbours", 5);
+    spatialRadius = getOptional(settings, "spatial_radius", 16.0);
+    indirect = getOptional(settings, "indirect", true);
+}
+
+void ReSTIRIntegrator::render(std::shared_ptr<Scene> scene)
+{
+    Point2i resolution = film->getResolution();
+    int width = resolution.x, height = resolution.y;
+    size_t pixelCount = size_t(width) * height;
+    std::vector<PixelRecord> pixels(pixelCount);
+    //* reservoirs after temporal reuse, which neighbours read, and after spatial reuse, kept for the next pass
+    std::vector<ReSTIRReservoir> reservoirs(pixelCount), history(pixelCount);
+
+    for (int pass = 0; pass < spp; pass++) {
+        //* ----- Camera rays, candidates and temporal reuse -----
+        forEachRow(height, renderThreadNum, [&](int y, RandomNumberGenerator &rng, MemoryArena &) {
+            for (int x = 0; x < width; x++) {
+                size_t index = size_t(y) * width + x;
+                PixelRecord &pixel = pixels[index];
+                bool hadHit = pixel.its.has_value();
+                double previousDepth = pixel.depth;
+                Normal3d previousNormal = pixel.normal;
+                tracePrimary(scene, Point2i(x, y), rng, pixel);
+
+                reservoirs[index] = ReSTIRReservoir();
+                if (!pixel.its || pixel.its->material->isDelta())
+                    continue;
+#ifdef USING_HERO_WAVELENGTHS
+                HeroWavelengths::Scope wavelengthScope(pixel.wavelengths);
+#endif
+                ReSTIRReservoir reservoir = sampleCandidates(scene, pixel, rng);
+                if (temporalReuse && hadHit && similar(pixel.depth, pixel.normal, previousDepth, previousNormal)) {
+                    //* cap the history, rescaling its weights so that its contribution weight is kept
+                    ReSTIRReservoir previous = history[index];
+                    double contributionWeight = previous.contributionWeight();
+                    previous.M = std::min(previous.M, maxTemporalHistory * nCandidates);
+                    previous.weightSum = contributionWeight * previous.M * previous.targetPdf;
+                    combine(scene, pixel, reservoir, previous, rng);
+                }
+                reservoirs[index] = reservoir;
+            }
+        });
+
+        //* ----- Spatial reuse and shading -----
+        forEachRow(height, renderThreadNum, [&](int y, RandomNumberGenerator &rng, MemoryArena &shadingArena) {
+            for (int x = 0; x < width; x++) {
+                size_t index = size_t(y) * width + x;
+                const PixelRecord &pixel = pixels[index];
+#ifdef USING_HERO_WAVELENGTHS
+                HeroWavelengths::Scope wavelengthScope(pixel.wavelengths);
+#endif
+                Spectrum L = pixel.emitted;
+                history[index] = ReSTIRReservoir();
+                if (pixel.its && !pixel.its->material->isDelta()) {
+                    ReSTIRReservoir reservoir;
+                    combine(scene, pixel, reservoir, reservoirs[index], rng);
+                    for (int i = 0; i < nSpatialNeighbours; i++) {
+                        //* uniform in a disk of spatialRadius pixels
+                        double r = spatialRadius * std::sqrt(rng()), phi = 2 * M_PI * rng();
+                        int nx = x + int(std::lround(r * std::cos(phi)));
+                        int ny = y + int(std::lround(r * std::sin(phi)));
+                        if (nx < 0 || ny < 0 || nx >= width || ny >= height || (nx == x && ny == y))
+                            continue;
+                        size_t neighbourIndex = size_t(ny) * width + nx;
+                        const PixelRecord &neighbour = pixels[neighbourIndex];
+                        if (!neighbour.its || !similar(pixel.depth, pixel.normal, neighbour.depth, neighbour.normal))
+                            continue;
+                        combine(scene, pixel, reservoir, reservoirs[neighbourIndex], rng);
+                    }
+                    history[index] = reservoir;
+                    L += shade(scene, pixel, reservoir);
+                }
+
+                if (pixel.its && indirect) {
+                    MemoryArena::Scope arenaScope(shadingArena);
+                    const Intersection &its = pixel.its.value();
+                    PathIntegratorLocalRecord sampleScatterRecord = sampleScatter(its, pixel.ray);
+                    if (!sampleScatterRecord.f.isBlack() && sampleScatterRecord.pdf != 0) {
+                        Ray ray(its.position + sampleScatterRecord.wi * rayOriginOffset(its.position),
+                                sampleScatterRecord.wi);
+                        //* light arriving straight from the emitters was resampled above,
+                        //* except through delta lobes which light samples never reach
+                        L += sampleScatterRecord.f / sampleScatterRecord.pdf *
+                             tracePath(ray, scene, sampleScatterRecord.isDelta);
+                    }
+                }
+                shadingArena.reset();
+                film->deposit(Point2i(x, y), L);
+            }
+        });
+        printProgress(float(pass + 1) / spp);
+    }
+}
+
+void ReSTIRIntegrator::tracePrimary(std::shared_ptr<Scene> scene,
+                                    const Point2i &pixelPosition,
+                                    RandomNumberGenerator &rng,
+                                    PixelRecord &pixel)
+{
+    CameraSample cameraSample;
+    cameraSample.xy = Point2d(rng(), rng());
+    cameraSample.time = rng();
+    cameraSample.lens = Point2d(rng(), rng());
+#ifdef USING_HERO_WAVELENGTHS
+    pixel.wavelengths = HeroWavelengths::sample(rng());
+    HeroWavelengths::Scope wavelengthScope(pixel.wavelengths);
+#endif
+    Ray cameraRay = camera->generateRay(film->getResolution(), pixelPosition, cameraSample);
+    Ray ray = cameraRay;
+    auto itsOpt = scene->intersect(ray);
+    //* null surfaces are skipped, media are ignored as in PathIntegratorNew
+    while (itsOpt && itsOpt->material->isNull()) {
+        ray = Ray{itsOpt->position + ray.direction * rayOriginOffset(itsOpt->position), ray.direction};
+        itsOpt = scene->intersect(ray);
+    }
+    pixel.emitted = evalEmittance(scene, itsOpt, ray).f;
+    pixel.ray = ray;
+    pixel.its = itsOpt;
+    if (pixel.its) {
+        if (ray.hasDifferential)
+            pixel.its->computeRayDifferential(ray);
+        //* built now, outside of any shading arena, as other threads use the record in later stages
+        pixel.its->getBxDF();
+        pixel.depth = (pixel.its->position - cameraRay.origin).length();
+        pixel.normal = pixel.its->geometryNormal;
+    }
+}
+
+Spectrum ReSTIRIntegrator::replay(std::shared_ptr<Scene> scene,
+                                  const Intersection &its,
+                                  const Ray &ray,
+                                  const ReSTIRSample &sample,
+                                  LightSampleResult *record,
+                                  std::shared_ptr<Light> *light)
+{
+    auto [chosenLight, pdfChooseLight] = chooseOneLight(scene, sample.lightSample, its.position);
+    if (!chosenLight)
+        return Spectrum(0.0);
+    LightSampleResult lightRecord = chosenLight->sampleDirect(its, sample.positionSample, ray.timeMin);
+    double pdf = lightRecord.pdfDirect * pdfChooseLight;
+    if (pdf <= 0 || lightRecord.s.isBlack())
+        return Spectrum(0.0);
+    if (record)
+        *record = lightRecord;
+    if (light)
+        *light = chosenLight;
+    return lightRecord.s * evalScatter(its, ray, lightRecord.wi).f / pdf;
+}
+
+double ReSTIRIntegrator::targetPdf(std::shared_ptr<Scene> scene,
+                                   const Intersection &its,
+                                   const Ray &ray,
+                                   const ReSTIRSample &sample)
+{
+    double luminance = replay(scene, its, ray, sample, nullptr, nullptr).luminance();
+    return std::isfinite(luminance) ? std::max(0.0, luminance) : 0.0;
+}
+
+ReSTIRReservoir ReSTIRIntegrator::sampleCandidates(std::shared_ptr<Scene> scene,
+                                                   const PixelRecord &pixel,
+                                                   RandomNumberGenerator &rng)
+{
+    ReSTIRReservoir reservoir;
+    for (int i = 0; i < nCandidates; i++) {
+        ReSTIRSample candidate;
+        candidate.lightSample = rng();
+        candidate.positionSample = Point2d(rng(), rng());
+        //* candidates are uniform in primary sample space, so their weight is the target function itself
+        double candidateTargetPdf = targetPdf(scene, pixel.its.value(), pixel.ray, candidate);
+        reservoir.update(candidate, candidateTargetPdf, candidateTargetPdf, 1, rng());
+    }
+    return reservoir;
+}
+
+void ReSTIRIntegrator::combine(std::shared_ptr<Scene> scene,
+                               const PixelRecord &pixel,
+                               ReSTIRReservoir &target,
+                               const ReSTIRReservoir &source,
+                               RandomNumberGenerator &rng)
+{
+    if (source.M == 0)
+        return;
+    double sourceTargetPdf = source.targetPdf > 0 ? targetPdf(scene, pixel.its.value(), pixel.ray, source.sample) : 0;
+    target.update(source.sample, sourceTargetPdf * source.contributionWeight() * source.M,
+                  sourceTargetPdf, source.M, rng());
+}
+
+Spectrum ReSTIRIntegrator::shade(std::shared_ptr<Scene> scene,
+                                 const PixelRecord &pixel,
+                                 const ReSTIRReservoir &reservoir)
+{
+    double contributionWeight = reservoir.contributionWeight();
+    if (contributionWeight == 0)
+        return Spectrum(0.0);
+    const Intersection &its = pixel.its.value();
+    LightSampleResult record;
+    std::shared_ptr<Light> light;
+    Spectrum f = replay(scene, its, pixel.ray, reservoir.sample, &record, &light);
+    if (f.isBlack())
+        return Spectrum(0.0);
+
+    //* the one shadow ray of the pixel, tested as in PathIntegratorNew::sampleDirectLighting
+    Ray visibilityTestingRay(record.dst - record.wi * rayOriginOffset(record.dst), -record.wi,
+                             pixel.ray.timeMin, pixel.ray.timeMax);
+    auto visibilityTestingIts = scene->intersect(visibilityTestingRay);
+    double tolerance = 10 * rayOriginOffset(its.position);
+    bool visible = visibilityTestingIts.has_value() ?
+                   visibilityTestingIts->object == its.object &&
+                   (visibilityTestingIts->position - its.position).length2() <= tolerance * tolerance :
+                   light->lightType == ELightType::INFINITE;
+    return visible ? f * contributionWeight : Spectrum(0.0);
+}
+
+bool ReSTIRIntegrator::similar(double depthA, const Normal3d &normalA, double depthB, const Normal3d &normalB)
+{
+    return dot(normalA, normalB) > 0.9 && std::abs(depthA - depthB) <= 0.1 * depthA;
+}
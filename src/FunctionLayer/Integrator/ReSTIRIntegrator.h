@@ -0,0 +1,115 @@
+/**
+ * @file ReSTIRIntegrator.h
+ * @author agent
+ * @brief Path integrator with reservoir resampled direct lighting at primary hits
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ */
+
+#pragma once
+
+#include "PathIntegrator-new.h"
+#include "CoreLayer/Adapter/JsonUtil.h"
+
+/// @brief Light sample of a reservoir. It is kept as the random numbers that choose and sample the light, so
+/// it can be replayed at the shading point of another pixel (random replay in primary sample space).
+struct ReSTIRSample {
+    double lightSample = 0;
+    Point2d positionSample;
+};
+
+/// @brief Weighted reservoir of one pixel, as in Bitterli et al. 2020,
+/// "Spatiotemporal reservoir resampling for real-time ray tracing with dynamic direct lighting".
+struct ReSTIRReservoir {
+    ReSTIRSample sample;
+    double weightSum = 0;
+    double targetPdf = 0;   ///< target function of sample at the owning pixel
+    int M = 0;              ///< number of candidates behind the reservoir
+
+    /// @brief stream in a sample that stands for count candidates.
+    void update(const ReSTIRSample &candidate, double weight, double candidateTargetPdf, int count, double u) {
+        weightSum += weight;
+        M += count;
+        if (weight > 0 && u * weightSum < weight) {
+            sample = candidate;
+            targetPdf = candidateTargetPdf;
+        }
+    }
+
+    /// @brief weight turning the target function of sample into an estimate, 1 / pdf in plain importance sampling.
+    double contributionWeight() const {
+        return targetPdf > 0 ? weightSum / (M * targetPdf) : 0;
+    }
+};
+
+/**
+ * @brief Unidirectional path tracing where the direct lighting of primary hits is resampled (ReSTIR DI).
+ * Each pass traces one camera ray per pixel and streams many unshadowed light samples into the pixel's
+ * reservoir. That reservoir is merged with the pixel's reservoir from the previous pass (temporal reuse), then
+ * with those of a few nearby pixels (spatial reuse). Only the surviving sample is tested for visibility, so a
+ * pixel casts one shadow ray per pass for its direct lighting. The remaining light transport is path traced.
+ * Reuse weights neighbours by 1 / M without visibility, the cheap biased variant of the paper; it
+ * darkens contact shadows slightly and is meant for previews.
+ * @ingroup Integrator
+ */
+class ReSTIRIntegrator : public PathIntegratorNew
+{
+public:
+    /// @param settings "candidates", "temporal", "spatial_neighbours", "spatial_radius" and "indirect".
+    ReSTIRIntegrator(std::shared_ptr<Camera> _camera,
+                     std::unique_ptr<Film> _film,
+                     std::unique_ptr<TileGenerator> _tileGenerator,
+                     std::shared_ptr<Sampler> _sampler,
+                     int _spp,
+                     int _renderThreadNum,
+                     const Json &settings);
+
+    /// @brief spp progressive passes over the whole film.
+    virtual void render(std::shared_ptr<Scene> scene) override;
+
+protected:
+    /// @brief G-buffer entry: the first non-null hit of the pixel in the current pass.
+    struct PixelRecord {
+        std::optional<Intersection> its;
+        Ray ray = Ray(Point3d(0.0), Vec3d(0, 0, 1));
+        Spectrum emitted;       ///< radiance reaching the camera from the hit itself, or the environment
+        double depth = 0;
+        Normal3d normal;
+#ifdef USING_HERO_WAVELENGTHS
+        HeroWavelengths wavelengths;
+#endif
+    };
+
+    void tracePrimary(std::shared_ptr<Scene> scene, const Point2i &pixelPosition,
+                      RandomNumberGenerator &rng, PixelRecord &pixel);
+
+    /// @brief replay a sample at a shading point.
+    /// @return Light times scatter over the sampling pdf, without visibility.
+    Spectrum replay(std::shared_ptr<Scene> scene, const Intersection &its, const Ray &ray,
+                    const ReSTIRSample &sample, LightSampleResult *record, std::shared_ptr<Light> *light);
+
+    double targetPdf(std::shared_ptr<Scene> scene, const Intersection &its, const Ray &ray,
+                     const ReSTIRSample &sample);
+
+    ReSTIRReservoir sampleCandidates(std::shared_ptr<Scene> scene, const PixelRecord &pixel, RandomNumberGenerator &rng);
+
+    /// @brief merge a reservoir made at another shading point (or time) into one for pixel.
+    void combine(std::shared_ptr<Scene> scene, const PixelRecord &pixel, ReSTIRReservoir &target,
+                 const ReSTIRReservoir &source, RandomNumberGenerator &rng);
+
+    /// @brief direct lighting of pixel from its reservoir, with its shadow ray.
+    Spectrum shade(std::shared_ptr<Scene> scene, const PixelRecord &pixel, const ReSTIRReservoir &reservoir);
+
+    /// @brief whether two hits are similar enough surfaces to share samples.
+    static bool similar(double depthA, const Normal3d &normalA, double depthB, const Normal3d &normalB);
+
+    int nCandidates;
+    bool temporalReuse;
+    int nSpatialNeighbours;
+    double spatialRadius;
+    bool indirect;
+    int maxTemporalHistory = 20;    ///< the previous reservoir counts for at most this many times the new candidates
+};
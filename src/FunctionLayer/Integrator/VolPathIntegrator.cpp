@@ -32,7 +32,6 @@ Spectrum VolPathIntegrator::Li(const Ray &initialRay, std::shared_ptr<Scene> sce
 
     Ray ray = initialRay;
 
-    const double eps = 1e-5;
     int nBounces = 0;
     bool specularBounce = false;
     PathIntegratorLocalRecord prevLightSampleRecord;
@@ -44,6 +43,9 @@ Spectrum VolPathIntegrator::Li(const Ray &initialRay, std::shared_ptr<Scene> sce
     auto itsOpt = scene->intersect(ray);
 
     while (true) {
+        // BxDFs of the previous vertex are released by now, reuse their memory
+        if (MemoryArena *arena = MemoryArena::current())
+            arena->reset();
 
         MediumSampleRecord mRec{};
         mRec.mediumState = &mediumState;
@@ -77,7 +79,8 @@ Spectrum VolPathIntegrator::Li(const Ray &initialRay, std::shared_ptr<Scene> sce
             if (sampleScatterRecord.f.isBlack())
                 break;
             throughput *= sampleScatterRecord.f / sampleScatterRecord.pdf;
-            ray = Ray{mediumScatteringPoint.position + sampleScatterRecord.wi * eps, sampleScatterRecord.wi};
+            ray = Ray{mediumScatteringPoint.position + sampleScatterRecord.wi * rayOriginOffset(mediumScatteringPoint.position),
+                      sampleScatterRecord.wi};
             itsOpt = scene->intersect(ray);
             auto [sampleIts, tr] = intersectIgnoreSurface2(scene, ray, medium, &mediumState);
             auto evalLightRecord = evalEmittance(scene, sampleIts, ray);
@@ -102,17 +105,19 @@ Spectrum VolPathIntegrator::Li(const Ray &initialRay, std::shared_ptr<Scene> sce
 
             auto its = itsOpt.value();
             its.medium = medium;
+            if (ray.hasDifferential)
+                its.computeRayDifferential(ray);
 
-            if (its.material->getBxDF(its)->isNull()) {
+            if (its.material->isNull()) {
                 medium = getTargetMedium(its, ray.direction);
                 mediumState.reset();
-                ray = Ray{its.position + eps * ray.direction, ray.direction};
+                ray = Ray{its.position + rayOriginOffset(its.position) * ray.direction, ray.direction};
                 itsOpt = scene->intersect(ray);
                 continue;
             }
 
-            //* Direct Illumination
-            for (int i = 0; i < nDirectLightSamples; ++i) {
+            //* Direct Illumination, skipped for delta bsdfs which can not be hit by a light sample
+            for (int i = 0; i < nDirectLightSamples && !its.material->isDelta(); ++i) {
                 PathIntegratorLocalRecord sampleLightRecord = sampleDirectLighting2(scene, its, ray,&mediumState);
                 PathIntegratorLocalRecord evalScatterRecord = evalScatter(its, ray, sampleLightRecord.wi);
 
@@ -132,7 +137,7 @@ Spectrum VolPathIntegrator::Li(const Ray &initialRay, std::shared_ptr<Scene> sce
             throughput *= sampleScatterRecord.f / sampleScatterRecord.pdf;
 
             //* Test whether the sampling ray hit the emitter
-            const double eps = 1e-4;
+            const double eps = rayOriginOffset(its.position);
             ray = Ray{its.position + sampleScatterRecord.wi * eps, sampleScatterRecord.wi};
             itsOpt = scene->intersect(ray);
 
@@ -182,7 +187,7 @@ PathIntegratorLocalRecord VolPathIntegrator::evalEmittance(std::shared_ptr<Scene
         LEmission = record.s;
         Intersection tmpIts;
         tmpIts.position = ray.origin;
-        pdfDirect = record.pdfDirect * chooseOneLightPdf(scene, light);
+        pdfDirect = record.pdfDirect * chooseOneLightPdf(scene, light, ray.origin);
     }
     return {ray.direction, LEmission, pdfDirect, false};
 }
@@ -195,10 +200,15 @@ PathIntegratorLocalRecord VolPathIntegrator::evalEmittance(std::shared_ptr<Scene
 PathIntegratorLocalRecord VolPathIntegrator::sampleDirectLighting(std::shared_ptr<Scene> scene,
                                                                   const Intersection &its,
                                                                   const Ray &ray) {
-    auto [light, pdfChooseLight] = chooseOneLight(scene, sampler->sample1D());
+    auto [light, pdfChooseLight] = chooseOneLight(scene, sampler->sample1D(), its.position);
+    if (!light)
+        return {-ray.direction, Spectrum(0.0), 0.0, false};
     auto record = light->sampleDirect(its, sampler->sample2D(), ray.timeMin);
     double pdfDirect = record.pdfDirect * pdfChooseLight;// pdfScatter with respect to solid angle
     Vec3d dirScatter = record.wi;
+    //* light behind an opaque surface is not scattered, so the transmittance is not traced
+    if (its.material && !its.material->canScatter(its, -ray.direction, dirScatter))
+        return {dirScatter, Spectrum(0.0), pdfDirect, record.isDeltaPos};
     Point3d posL = record.dst;
     Point3d posS = its.position;
     auto transmittance = evalTransmittance(scene, its, record.dst);
@@ -217,8 +227,8 @@ PathIntegratorLocalRecord VolPathIntegrator::evalScatter(const Intersection &its
                                                          const Ray &ray,
                                                          const Vec3d &dirScatter) {
     if (its.material != nullptr) {
-        std::shared_ptr<BxDF> bxdf = its.material->getBxDF(its);
-        Normal3d n = its.geometryNormal;
+        const std::shared_ptr<BxDF> &bxdf = its.getBxDF();
+        Normal3d n = its.shFrame.n;
         double wiDotN = fm::abs(dot(n, dirScatter));
         Vec3d wi = its.toLocal(dirScatter);
         Vec3d wo = its.toLocal(-ray.direction);
@@ -249,8 +259,8 @@ PathIntegratorLocalRecord VolPathIntegrator::sampleScatter(const Intersection &i
                                                            const Ray &ray) {
     if (its.material != nullptr) {
         Vec3d wo = its.toLocal(-ray.direction);
-        std::shared_ptr<BxDF> bxdf = its.material->getBxDF(its);
-        Vec3d n = its.geometryNormal;
+        const std::shared_ptr<BxDF> &bxdf = its.getBxDF();
+        Vec3d n = its.shFrame.n;
         BxDFSampleResult bsdfSample = bxdf->sample(wo, sampler->sample2D(), false);
         double pdf = bsdfSample.pdf;
         Vec3d dirScatter = its.toWorld(bsdfSample.directionIn);
@@ -286,27 +296,25 @@ double VolPathIntegrator::russianRoulette(const Spectrum &throughput,
 /// @brief (discretely) sample a light source.
 /// @param scene Scene description which is used to query scene lights.
 /// @param lightSample A random number within [0,1].
+/// @param position Receiving point, the light BVH picks lights by their estimated contribution there.
 /// @return Pointer of the sampled light source and corresponding (discrete) probility.
 std::pair<std::shared_ptr<Light>, double>
 VolPathIntegrator::chooseOneLight(std::shared_ptr<Scene> scene,
-                                  double lightSample) {
-    // uniformly weighted
-    std::shared_ptr<std::vector<std::shared_ptr<Light>>> lights = scene->getLights();
-    int numLights = lights->size();
-    int lightID = std::min(numLights - 1, (int)(lightSample * numLights));
-    std::shared_ptr<Light> light = lights->operator[](lightID);
-    return {light, 1.0 / numLights};
+                                  double lightSample,
+                                  const Point3d &position) {
+    // by estimated power, or by estimated contribution at position with the light BVH
+    return scene->sampleLight(lightSample, position);
 }
 
 /// @brief Calculate the (discrete) probility that a specific light source is sampled.
 /// @param scene Scene description which is used to query scene lights.
 /// @param light The specific light source.
+/// @param position Receiving point the light is chosen for.
 /// @return Corresponding (discrete) probility.
 double VolPathIntegrator::chooseOneLightPdf(std::shared_ptr<Scene> scene,
-                                            std::shared_ptr<Light> light) {
-    std::shared_ptr<std::vector<std::shared_ptr<Light>>> lights = scene->getLights();
-    int numLights = lights->size();
-    return 1.0 / numLights;
+                                            std::shared_ptr<Light> light,
+                                            const Point3d &position) {
+    return scene->lightPdf(light.get(), position);
 }
 
 /// @brief Eval the effect of environment light source (infinite area light).
@@ -322,7 +330,7 @@ PathIntegratorLocalRecord VolPathIntegrator::evalEnvLights(std::shared_ptr<Scene
     for (auto light : *lights) {
         auto record = light->evalEnvironment(ray);
         L += record.s;
-        pdf += record.pdfEmitDir;
+        pdf += record.pdfEmitDir * chooseOneLightPdf(scene, light, ray.origin);
     }
     return {-ray.direction, L, pdf};
 }
@@ -356,7 +364,8 @@ Spectrum VolPathIntegrator::evalTransmittance(std::shared_ptr<Scene> scene,
     // }
 
     float tmax = (pointOnLight - its.position).length();
-    Ray shadowRay{its.position, normalize(pointOnLight - its.position), 1e-4f, tmax - 1e-4f};
+    double eps = rayOriginOffset(its.position);
+    Ray shadowRay{its.position, normalize(pointOnLight - its.position), eps, tmax - eps};
     std::shared_ptr<Medium> medium = its.medium;
     Spectrum tr(1.f);
     while (true) {
@@ -368,7 +377,7 @@ Spectrum VolPathIntegrator::evalTransmittance(std::shared_ptr<Scene> scene,
                 break;
             }
 
-            if (!itsOpt->material->getBxDF(*itsOpt)->isNull()) {
+            if (!itsOpt->material->isNull()) {
                 tr = .0f;
                 break;
             }
@@ -376,16 +385,18 @@ Spectrum VolPathIntegrator::evalTransmittance(std::shared_ptr<Scene> scene,
             tr *= medium->evalTransmittance(shadowRay.origin, itsOpt->position);
             medium = getTargetMedium(*itsOpt, shadowRay.direction);
             shadowRay.origin = itsOpt->position;
+            shadowRay.timeMin = rayOriginOffset(itsOpt->position);
             shadowRay.timeMax -= itsOpt->t;
         } else {
             if (!itsOpt) break;
 
-            if (!itsOpt->material->getBxDF(*itsOpt)->isNull()) {
+            if (!itsOpt->material->isNull()) {
                 tr = .0f;
                 break;
             }
             medium = getTargetMedium(*itsOpt, shadowRay.direction);
             shadowRay.origin = itsOpt->position;
+            shadowRay.timeMin = rayOriginOffset(itsOpt->position);
             shadowRay.timeMax -= itsOpt->t;
         }
     }
@@ -425,11 +436,10 @@ std::pair<std::optional<Intersection>, Spectrum>
 VolPathIntegrator::intersectIgnoreSurface(std::shared_ptr<Scene> scene,
                                           const Ray &ray,
                                           std::shared_ptr<Medium> medium) const {
-    const double eps = 1e-5;
     Vec3d dir = ray.direction;
 
     Spectrum tr(1.0);
-    Ray marchRay{ray.origin + dir * eps, dir};
+    Ray marchRay{ray.origin + dir * rayOriginOffset(ray.origin), dir};
     std::shared_ptr<Medium> currentMedium = medium;
 
     Point3d lastScatteringPoint = ray.origin;
@@ -449,7 +459,7 @@ VolPathIntegrator::intersectIgnoreSurface(std::shared_ptr<Scene> scene,
 
         // corner case: non-null surface
         if (testRayIts.material != nullptr) {
-            if (!testRayIts.material->getBxDF(testRayIts)->isNull()) {
+            if (!testRayIts.material->isNull()) {
                 if (currentMedium != nullptr)
                     tr *= currentMedium->evalTransmittance(testRayIts.position, lastScatteringPoint);
                 return {testRayItsOpt, tr};
@@ -464,7 +474,7 @@ VolPathIntegrator::intersectIgnoreSurface(std::shared_ptr<Scene> scene,
         currentMedium = getTargetMedium(testRayIts, dir);
 
         // update ray and intersection point.
-        marchRay.origin = testRayIts.position + dir * eps;
+        marchRay.origin = testRayIts.position + dir * rayOriginOffset(testRayIts.position);
         lastScatteringPoint = testRayIts.position;
         testRayItsOpt = scene->intersect(marchRay);
     }
@@ -480,7 +490,8 @@ VolPathIntegrator::intersectIgnoreSurface(std::shared_ptr<Scene> scene,
 Spectrum VolPathIntegrator::evalTransmittance2(std::shared_ptr<Scene> scene, const Intersection &its, Point3d pointOnLight, const MediumState *mediumState) const {
     MediumState transientMeidumState = *mediumState;
     float tmax = (pointOnLight - its.position).length();
-    Ray shadowRay{its.position, normalize(pointOnLight - its.position), 1e-4f, tmax - 1e-4f};
+    double eps = rayOriginOffset(its.position);
+    Ray shadowRay{its.position, normalize(pointOnLight - its.position), eps, tmax - eps};
     std::shared_ptr<Medium> medium = its.medium;
     Spectrum tr(1.f);
     while (true) {
@@ -492,7 +503,7 @@ Spectrum VolPathIntegrator::evalTransmittance2(std::shared_ptr<Scene> scene, con
                 break;
             }
 
-            if (!itsOpt->material->getBxDF(*itsOpt)->isNull()) {
+            if (!itsOpt->material->isNull()) {
                 tr = .0f;
                 break;
             }
@@ -501,17 +512,19 @@ Spectrum VolPathIntegrator::evalTransmittance2(std::shared_ptr<Scene> scene, con
             medium = getTargetMedium(*itsOpt, shadowRay.direction);
             transientMeidumState.reset();
             shadowRay.origin = itsOpt->position;
+            shadowRay.timeMin = rayOriginOffset(itsOpt->position);
             shadowRay.timeMax -= itsOpt->t;
         } else {
             if (!itsOpt) break;
 
-            if (!itsOpt->material->getBxDF(*itsOpt)->isNull()) {
+            if (!itsOpt->material->isNull()) {
                 tr = .0f;
                 break;
             }
             medium = getTargetMedium(*itsOpt, shadowRay.direction);
             transientMeidumState.reset();
             shadowRay.origin = itsOpt->position;
+            shadowRay.timeMin = rayOriginOffset(itsOpt->position);
             shadowRay.timeMax -= itsOpt->t;
         }
     }
@@ -525,10 +538,15 @@ Spectrum VolPathIntegrator::evalTransmittance2(std::shared_ptr<Scene> scene, con
 /// @param meidumState Inital meidum state
 /// @return Sampled direction on the distribution of direct lighting and corresponding solid angle dependent pdf. An extra flag indicites that whether it sampled on a delta distribution.
 PathIntegratorLocalRecord VolPathIntegrator::sampleDirectLighting2(std::shared_ptr<Scene> scene, const Intersection &its, const Ray &ray, const MediumState *mediumState) {
-    auto [light, pdfChooseLight] = chooseOneLight(scene, sampler->sample1D());
+    auto [light, pdfChooseLight] = chooseOneLight(scene, sampler->sample1D(), its.position);
+    if (!light)
+        return {-ray.direction, Spectrum(0.0), 0.0, false};
     auto record = light->sampleDirect(its, sampler->sample2D(), ray.timeMin);
     double pdfDirect = record.pdfDirect * pdfChooseLight;// pdfScatter with respect to solid angle
     Vec3d dirScatter = record.wi;
+    //* light behind an opaque surface is not scattered, so the transmittance is not traced
+    if (its.material && !its.material->canScatter(its, -ray.direction, dirScatter))
+        return {dirScatter, Spectrum(0.0), pdfDirect, record.isDeltaPos};
     Point3d posL = record.dst;
     Point3d posS = its.position;
     auto transmittance = evalTransmittance2(scene, its, record.dst, mediumState);
@@ -546,11 +564,10 @@ PathIntegratorLocalRecord VolPathIntegrator::sampleDirectLighting2(std::shared_p
 std::pair<std::optional<Intersection>, Spectrum> VolPathIntegrator::intersectIgnoreSurface2(std::shared_ptr<Scene> scene, const Ray &ray, std::shared_ptr<Medium> medium, const MediumState *mediumState) const {
     MediumState transientMeidumState = *mediumState;
 
-    const double eps = 1e-5;
     Vec3d dir = ray.direction;
 
     Spectrum tr(1.0);
-    Ray marchRay{ray.origin + dir * eps, dir};
+    Ray marchRay{ray.origin + dir * rayOriginOffset(ray.origin), dir};
     std::shared_ptr<Medium> currentMedium = medium;
 
     Point3d lastScatteringPoint = ray.origin;
@@ -570,7 +587,7 @@ std::pair<std::optional<Intersection>, Spectrum> VolPathIntegrator::intersectIgn
 
         // corner case: non-null surface
         if (testRayIts.material != nullptr) {
-            if (!testRayIts.material->getBxDF(testRayIts)->isNull()) {
+            if (!testRayIts.material->isNull()) {
                 if (currentMedium != nullptr)
                     tr *= currentMedium->evalTransmittance2(testRayIts.position, lastScatteringPoint, &transientMeidumState);
                 return {testRayItsOpt, tr};
@@ -586,7 +603,7 @@ std::pair<std::optional<Intersection>, Spectrum> VolPathIntegrator::intersectIgn
         transientMeidumState.reset();
 
         // update ray and intersection point.
-        marchRay.origin = testRayIts.position + dir * eps;
+        marchRay.origin = testRayIts.position + dir * rayOriginOffset(testRayIts.position);
         lastScatteringPoint = testRayIts.position;
         testRayItsOpt = scene->intersect(marchRay);
     }
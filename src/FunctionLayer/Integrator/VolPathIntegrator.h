@@ -53,10 +53,12 @@ public:
                                    int nBounce) override;
 
     virtual std::pair<std::shared_ptr<Light>, double> chooseOneLight(std::shared_ptr<Scene> scene,
-                                                                     double lightSample);
+                                                                     double lightSample,
+                                                                     const Point3d &position);
 
     virtual double chooseOneLightPdf(std::shared_ptr<Scene> scene,
-                                     std::shared_ptr<Light> light);
+                                     std::shared_ptr<Light> light,
+                                     const Point3d &position);
 
     virtual PathIntegratorLocalRecord evalEnvLights(std::shared_ptr<Scene> scene,
                                                     const Ray &ray);
@@ -38,8 +38,8 @@ struct Intersection {
     Vec3d dpdu, dpdv;
     Normal3d dndu, dndv;
 
-    // raydifferential
-    float dudx, dvdx, dudy, dvdy;
+    // raydifferential, zero when the ray carries no differentials
+    float dudx = 0, dvdx = 0, dudy = 0, dvdy = 0;
     Vec3d dpdx, dpdy;
 
     // std::shared_ptr<Entity> object;
@@ -59,19 +59,28 @@ struct Intersection {
         return shFrame.toWorld(d);
     }
 
+    /// @brief BxDF of the material at this point, built on the first query and reused by the later ones.
+    ///        Call it only once the shading frame and the ray differentials are final.
+    const std::shared_ptr<BxDF> &getBxDF() const {
+        if (!bxdf)
+            bxdf = material->getBxDF(*this);
+        return bxdf;
+    }
+
     Ray spawnRay(const Point3d &target) const {
         Vec3d dir = (target - position);
         double l = dir.length();
-        const double eps = 1e-4;
+        const double eps = rayOriginOffset(position);
         return Ray(position, normalize(dir), eps, l);
     }
     // compute differential, reference implementation in lite
     void computeRayDifferential(const Ray &ray) {
+        bxdf = nullptr;
 
         dudx = 0.f;
         dudy = 0.f;
         dvdx = 0.f;
-        dvdy = 1.f;
+        dvdy = 0.f;
         dpdx = Vec3d(0.f);
         dpdy = Vec3d(0.f);
 
@@ -88,8 +97,8 @@ struct Intersection {
         if (std::isinf(ty) || std::isnan(ty))
             return;
 
-        dpdx = normalize((ray.origin_x + tx * ray.direction_x) - p);
-        dpdy = normalize((ray.origin_y + ty * ray.direction_y) - p);
+        dpdx = (ray.origin_x + tx * ray.direction_x) - p;
+        dpdy = (ray.origin_y + ty * ray.direction_y) - p;
 
         int dim[2];
         if (std::abs(n[0]) > std::abs(n[1]) && std::abs(n[0]) > std::abs(n[2])) {
@@ -122,9 +131,12 @@ struct Intersection {
 
         if (!solveLinearSystem2x2(A, Bx, &dudx, &dvdx))
             dudx = dvdx = .0f;
-        if (!solveLinearSystem2x2(A, Bx, &dudy, &dvdy))
+        if (!solveLinearSystem2x2(A, By, &dudy, &dvdy))
             dudy = dvdy = .0f;
 
         return;
     }
+
+private:
+    mutable std::shared_ptr<BxDF> bxdf;
 };
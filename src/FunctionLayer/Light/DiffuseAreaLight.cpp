@@ -40,12 +40,11 @@ LightSampleResult DiffuseAreaLight::eval(const Ray &ray, const Intersection &its
     ans.wi = d;
     ans.isDeltaPos = false;
     ans.isDeltaDir = false;
-    double dist2 = (ans.dst - ans.src).length2();
     if (dot(-d, its.geometryNormal) > 0.0) {
         ans.s = radiance;
         ans.pdfEmitPos = 1.0 / shape->area();
         ans.pdfEmitDir = 1.0 / M_PI / 2;
-        ans.pdfDirect = ans.pdfEmitPos * dist2 / dot(-d, its.geometryNormal);
+        ans.pdfDirect = shape->pdfSolidAngle(ans.src, its);
     } else {
         ans.s = 0.0;
         ans.pdfEmitPos = 0.0;
@@ -77,60 +76,51 @@ LightSampleResult DiffuseAreaLight::sampleEmit(const Point2d &positionSample, co
 }
 
 LightSampleResult DiffuseAreaLight::sampleDirect(const Intersection &its, const Point2d &sample, float time) {
-    // Fill s, src, dst, wi, pdf, pdfP, pdfD, isDP, isDD
-    Intersection itsEmitter = shape->sample(sample);
-    Point3d pos = itsEmitter.position;
-    Normal3d normal = itsEmitter.geometryNormal;
-    Vec3d wi = normalize(pos - its.position);
-    LightSampleResult ans;
-    ans.src = its.position;
-    ans.dst = itsEmitter.position;
-    double dist2 = (ans.dst - ans.src).length2();
-    if (dot(-wi, itsEmitter.geometryNormal) > 0) {
-        ans.s = radiance;
-        ans.pdfEmitPos = 1.0 / shape->area();
-        ans.pdfEmitDir = 1.0 / M_PI / 2;
-        ans.wi = wi;
-        ans.pdfDirect = ans.pdfEmitPos * dist2 / dot(-wi, itsEmitter.geometryNormal);
-    } else {
-        ans.s = 0;
-        ans.pdfEmitPos = 0;
-        ans.pdfEmitDir = 0;
-        ans.pdfDirect = 0;
-        ans.wi = wi;
-    }
-    ans.isDeltaPos = false;
-    ans.isDeltaDir = false;
-    return ans;
+    return sampleDirect(its.position, sample);
 }
 
 LightSampleResult DiffuseAreaLight::sampleDirect(const MediumSampleRecord &mRec,
                                                  Point2d sample,
                                                  double time) {
-    Intersection itsEmitter = shape->sample(sample);
-    Point3d pos = itsEmitter.position;
-    Normal3d normal = itsEmitter.geometryNormal;
-    Vec3d wi = normalize(pos - mRec.scatterPoint);
+    return sampleDirect(mRec.scatterPoint, sample);
+}
+
+LightSampleResult DiffuseAreaLight::sampleDirect(const Point3d &receiver, const Point2d &sample) const {
+    // Fill s, src, dst, wi, pdf, pdfP, pdfD, isDP, isDD
+    double pdfSolidAngle;
+    Intersection itsEmitter = shape->sampleSolidAngle(receiver, sample, &pdfSolidAngle);
+    Vec3d wi = normalize(itsEmitter.position - receiver);
     LightSampleResult ans;
-    ans.src = mRec.scatterPoint;
+    ans.src = receiver;
     ans.dst = itsEmitter.position;
-    double dist2 = (ans.dst - ans.src).length2();
-
-    if (dot(-wi, itsEmitter.geometryNormal) > 0) {
+    ans.wi = wi;
+    if (dot(-wi, itsEmitter.geometryNormal) > 0 && pdfSolidAngle > 0) {
         ans.s = radiance;
         ans.pdfEmitPos = 1.0 / shape->area();
         ans.pdfEmitDir = 1.0 / M_PI / 2;
-        ans.wi = wi;
-        ans.pdfDirect = ans.pdfEmitPos * dist2 / dot(-wi, itsEmitter.geometryNormal);
-
+        ans.pdfDirect = pdfSolidAngle;
     } else {
         ans.s = 0;
         ans.pdfEmitPos = 0;
         ans.pdfEmitDir = 0;
         ans.pdfDirect = 0;
-        ans.wi = wi;
     }
     ans.isDeltaPos = false;
     ans.isDeltaDir = false;
     return ans;
-}
\ No newline at end of file
+}
+
+double DiffuseAreaLight::power(double sceneRadius) const {
+    // one-sided lambertian emitter
+    return M_PI * shape->area() * radiance.luminance();
+}
+
+std::optional<LightBounds> DiffuseAreaLight::bounds() const {
+    LightBounds lightBounds;
+    lightBounds.bounds = shape->WorldBound();
+    lightBounds.phi = power(0);
+    std::tie(lightBounds.w, lightBounds.cosThetaO) = shape->normalCone();
+    lightBounds.cosThetaE = 0;
+    lightBounds.twoSided = false;
+    return lightBounds;
+}
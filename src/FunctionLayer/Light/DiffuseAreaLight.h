@@ -34,4 +34,12 @@ public:
     virtual LightSampleResult sampleDirect(const MediumSampleRecord &mRec,
 										   Point2d sample,
 										   double time) override;
+
+    virtual double power(double sceneRadius) const override;
+
+    virtual std::optional<LightBounds> bounds() const override;
+
+protected:
+    /// \brief Sample a point of the shape by solid angle as seen from receiver.
+    LightSampleResult sampleDirect(const Point3d &receiver, const Point2d &sample) const;
 };
\ No newline at end of file
@@ -79,3 +79,8 @@ double InfiniteSphereCapLight::directPdf(Vec3d dir) {
         return 0;
     return uniformSphericalCapPdf(_cosCapAngle);
 }
+
+double InfiniteSphereCapLight::power(double sceneRadius) const {
+    //* radiance over the cap's solid angle, through a disk as large as the scene
+    return M_PI * sceneRadius * sceneRadius * _emission.luminance() * 2 * M_PI * ( 1 - _cosCapAngle );
+}
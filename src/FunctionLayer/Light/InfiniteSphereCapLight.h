@@ -30,6 +30,8 @@ public:
     LightSampleResult sampleDirect(const Intersection & its, const Point2d & sample, float time) override;
 
     LightSampleResult sampleDirect(const MediumSampleRecord & mRec, Point2d sample, double time) override;
+
+    double power(double sceneRadius) const override;
 protected:
     double  directPdf(Vec3d dir);
 
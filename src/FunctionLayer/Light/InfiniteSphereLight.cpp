@@ -1,40 +1,64 @@
 #include "InfiniteSphereLight.h"
 #include "ResourceLayer/File/FileUtils.h"
 #include "FastMath.h"
+#include "CoreLayer/Adapter/Parallel.h"
+#include "CoreLayer/Math/Warp.h"
+#include "CoreLayer/Profiler/LoadProfiler.h"
 
-Vec3d InfiniteSphereLight::UvToDirection(const Point2d & uv, double & sinTheta) {
+/// @brief bilinear lookup, wrapping around in phi and clamped at the poles.
+static RGB3 equirectLookup(const Image &image, const Point2d &uv) {
+    int w = image.getWidth(), h = image.getHeight();
+    double u = uv.x * w - 0.5, v = uv.y * h - 0.5;
+    int iu0 = std::floor(u), iv0 = std::floor(v);
+    u -= iu0;
+    v -= iv0;
+    int iu1 = mod(iu0 + 1, w), iv1 = clamp(iv0 + 1, 0, h - 1);
+    iu0 = mod(iu0, w);
+    iv0 = clamp(iv0, 0, h - 1);
+    return lerp(image.getRGBColorAt(Point2i(iu0, iv0)), image.getRGBColorAt(Point2i(iu1, iv0)),
+                image.getRGBColorAt(Point2i(iu0, iv1)), image.getRGBColorAt(Point2i(iu1, iv1)), u, v);
+}
+
+Vec3d InfiniteSphereLight::UvToLocalDirection(const Point2d & uv, double & sinTheta) {
     double phi = ( uv.x - 0.5 ) * 2 * M_PI;
     double theta = uv.y * M_PI;
     sinTheta = fm::sin(theta);
-    return  matrix->operator*(Vec3d(
+    return Vec3d(
             fm::cos(phi) * sinTheta,
             -fm::cos(theta),
-            fm::sin(phi) * sinTheta));
+            fm::sin(phi) * sinTheta);
 }
 
-Point2d InfiniteSphereLight::DirectionToUv(const Vec3d & direction) {
-    auto localDir = _toLocal.operator*(direction);
-    return Point2d(fm::atan2(localDir.z, localDir.x) * 0.5 * INV_PI + 0.5, fm::acos(-localDir.y) * INV_PI);
+Vec3d InfiniteSphereLight::UvToDirection(const Point2d & uv, double & sinTheta) {
+    return _toWorld * UvToLocalDirection(uv, sinTheta);
 }
 
-Point2d InfiniteSphereLight::DirectionToUv(const Vec3d & direction, double & sinTheta) {
-    auto localDir = _toLocal.operator*(direction);
-    sinTheta = sqrt(1 - localDir.y * localDir.y);
+Point2d InfiniteSphereLight::LocalDirectionToUv(const Vec3d & localDir, double & sinTheta) {
+    sinTheta = sqrt(std::max<double>(0.0, 1 - localDir.y * localDir.y));
     return Point2d(fm::atan2(localDir.z, localDir.x) * 0.5 * INV_PI + 0.5, fm::acos(- localDir.y) * INV_PI);
 }
 
+Spectrum InfiniteSphereLight::lookupRadiance(const Vec3d & localDir, double & pdf) {
+    double sinTheta;
+    Point2d uv = LocalDirectionToUv(localDir, sinTheta);
+    if ( tableResolution )
+        //* the table is equal-area, so a density over the square is that density over 4pi steradians
+        pdf = distribution->Pdf(EqualAreaSphereToSquare(localDir)) * 0.25 * INV_PI;
+    else
+        pdf = directPdf(uv, sinTheta);
+    return emission->eval(TextureCoord2D(uv));
+}
 
 LightSampleResult InfiniteSphereLight::evalEnvironment(const Ray & ray) {
-
-
-    //todo support environment
     LightSampleResult ans;
-    TextureCoord2D textureCoord2D(DirectionToUv( ray.direction));
-    ans.s = emission->eval(textureCoord2D);
+    //* one transform and one lookup per miss, shared by the radiance and the pdf
+    Vec3d localDir = normalize(_toWorld.inverseVector(ray.direction));
+    double pdf;
+    ans.s = lookupRadiance(localDir, pdf);
     ans.src = ray.origin;
     ans.pdfDirect = 0.0;
     ans.pdfEmitPos = 0.0;
-    ans.pdfEmitDir = directPdf(ray.direction);
+    ans.pdfEmitDir = pdf;
     ans.isDeltaPos = false;
     ans.isDeltaDir = false;
     return ans;
@@ -58,16 +82,23 @@ LightSampleResult InfiniteSphereLight::sampleDirect(const Intersection & its, co
         ans.s = Spectrum(0);
         return ans;
     }
-    TextureCoord2D textureCoord2D(uv);
-    ans.s = emission->eval(textureCoord2D);
+    Vec3d localDir;
     double sinTheta;
-    Vec3d dir = UvToDirection(uv, sinTheta);
+    if ( tableResolution ) {
+        localDir = SquareToEqualAreaSphere(uv);
+        ans.pdfDirect = pdf * tableResolution * tableResolution * 0.25 * INV_PI;
+        uv = LocalDirectionToUv(localDir, sinTheta);
+    } else {
+        localDir = UvToLocalDirection(uv, sinTheta);
+        ans.pdfDirect = pdf * emission->getWidth() * emission->getHeight() / ( 2 * M_PI * M_PI * sinTheta );
+    }
+    ans.s = emission->eval(TextureCoord2D(uv));
+    Vec3d dir = _toWorld * localDir;
 
     ans.src = its.position;
     double _worldRadius = 100; //todo load radius from scene
     ans.dst = ans.src + 2 * _worldRadius * dir;
     ans.uv = uv;
-    ans.pdfDirect = pdf * emission->getWidth() * emission->getHeight() / ( 2 * M_PI * M_PI * sinTheta );
     ans.wi = dir;
     ans.isDeltaPos = false;
     ans.isDeltaDir = false;
@@ -79,22 +110,83 @@ LightSampleResult InfiniteSphereLight::sampleDirect(const MediumSampleRecord & m
 }
 
 InfiniteSphereLight::InfiniteSphereLight(const Json & json) : Light(ELightType::INFINITE), Transform3D(getOptional(json,"transform",Json())) {
+    _toWorld = matrix->getAffine();
     if ( json.contains("emission") ) {
-        std::string workingDir = FileUtils::getWorkingDir();
         std::string emissionTexturePath = FileUtils::getWorkingDir() + json.at("emission").get < std::string >();
-        emission = std::make_shared < ImageTexture < Spectrum, RGB3>>(
-                FileUtils::getWorkingDir() + json.at("emission").get < std::string >());
-        std::vector < double > weights = emission->sphericalWeighs();
-        //todo sphere weights
-        distribution = std::make_unique < Distribution2D >(weights.data(), emission->getWidth(), emission->getHeight());
+        emission = std::make_shared < ImageTexture < Spectrum, RGB3>>(emissionTexturePath);
+        image = ImageManager::getInstance()->getImage(emissionTexturePath);
+        ProfileScope profile("light distribution", emissionTexturePath);
+        size_t bytes = 0;
+
+        // "lookup": "octahedral" (default) samples an equal-area table resampled from the map, "direct" samples
+        // the source texels. Radiance is filtered from the source map either way, at its full resolution.
+        if ( getOptional(json, "lookup", std::string("octahedral")) == "octahedral" ) {
+            //* about two table cells per source texel, capped at 2048^2 (64MB of alias tables): the table
+            //* only steers sampling. "lookup_resolution" lifts the cap.
+            int w = image->getWidth(), h = image->getHeight();
+            int resolution = 1;
+            while ( resolution < 2048 && double(resolution) * resolution < 2.0 * w * h ) resolution <<= 1;
+            tableResolution = getOptional(json, "lookup_resolution", resolution);
+        }
+
+        // "sampling": "alias" (default, constant time) or "cdf" (binary search)
+        auto sampling = getOptional(json, "sampling", std::string("alias")) == "cdf" ?
+                        EDistributionSampling::CDF : EDistributionSampling::ALIAS;
+        buildDistribution(emissionTexturePath, sampling);
+        if ( tableResolution )
+            _luminanceIntegral = distribution->integral() * 4 * M_PI;
+        else
+            //* weights carry sin(theta), each texel spans (2pi / w) x (pi / h) in (phi, theta)
+            _luminanceIntegral = distribution->integral() * 2 * M_PI * M_PI;
+        bytes += distribution->memoryUsage();
+        profile.setBytes(bytes);
     } else {
         //todo report error
     }
-    _toLocal = matrix->getInverse();
 }
 
-double InfiniteSphereLight::directPdf(Vec3d dir) {
-    double sinTheta;
-    Point2d uv = DirectionToUv( dir, sinTheta);
+void InfiniteSphereLight::buildDistribution(const std::string &path, EDistributionSampling sampling) {
+    //* shared with other lights using the same map, and restored from scene snapshots
+    std::string source = tableResolution ? ImageManager::derivedKey(path, "octahedral" + std::to_string(tableResolution))
+                                         : path;
+    std::string key = DistributionManager::derivedKey(
+            source, sampling == EDistributionSampling::CDF ? "distribution-cdf" : "distribution-alias");
+    distribution = DistributionManager::getInstance()->find(key);
+    if ( distribution )
+        return;
+    int w = tableResolution ? tableResolution : image->getWidth(),
+        h = tableResolution ? tableResolution : image->getHeight();
+    //* luminance, one row per task. Table cells all span the same solid angle, equirectangular rows are
+    //* weighted by sin(theta) at their center.
+    std::vector < double > weights(size_t(w) * h);
+    parallelFor(0, h, [&](int y) {
+        double rowWeight = tableResolution ? 1.0 : fm::sin(( y + 0.5 ) * M_PI / h);
+        for ( int x = 0 ; x < w ; ++x ) {
+            RGB3 rgb(0.0);
+            if ( tableResolution ) {
+                //* 2x2 supersampling, table cells near the poles cover many source texels
+                for ( int s = 0 ; s < 4 ; ++s ) {
+                    Point2d st(( x + 0.25 + 0.5 * ( s & 1 )) / w, ( y + 0.25 + 0.5 * ( s >> 1 )) / h);
+                    double sinTheta;
+                    rgb += equirectLookup(*image, LocalDirectionToUv(SquareToEqualAreaSphere(st), sinTheta)) * 0.25;
+                }
+            } else {
+                rgb = image->getRGBColorAt(Point2i(x, y));
+            }
+            weights[size_t(y) * w + x] = rowWeight * ( 0.212671 * rgb[0] + 0.715160 * rgb[1] + 0.072169 * rgb[2] );
+        }
+    });
+    distribution = std::make_shared < Distribution2D >(weights.data(), w, h, sampling);
+    DistributionManager::getInstance()->insert(key, distribution);
+}
+
+double InfiniteSphereLight::power(double sceneRadius) const {
+    //* radiance from every direction, through a disk as large as the scene
+    return M_PI * sceneRadius * sceneRadius * _luminanceIntegral;
+}
+
+double InfiniteSphereLight::directPdf(const Point2d & uv, double sinTheta) {
+    if ( sinTheta <= 0 )
+        return 0;
     return INV_PI * INV_TWOPI * distribution->Pdf(uv)   / sinTheta;
 }
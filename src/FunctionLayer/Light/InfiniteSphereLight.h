@@ -31,13 +31,26 @@ public:
     LightSampleResult sampleDirect(const Intersection & its, const Point2d & sample, float time) override;
 
     LightSampleResult sampleDirect(const MediumSampleRecord & mRec, Point2d sample, double time) override;
+
+    double power(double sceneRadius) const override;
 protected:
-    double  directPdf(Vec3d dir);
+    double  directPdf(const Point2d &uv, double sinTheta);
+
+    /// @brief filtered radiance towards a local direction, and in pdf the solid angle density of sampleDirect choosing it.
+    Spectrum lookupRadiance(const Vec3d &localDir, double &pdf);
+
+    /// @brief luminance distribution over an equal-area octahedral table of tableResolution^2 cells resampled
+    /// from the map, or over the source texels if tableResolution is 0.
+    void buildDistribution(const std::string &path, EDistributionSampling sampling);
 
-    std::unique_ptr <Distribution2D> distribution;
+    /// @brief over the same parametrisation as the radiance lookups, shared through DistributionManager
+    std::shared_ptr <Distribution2D> distribution;
     std::shared_ptr <ImageTexture<Spectrum,RGB3>> emission;
-    TransformMatrix3D _toLocal;
+    std::shared_ptr <Image> image;              ///< equirectangular source texels
+    int tableResolution = 0;                    ///< side of the octahedral sampling table, 0 if there is none
+    AffineTransform3D _toWorld;
+    double _luminanceIntegral = 0;              ///< luminance integrated over the sphere of directions
+    Vec3d UvToLocalDirection(const Point2d &uv, double &sinTheta);
     Vec3d UvToDirection(const Point2d &uv, double &sinTheta);
-    Point2d DirectionToUv(const Vec3d &direction);
-    Point2d DirectionToUv(const Vec3d &direction, double &sinTheta);
+    Point2d LocalDirectionToUv(const Vec3d &localDir, double &sinTheta);
 };
\ No newline at end of file
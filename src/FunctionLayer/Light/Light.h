@@ -16,6 +16,8 @@
 #include "CoreLayer/Ray/Ray.h"
 #include "FunctionLayer/Intersection.h"
 #include "FunctionLayer/Medium/Medium.h"
+#include "LightBounds.h"
+#include <optional>
 
 struct LightSampleResult
 {
@@ -76,6 +78,14 @@ public:
 										   Point2d sample,
                                            double time) = 0;
 
+	// @brief Estimated emitted power (luminance), only used to weight light selection.
+	// @param sceneRadius Radius of the scene bounds, through which infinite lights emit.
+	virtual double power(double sceneRadius) const = 0;
+
+	// @brief Where and in which directions the light emits, for the light BVH.
+	// @return std::nullopt for lights without finite bounds, which are chosen apart from the BVH.
+	virtual std::optional<LightBounds> bounds() const { return std::nullopt; }
+
     Light(ELightType _lightType):lightType(_lightType){}
 
     ELightType lightType;
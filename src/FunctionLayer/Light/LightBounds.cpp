@@ -0,0 +1,117 @@
+/**
+ * @file LightBounds.cpp
+ * @author agent
+ * @brief LightBounds impl, following the light BVH of PBRT-v4.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ *
+ */
+
+#include "LightBounds.h"
+
+static inline double safeSqrt(double x) {
+    return std::sqrt(std::max(0.0, x));
+}
+
+static inline double safeAcos(double x) {
+    return std::acos(clamp(x, -1.0, 1.0));
+}
+
+//* cos(max(0, a - b)) and sin(max(0, a - b)) from the sines and cosines of a and b
+static inline double cosSubClamped(double sinA, double cosA, double sinB, double cosB) {
+    return cosA > cosB ? 1 : cosA * cosB + sinA * sinB;
+}
+
+static inline double sinSubClamped(double sinA, double cosA, double sinB, double cosB) {
+    return cosA > cosB ? 0 : sinA * cosB - cosA * sinB;
+}
+
+/// @brief Rotate v around the unit axis by theta (Rodrigues' formula).
+static Vec3d rotate(const Vec3d &v, const Vec3d &axis, double theta) {
+    double cosTheta = std::cos(theta), sinTheta = std::sin(theta);
+    return v * cosTheta + cross(axis, v) * sinTheta + axis * (dot(axis, v) * (1 - cosTheta));
+}
+
+double LightBounds::importance(const Point3d &p) const {
+    if (phi == 0)
+        return 0;
+    Point3d pc = bounds.pMin + (bounds.pMax - bounds.pMin) * 0.5;
+    Vec3d toP = p - pc;
+    double radius = (bounds.pMax - pc).length();
+    //* do not let points inside the bounds blow up the estimate
+    double d2 = std::max<double>(toP.length2(), radius);
+
+    Vec3d wi = toP.length2() > 0 ? normalize(toP) : w;
+    double cosThetaW = dot(w, wi);
+    if (twoSided)
+        cosThetaW = std::abs(cosThetaW);
+    double sinThetaW = safeSqrt(1 - cosThetaW * cosThetaW);
+
+    //* half angle of the cone from p that contains the bounding sphere
+    double cosThetaB = toP.length2() < radius * radius ? -1 : safeSqrt(1 - radius * radius / toP.length2());
+    double sinThetaB = safeSqrt(1 - cosThetaB * cosThetaB);
+
+    //* smallest angle between wi and a direction in the normal cone, then reduced by the bounds' extent
+    double sinThetaO = safeSqrt(1 - cosThetaO * cosThetaO);
+    double cosThetaX = cosSubClamped(sinThetaW, cosThetaW, sinThetaO, cosThetaO);
+    double sinThetaX = sinSubClamped(sinThetaW, cosThetaW, sinThetaO, cosThetaO);
+    double cosThetaP = cosSubClamped(sinThetaX, cosThetaX, sinThetaB, cosThetaB);
+    if (cosThetaP <= cosThetaE)
+        return 0;
+    return std::max(0.0, phi * cosThetaP / d2);
+}
+
+double LightBounds::cost(const BoundingBox3f &parent, int dim) const {
+    if (phi == 0)
+        return 0;
+    double thetaO = safeAcos(cosThetaO), thetaE = safeAcos(cosThetaE);
+    double thetaW = std::min(thetaO + thetaE, M_PI);
+    double sinThetaO = safeSqrt(1 - cosThetaO * cosThetaO);
+    //* solid angle measure of the normal cone widened by the emission angle
+    double mOmega = 2 * M_PI * (1 - cosThetaO) +
+                    M_PI / 2 * (2 * thetaW * sinThetaO - std::cos(thetaO - 2 * thetaW) - 2 * thetaO * sinThetaO + cosThetaO);
+    //* penalize splitting across the thin side of the parent
+    Vec3d diagonal = parent.pMax - parent.pMin;
+    double kr = std::max({diagonal.x, diagonal.y, diagonal.z}) / diagonal[dim];
+    return phi * mOmega * kr * BoundingBox3f(bounds).SurfaceArea();
+}
+
+LightBounds LightBoundsUnion(const LightBounds &a, const LightBounds &b) {
+    if (a.phi == 0)
+        return b;
+    if (b.phi == 0)
+        return a;
+
+    LightBounds result;
+    result.bounds = BoundingBoxUnion(a.bounds, b.bounds);
+    result.phi = a.phi + b.phi;
+    result.cosThetaE = std::min(a.cosThetaE, b.cosThetaE);
+    result.twoSided = a.twoSided || b.twoSided;
+
+    //* smallest cone containing both normal cones
+    double thetaA = safeAcos(a.cosThetaO), thetaB = safeAcos(b.cosThetaO);
+    double thetaD = safeAcos(dot(a.w, b.w));
+    if (std::min(thetaD + thetaB, M_PI) <= thetaA) {
+        result.w = a.w;
+        result.cosThetaO = a.cosThetaO;
+        return result;
+    }
+    if (std::min(thetaD + thetaA, M_PI) <= thetaB) {
+        result.w = b.w;
+        result.cosThetaO = b.cosThetaO;
+        return result;
+    }
+    double thetaO = (thetaA + thetaD + thetaB) / 2;
+    Vec3d axis = cross(a.w, b.w);
+    if (thetaO >= M_PI || axis.length2() == 0) {
+        result.w = a.w;
+        result.cosThetaO = -1;
+        return result;
+    }
+    result.w = normalize(rotate(a.w, normalize(axis), thetaO - thetaA));
+    result.cosThetaO = std::cos(thetaO);
+    return result;
+}
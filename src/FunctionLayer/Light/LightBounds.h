@@ -0,0 +1,42 @@
+/**
+ * @file LightBounds.h
+ * @author agent
+ * @brief Spatial and directional bounds of light emission, for importance sampling many lights.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ *
+ */
+
+#pragma once
+
+#include "CoreLayer/Geometry/Geometry.h"
+#include "CoreLayer/Geometry/BoundingBox.h"
+
+/// \ingroup Light
+/// \brief Bounds of where and in which directions a light (or a group of lights) emits, as in Conty & Kulla,
+/// "Importance Sampling of Many Lights with Adaptive Tree Splitting".
+struct LightBounds
+{
+	BoundingBox3f bounds;
+	/// @brief Estimated power, see Light::power.
+	double phi = 0;
+	/// @brief Axis of a cone containing every emitting normal.
+	Vec3d w = Vec3d(0, 0, 1);
+	/// @brief Cosine of the half angle of that cone, -1 if normals go everywhere.
+	double cosThetaO = -1;
+	/// @brief Cosine of how far from its normal a point emits, 0 (pi/2) for lambertian emitters.
+	double cosThetaE = 0;
+	bool twoSided = false;
+
+	/// @brief Conservative estimate of the light received at p. Zero only if nothing in the bounds can reach p.
+	double importance(const Point3d &p) const;
+
+	/// @brief Surface area orientation heuristic of the bounds, for choosing splits along dim of the parent bounds.
+	double cost(const BoundingBox3f &parent, int dim) const;
+};
+
+/// @brief Smallest bounds containing both, a zero-power side is ignored.
+LightBounds LightBoundsUnion(const LightBounds &a, const LightBounds &b);
@@ -0,0 +1,203 @@
+/**
+ * @file LightBvh.cpp
+ * @author agent
+ * @brief LightBvh impl.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ *
+ */
+
+#include "LightBvh.h"
+#include <future>
+#include <limits>
+
+static Point3d centroid(const BoundingBox3f &bounds) {
+    return 0.5 * (bounds.pMin + bounds.pMax);
+}
+
+LightBvh::LightBvh(const std::vector<std::shared_ptr<Light>> &lights) {
+    //* bounds() only reads the cached bounding box and area of the shape, a serial pass is cheap
+    std::vector<std::pair<int, LightBounds>> primitives;
+    for (size_t i = 0; i < lights.size(); i++) {
+        std::optional<LightBounds> lightBounds = lights[i]->bounds();
+        if (!lightBounds) {
+            leafIndices[lights[i].get()] = -1;
+            infiniteLights.push_back(lights[i]);
+        } else if (lightBounds->phi > 0) {
+            primitives.emplace_back(int(bvhLights.size()), *lightBounds);
+            bvhLights.push_back(lights[i]);
+        }
+    }
+    if (!primitives.empty())
+        nodes = RecursiveBuild(primitives, 0, int(primitives.size()), 0);
+
+    parents.assign(nodes.size(), -1);
+    for (int i = 0; i < int(nodes.size()); i++) {
+        if (nodes[i].isLeaf) {
+            leafIndices[bvhLights[nodes[i].childOrLightIndex].get()] = i;
+        } else {
+            parents[i + 1] = i;
+            parents[nodes[i].childOrLightIndex] = i;
+        }
+    }
+}
+
+LightBvh::LightBvhNodes LightBvh::RecursiveBuild(std::vector<std::pair<int, LightBounds>> &primitives,
+                                                 int start, int end, int depth) const {
+    if (end - start == 1)
+        return {LightBvhNode{primitives[start].second, primitives[start].first, true}};
+
+    BoundingBox3f bounds, centroidBounds;
+    for (int i = start; i < end; i++) {
+        bounds = BoundingBoxUnion(bounds, primitives[i].second.bounds);
+        centroidBounds = BoundingBoxPointUnion(centroidBounds, centroid(primitives[i].second.bounds));
+    }
+
+    //* surface area orientation heuristic over a few buckets along each axis
+    const int nBuckets = 12;
+    auto bucketOf = [&](const LightBounds &lightBounds, int dim) {
+        double extent = centroidBounds.pMax[dim] - centroidBounds.pMin[dim];
+        int bucket = int(nBuckets * (centroid(lightBounds.bounds)[dim] - centroidBounds.pMin[dim]) / extent);
+        return std::min(bucket, nBuckets - 1);
+    };
+    double minCost = std::numeric_limits<double>::infinity();
+    int minBucket = -1, minDim = -1;
+    for (int dim = 0; dim < 3; dim++) {
+        if (centroidBounds.pMax[dim] <= centroidBounds.pMin[dim])
+            continue;
+        LightBounds buckets[nBuckets];
+        for (int i = start; i < end; i++) {
+            int bucket = bucketOf(primitives[i].second, dim);
+            buckets[bucket] = LightBoundsUnion(buckets[bucket], primitives[i].second);
+        }
+        LightBounds below[nBuckets];
+        below[0] = buckets[0];
+        for (int i = 1; i < nBuckets; i++)
+            below[i] = LightBoundsUnion(below[i - 1], buckets[i]);
+        LightBounds above;
+        for (int split = nBuckets - 2; split >= 0; split--) {
+            above = LightBoundsUnion(above, buckets[split + 1]);
+            if (below[split].phi == 0 || above.phi == 0)
+                continue;
+            double cost = below[split].cost(bounds, dim) + above.cost(bounds, dim);
+            if (cost < minCost) {
+                minCost = cost;
+                minBucket = split;
+                minDim = dim;
+            }
+        }
+    }
+
+    int mid = (start + end) / 2;
+    if (minDim != -1) {
+        mid = int(std::partition(primitives.begin() + start, primitives.begin() + end,
+                                 [&](const std::pair<int, LightBounds> &primitive) {
+                                     return bucketOf(primitive.second, minDim) <= minBucket;
+                                 }) - primitives.begin());
+        if (mid == start || mid == end)
+            mid = (start + end) / 2;
+    }
+
+    //* the two halves are disjoint ranges of primitives, the top of the tree builds them concurrently
+    LightBvhNodes left, right;
+    if (depth < 6 && end - start > 1024) {
+        auto future = std::async(std::launch::async, [&] {
+            return RecursiveBuild(primitives, start, mid, depth + 1);
+        });
+        right = RecursiveBuild(primitives, mid, end, depth + 1);
+        left = future.get();
+    } else {
+        left = RecursiveBuild(primitives, start, mid, depth + 1);
+        right = RecursiveBuild(primitives, mid, end, depth + 1);
+    }
+
+    LightBvhNodes result;
+    result.reserve(1 + left.size() + right.size());
+    int rightOffset = int(1 + left.size());
+    result.push_back(LightBvhNode{LightBoundsUnion(left[0].bounds, right[0].bounds), rightOffset, false});
+    for (LightBvhNode node : left) {
+        if (!node.isLeaf) node.childOrLightIndex += 1;
+        result.push_back(node);
+    }
+    for (LightBvhNode node : right) {
+        if (!node.isLeaf) node.childOrLightIndex += rightOffset;
+        result.push_back(node);
+    }
+    return result;
+}
+
+double LightBvh::infiniteProbability() const {
+    if (infiniteLights.empty())
+        return 0;
+    double n = double(infiniteLights.size());
+    return n / (n + (nodes.empty() ? 0 : 1));
+}
+
+std::pair<std::shared_ptr<Light>, double> LightBvh::sample(const Point3d &p, double u) const {
+    double pInfinite = infiniteProbability();
+    if (u < pInfinite) {
+        int n = int(infiniteLights.size());
+        int index = std::min(int(u / pInfinite * n), n - 1);
+        return {infiniteLights[index], pInfinite / n};
+    }
+    if (nodes.empty())
+        return {nullptr, 0.0};
+
+    //* descend, reusing u for every decision
+    u = std::min((u - pInfinite) / (1 - pInfinite), 1.0 - 1e-12);
+    double pmf = 1 - pInfinite;
+    int nodeIndex = 0;
+    while (!nodes[nodeIndex].isLeaf) {
+        int children[2] = {nodeIndex + 1, nodes[nodeIndex].childOrLightIndex};
+        double importance[2] = {nodes[children[0]].bounds.importance(p), nodes[children[1]].bounds.importance(p)};
+        if (importance[0] == 0 && importance[1] == 0)
+            return {nullptr, 0.0};
+        double p0 = importance[0] / (importance[0] + importance[1]);
+        if (u < p0) {
+            u = std::min(u / p0, 1.0 - 1e-12);
+            pmf *= p0;
+            nodeIndex = children[0];
+        } else {
+            u = std::min((u - p0) / (1 - p0), 1.0 - 1e-12);
+            pmf *= 1 - p0;
+            nodeIndex = children[1];
+        }
+    }
+    //* a single light is the root, make sure it can reach p as an interior node would
+    if (nodeIndex == 0 && nodes[0].bounds.importance(p) == 0)
+        return {nullptr, 0.0};
+    return {bvhLights[nodes[nodeIndex].childOrLightIndex], pmf};
+}
+
+double LightBvh::pdf(const Point3d &p, const Light *light) const {
+    auto it = leafIndices.find(light);
+    if (it == leafIndices.end())
+        return 0;
+    double pInfinite = infiniteProbability();
+    if (it->second < 0)
+        return pInfinite / infiniteLights.size();
+
+    //* same decisions as sample, from the leaf up to the root
+    int nodeIndex = it->second;
+    if (nodeIndex == 0)
+        return nodes[0].bounds.importance(p) > 0 ? 1 - pInfinite : 0;
+    double pmf = 1 - pInfinite;
+    for (int parent = parents[nodeIndex]; parent >= 0; nodeIndex = parent, parent = parents[parent]) {
+        double importance0 = nodes[parent + 1].bounds.importance(p);
+        double importance1 = nodes[nodes[parent].childOrLightIndex].bounds.importance(p);
+        double importance = nodeIndex == parent + 1 ? importance0 : importance1;
+        if (importance == 0)
+            return 0;
+        pmf *= importance / (importance0 + importance1);
+    }
+    return pmf;
+}
+
+size_t LightBvh::memoryUsage() const {
+    return nodes.size() * (sizeof(LightBvhNode) + sizeof(int)) +
+           (bvhLights.size() + infiniteLights.size()) * sizeof(std::shared_ptr<Light>) +
+           leafIndices.size() * (sizeof(const Light *) + sizeof(int));
+}
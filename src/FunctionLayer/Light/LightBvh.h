@@ -0,0 +1,59 @@
+/**
+ * @file LightBvh.h
+ * @author agent
+ * @brief Bounding volume hierarchy over lights, for choosing a light by its contribution at a point.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ *
+ */
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "Light.h"
+
+/// @brief Bvh node in Dfs-Order, the first child of an interior node directly follows it.
+struct LightBvhNode {
+	LightBounds bounds;
+	int childOrLightIndex;	///< second child of interior nodes, index in bvhLights of leaves
+	bool isLeaf;
+};
+
+/// \ingroup Light
+/// \brief Light BVH of Conty & Kulla as in PBRT-v4's BVHLightSampler. Lights with bounds are chosen by
+/// descending the tree, picking a child in proportion to LightBounds::importance at the receiving point.
+/// Infinite lights have no bounds and are chosen uniformly, together sharing the probability of one tree.
+class LightBvh
+{
+public:
+	/// @brief build in parallel, lights with zero power are never chosen.
+	LightBvh(const std::vector<std::shared_ptr<Light>> &lights);
+
+	/// @return The light and the (discrete) probability it is picked with, {nullptr, 0} if no light reaches p.
+	std::pair<std::shared_ptr<Light>, double> sample(const Point3d &p, double u) const;
+
+	/// @brief The (discrete) probability that sample picks this light at p.
+	double pdf(const Point3d &p, const Light *light) const;
+
+	size_t memoryUsage() const;
+
+private:
+	using LightBvhNodes = std::vector<LightBvhNode>;
+
+	/// @brief build [start, end) of primitives, child indices are relative to the returned subtree.
+	LightBvhNodes RecursiveBuild(std::vector<std::pair<int, LightBounds>> &primitives, int start, int end, int depth) const;
+
+	double infiniteProbability() const;
+
+	std::vector<std::shared_ptr<Light>> bvhLights;
+	std::vector<std::shared_ptr<Light>> infiniteLights;
+	LightBvhNodes nodes;
+	std::vector<int> parents;						///< parent of each node, -1 for the root
+	std::unordered_map<const Light *, int> leafIndices;	///< leaf node of each bvh light, -1 for infinite lights
+};
@@ -102,3 +102,19 @@ LightSampleResult PointLight::sampleDirect(const MediumSampleRecord &mRec,
 void PointLight::apply()
 {
 }
+
+double PointLight::power(double sceneRadius) const
+{
+    return 4 * M_PI * intensity.luminance();
+}
+
+std::optional<LightBounds> PointLight::bounds() const
+{
+    //* emits in every direction from a single point
+    LightBounds lightBounds;
+    lightBounds.bounds = BoundingBox3f(Transform3D::getTranslate());
+    lightBounds.phi = power(0);
+    lightBounds.cosThetaO = -1;
+    lightBounds.cosThetaE = 0;
+    return lightBounds;
+}
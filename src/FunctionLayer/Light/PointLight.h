@@ -33,4 +33,8 @@ public:
 	virtual LightSampleResult sampleDirect(const MediumSampleRecord &mRec,
 										   Point2d sample,
 										   double time) override;
+
+    virtual double power(double sceneRadius) const override;
+
+    virtual std::optional<LightBounds> bounds() const override;
 };
\ No newline at end of file
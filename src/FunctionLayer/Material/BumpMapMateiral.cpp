@@ -22,10 +22,10 @@ std::shared_ptr<BSSRDF> BumpMaterial::getBSSRDF(const Intersection &intersect) c
 
 void BumpMaterial::setFrame(Intersection &its, const Ray &ray) const {
     if (!bump) {
-        its.shFrame = Frame(its.geometryNormal);
+        its.shFrame = Frame(its.shFrame.n);
     }
     if (bump) {
-        Frame frame = Frame(its.geometryNormal);
+        Frame frame = Frame(its.shFrame.n);
         Intersection evalIts(its);
         //todo: compute du and dv in intersect.
         auto du = 0.0005;
@@ -46,6 +46,7 @@ void BumpMaterial::setFrame(Intersection &its, const Ray &ray) const {
 
 BumpMaterial::BumpMaterial(const Json &json) {
     if (json.contains("bump"))
-        bump = TextureFactory::LoadTexture<RGB3>(json.at("bump"));
+        bump = TextureFactory::LoadTexture<RGB3>(json.at("bump"), Image::ImageLoadMode::IMAGE_LOAD_LINEAR);
     innerMaterial = MaterialFactory::LoadMaterialFromJson(json.at("material"));
+    flags = innerMaterial->getFlags();
 }
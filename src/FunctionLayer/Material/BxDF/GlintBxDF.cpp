@@ -1,9 +1,244 @@
 #include "GlintBxDF.h"
 #include "Fresnel.h"
-#include "CoreLayer/Geometry/Frame.h"
+#include "FunctionLayer/Intersection.h"
+#include <algorithm>
+#include <random>
 
-GlintBxDF::GlintBxDF(Vec3d _eta, Vec3d _k, Spectrum _albedo, double _uRoughness, double _vRoughness, Intersection _it,
-                     std::shared_ptr<MicrofacetDistribution> _distrib) : eta(_eta), k(_k), albedo(_albedo), it(_it), distrib(std::move(_distrib)) {
+ConicQuery::ConicQuery(const Vec3d &_wi, const Vec3d &_wo) : wi(_wi), wo(_wo) {
+    z = normalize(wi + wo);
+    Vec3d axis = cross(wi, wo);
+    if (axis.length() < 1e-8) {
+        // wi == wo, any frame around z
+        Frame frame(z);
+        x = frame.s, y = frame.t;
+    } else {
+        x = normalize(axis), y = normalize(wi - wo);
+    }
+    lambda1 = (dot(wi, wo) + cos(GAMMA)) / (1 - cos(GAMMA));
+    lambda2 = 1.f / (tan(GAMMA / 2) * tan(GAMMA / 2));
+}
+
+bool ConicQuery::IntersectConic(const DirTriangle &_tri) const {
+    Vec3d tri[3] = {DirTriangle::toDirection(_tri[0]), DirTriangle::toDirection(_tri[1]), DirTriangle::toDirection(_tri[2])};
+    double param_a, param_b, param_c, axis;
+    for (int i = 0; i < 3; i++) {
+        Vec3d c = tri[i] + tri[(i + 1) % 3];
+        Vec3d d = tri[i] - tri[(i + 1) % 3];
+        // The three coefficients of the equation
+        param_a = quadratic(d, d);
+        param_b = 2.f * quadratic(d, c);
+        param_c = quadratic(c, c);
+
+        // root in [-1, 1]
+        if ((param_a - param_b + param_c) * (param_a + param_b + param_c) < 0.f)
+            return true;
+        else {
+            axis = -param_b / (2 * param_a);
+            if (axis < -1.f || axis > 2.f || 4.f * param_a * param_c - param_b * param_b >= 0.f)
+                continue;
+            else
+                return true;
+        }
+    }
+    return false;
+}
+
+GlintParticleTable::GlintParticleTable(uint32_t seed) {
+    std::mt19937 rng(seed);
+    // multinomial split of n particles into four equally likely children, as sequential binomials
+    auto split = [&rng](uint32_t n, uint32_t *children) {
+        for (int c = 0; c < 3; c++) {
+            uint32_t m = n ? std::binomial_distribution<uint32_t>(n, 1.0 / (4 - c))(rng) : 0;
+            children[c] = m;
+            n -= m;
+        }
+        children[3] = n;
+    };
+
+    spatial.resize(spatialOffset(SPATIAL_DEPTH + 1));
+    spatial[0] = SPATIAL_SAMPLE_NUM;
+    for (int level = 0; level < SPATIAL_DEPTH; level++) {
+        int res = 1 << level;
+        const uint32_t *parents = &spatial[spatialOffset(level)];
+        uint32_t *children = &spatial[spatialOffset(level + 1)];
+        for (int y = 0; y < res; y++) {
+            for (int x = 0; x < res; x++) {
+                uint32_t counts[4];
+                split(parents[x + y * res], counts);
+                // lower-left, upper-left, lower-right, upper-right
+                children[2 * x + 2 * y * 2 * res] = counts[0];
+                children[2 * x + (2 * y + 1) * 2 * res] = counts[1];
+                children[2 * x + 1 + 2 * y * 2 * res] = counts[2];
+                children[2 * x + 1 + (2 * y + 1) * 2 * res] = counts[3];
+            }
+        }
+    }
+
+    direction.resize(directionOffset(DIRECTION_DEPTH + 1));
+    split(DIRECTION_SAMPLE_NUM, &direction[0]);
+    for (int level = 0; level < DIRECTION_DEPTH; level++) {
+        size_t count = size_t(4) << (2 * level);
+        const uint32_t *parents = &direction[directionOffset(level)];
+        uint32_t *children = &direction[directionOffset(level + 1)];
+        for (size_t i = 0; i < count; i++)
+            split(parents[i], &children[4 * i]);
+    }
+}
+
+double GlintParticleTable::countSpatialClipped(double u0, double v0, double u1, double v1) const {
+    struct Entry {
+        int level, x, y;
+    };
+    Entry stack[3 * SPATIAL_DEPTH + 1];
+    int top = 0;
+    stack[top++] = {0, 0, 0};
+    double count = 0;
+    while (top > 0) {
+        Entry node = stack[--top];
+        double size = 1.0 / (1 << node.level);
+        double nu0 = node.x * size, nv0 = node.y * size, nu1 = nu0 + size, nv1 = nv0 + size;
+        double ou0 = std::max(u0, nu0), ov0 = std::max(v0, nv0);
+        double ou1 = std::min(u1, nu1), ov1 = std::min(v1, nv1);
+        if (ou0 >= ou1 || ov0 >= ov1)
+            continue;
+        uint32_t n = spatial[spatialOffset(node.level) + node.x + node.y * (1 << node.level)];
+        if (n == 0)
+            continue;
+        if (ou0 == nu0 && ov0 == nv0 && ou1 == nu1 && ov1 == nv1) {
+            count += n;
+        } else if (node.level == SPATIAL_DEPTH) {
+            // particles are uniform inside a leaf
+            count += n * (ou1 - ou0) * (ov1 - ov0) / (size * size);
+        } else {
+            for (int j = 0; j < 2; j++)
+                for (int i = 0; i < 2; i++)
+                    stack[top++] = {node.level + 1, 2 * node.x + i, 2 * node.y + j};
+        }
+    }
+    return count;
+}
+
+double GlintParticleTable::countSpatial(const Point2d &pMin, const Point2d &pMax) const {
+    // the box is at most one unit wide, so it covers at most 2x2 copies of the tiled uv square
+    double shiftU = std::floor(pMin.x), shiftV = std::floor(pMin.y);
+    double count = 0;
+    for (int j = 0; j < 2; j++) {
+        for (int i = 0; i < 2; i++) {
+            double u0 = std::max(0.0, pMin.x - shiftU - i), u1 = std::min(1.0, pMax.x - shiftU - i);
+            double v0 = std::max(0.0, pMin.y - shiftV - j), v1 = std::min(1.0, pMax.y - shiftV - j);
+            if (u0 < u1 && v0 < v1)
+                count += countSpatialClipped(u0, v0, u1, v1);
+        }
+    }
+    return count / SPATIAL_SAMPLE_NUM;
+}
+
+const GlintParticleTable::DirectionGeometry &GlintParticleTable::directionGeometry() {
+    static const DirectionGeometry geometry = [] {
+        DirectionGeometry g;
+        g.bounds.resize(directionOffset(DIRECTION_DEPTH + 1) * 5);
+        g.leafSamples.reserve((size_t(4) << (2 * DIRECTION_DEPTH)) * DirectionGeometry::LEAF_SAMPLES * 3);
+        // barycentric lattice with spacing 1/3
+        double lattice[DirectionGeometry::LEAF_SAMPLES][3];
+        for (int i = 0, k = 0; i <= 3; i++)
+            for (int j = 0; i + j <= 3; j++, k++)
+                lattice[k][0] = i / 3.0, lattice[k][1] = j / 3.0, lattice[k][2] = (3 - i - j) / 3.0;
+
+        std::vector<DirTriangle> level, next;
+        for (int c = 0; c < 4; c++)
+            level.emplace_back(Point2d(M_PI / 2 * c, 0.f), Point2d(M_PI / 2 * (c + 1), 0.f), Point2d(0.f, M_PI / 2));
+        for (int l = 0; l <= DIRECTION_DEPTH; l++) {
+            float *bounds = &g.bounds[directionOffset(l) * 5];
+            for (size_t i = 0; i < level.size(); i++) {
+                const DirTriangle &tri = level[i];
+                Vec3d v[3] = {DirTriangle::toDirection(tri[0]), DirTriangle::toDirection(tri[1]), DirTriangle::toDirection(tri[2])};
+                Vec3d center = normalize(v[0] + v[1] + v[2]);
+                double radius = acos(std::clamp<double>(std::min({dot(center, v[0]), dot(center, v[1]), dot(center, v[2])}), -1.0, 1.0));
+                // slack, the edges are not great circles
+                radius = std::min(M_PI, 1.25 * radius);
+                bounds[5 * i + 0] = center.x, bounds[5 * i + 1] = center.y, bounds[5 * i + 2] = center.z;
+                bounds[5 * i + 3] = cos(radius), bounds[5 * i + 4] = sin(radius);
+                if (l == DIRECTION_DEPTH) {
+                    for (const auto &w : lattice) {
+                        Vec3d d = DirTriangle::toDirection(tri.interpolate(w));
+                        g.leafSamples.insert(g.leafSamples.end(), {float(d.x), float(d.y), float(d.z)});
+                    }
+                } else {
+                    for (int c = 0; c < 4; c++)
+                        next.push_back(tri.child(c));
+                }
+            }
+            level.swap(next);
+            next.clear();
+        }
+        return g;
+    }();
+    return geometry;
+}
+
+double GlintParticleTable::countDirection(const Vec3d &wi, const Vec3d &wo) const {
+    const DirectionGeometry &geometry = directionGeometry();
+    ConicQuery query(wi, wo);
+    // a node overlaps the cone if the angle from the cone axis to its axis is below the sum of both angles,
+    // and is inside it if the angle is below the smallest cone angle minus its own
+    double maxAngle = query.maxAngle(), minAngle = query.minAngle();
+    double cosMax = cos(maxAngle), sinMax = sin(maxAngle), cosMin = cos(minAngle), sinMin = sin(minAngle);
+
+    struct Entry {
+        int level;
+        uint32_t index;
+    };
+    Entry stack[3 * DIRECTION_DEPTH + 4];
+    int top = 0;
+    for (int c = 0; c < 4; c++)
+        stack[top++] = {0, uint32_t(c)};
+
+    double count = 0;
+    while (top > 0) {
+        Entry node = stack[--top];
+        size_t offset = directionOffset(node.level) + node.index;
+        uint32_t n = direction[offset];
+        if (n == 0)
+            continue;
+        const float *bound = &geometry.bounds[offset * 5];
+        double cosAxis = bound[0] * query.z.x + bound[1] * query.z.y + bound[2] * query.z.z;
+        double cosRadius = bound[3], sinRadius = bound[4];
+        // not overlap, cos(radius + maxAngle)
+        if (maxAngle < M_PI && cosAxis < cosRadius * cosMax - sinRadius * sinMax)
+            continue;
+        // contains, cos(minAngle - radius)
+        if (cosRadius > cosMin && cosAxis > cosMin * cosRadius + sinMin * sinRadius) {
+            count += n;
+            continue;
+        }
+        if (node.level == DIRECTION_DEPTH) {
+            // particles are uniform inside a leaf
+            const float *samples = &geometry.leafSamples[size_t(node.index) * DirectionGeometry::LEAF_SAMPLES * 3];
+            int inside = 0;
+            for (int i = 0; i < DirectionGeometry::LEAF_SAMPLES; i++)
+                inside += query.inConic(Vec3d(samples[3 * i], samples[3 * i + 1], samples[3 * i + 2]));
+            count += double(n) * inside / DirectionGeometry::LEAF_SAMPLES;
+            continue;
+        }
+        for (int c = 0; c < 4; c++)
+            stack[top++] = {node.level + 1, 4 * node.index + c};
+    }
+    return count / DIRECTION_SAMPLE_NUM;
+}
+
+GlintBxDF::Footprint GlintBxDF::Footprint::fromIntersection(const Intersection &its) {
+    Footprint footprint;
+    footprint.center = its.uv;
+    // mean of the two differentials, at most the whole uv square
+    footprint.halfExtent = Vec2d(std::min(0.5, std::abs(its.dudx + its.dudy) / 2.0),
+                                 std::min(0.5, std::abs(its.dvdx + its.dvdy) / 2.0));
+    return footprint;
+}
+
+GlintBxDF::GlintBxDF(Vec3d _eta, Vec3d _k, Spectrum _albedo, double _uRoughness, double _vRoughness,
+                     const Footprint &_footprint, const GlintParticleTable *_table,
+                     std::shared_ptr<MicrofacetDistribution> _distrib) : distrib(std::move(_distrib)), eta(_eta), k(_k), albedo(_albedo),
+                                                                          footprint(_footprint), table(_table) {
     alphaXY = Vec2d(distrib->roughnessToAlpha(_uRoughness), distrib->roughnessToAlpha(_vRoughness));
 }
 
@@ -37,107 +272,13 @@ double GlintBxDF::pdf(const Vec3d &out, const Vec3d &in) const {
 }
 
 // count particles number fall in tex area
-double GlintBxDF::count_spatial(BoundingBox2d &queryBox) const {
-    uint32_t countNum = 0, queryDepth = 0;
-    std::vector<SpatialNode> queue;
-    queue.push_back(std::make_pair(BoundingBox2d(Point2d(0.f, 0.f), Point2d(1.f, 1.f)), SPATIAL_SAMPLE_NUM));
-    SpatialNode node;
-    BoundingBox2d clipBox;
-    double p, w;
-    // bfs
-    while (!queue.empty()) {
-        node = queue.back();
-        queue.pop_back();
-        if (!queryBox.overlap(node.first) || node.second <= 0) {
-            continue;
-        } else if (queryBox.contains(node.first)) {
-            countNum += node.second;
-        } else {
-            p = countNum / SPATIAL_SAMPLE_NUM;
-            // approximation
-            if (sqrt(node.second * p * (1 - p)) < EPSILON * countNum) {
-                clipBox = node.first;
-                clipBox = BoundingBoxUnionIntersect(queryBox, clipBox);
-                countNum += (uint32_t)(node.second * clipBox.getSurfaceArea() / node.first.getSurfaceArea());
-            } else {
-                if (queryDepth >= MAX_QUERY_DEPTH) {
-                    break;
-                }
-                // split box
-                w = 1 - queryPs[queryDepth][0] - queryPs[queryDepth][1] - queryPs[queryDepth][2];
-                Point2d center = node.first.getCenter(), pMin = node.first.pMin, pMax = node.first.pMax;
-                queue.push_back(std::make_pair(
-                    BoundingBox2(pMin, center),
-                    (uint32_t)(node.second * queryPs[queryDepth][0])));
-                queue.push_back(std::make_pair(
-                    BoundingBox2(Point2d(pMin[0], center[1]), Point2d(center[0], pMax[1])),
-                    (uint32_t)(node.second * queryPs[queryDepth][1])));
-                queue.push_back(std::make_pair(
-                    BoundingBox2(Point2d(center[0], pMin[1]), Point2d(pMax[0], center[1])),
-                    (uint32_t)(node.second * queryPs[queryDepth][2])));
-                queue.push_back(std::make_pair(
-                    BoundingBox2(center, pMax),
-                    (uint32_t)(node.second * w)));
-                queryDepth++;
-            }
-        }
-    }
-    assert(countNum < SPATIAL_SAMPLE_NUM);
-    return (double)countNum / SPATIAL_SAMPLE_NUM;
+double GlintBxDF::count_spatial() const {
+    return table->countSpatial(footprint.center - footprint.halfExtent, footprint.center + footprint.halfExtent);
 }
 
 // count particles number fall in cone
 double GlintBxDF::count_direction(const Vec3d &wi, const Vec3d &wo) const {
-    uint32_t countNum = 0, queryDepth = 1;
-    std::vector<DirectionNode> queue;
-    ConicQuery query(wi, wo);
-    queue.push_back(std::make_pair(DirTriangle(Point2d(0.f, 0.f), Point2d(M_PI / 2, 0.f), Point2d(0.f, M_PI / 2)),
-                                   (uint32_t)(DIRECTION_SAMPLE_NUM * queryPs[0].x)));
-    queue.push_back(std::make_pair(DirTriangle(Point2d(M_PI / 2, 0.f), Point2d(M_PI, 0.f), Point2d(0.f, M_PI / 2)),
-                                   (uint32_t)(DIRECTION_SAMPLE_NUM * queryPs[0].y)));
-    queue.push_back(std::make_pair(DirTriangle(Point2d(M_PI, 0.f), Point2d(M_PI * 3 / 2, 0.f), Point2d(0.f, M_PI / 2)),
-                                   (uint32_t)(DIRECTION_SAMPLE_NUM * queryPs[0].z)));
-    queue.push_back(std::make_pair(DirTriangle(Point2d(M_PI * 3 / 2, 0.f), Point2d(M_PI * 2, 0.f), Point2d(0.f, M_PI / 2)),
-                                   (uint32_t)(DIRECTION_SAMPLE_NUM * (1 - queryPs[0].x - queryPs[0].y - queryPs[0].z))));
-    DirectionNode node;
-    double p;
-    // bfs
-    while (!queue.empty()) {
-        node = queue.back();
-        queue.pop_back();
-        // not overlap
-        if ((!(query.inConic(node.first[0]) || query.inConic(node.first[1]) ||
-               query.inConic(node.first[2]))) ||
-            node.second <= 0) {
-            continue;
-        }
-        // contains
-        else if (query.conicContain(node.first)) {
-            countNum += node.second;
-        } else {
-            p = countNum / SPATIAL_SAMPLE_NUM;
-            // approximation
-            // todo: calculate the ratio of area
-            if (sqrt(node.second * p * (1 - p)) < EPSILON * countNum) {
-                countNum += node.second;
-            } else {
-                if (queryDepth >= MAX_QUERY_DEPTH) {
-                    break;
-                }
-                // split triangle
-                queue.push_back(std::make_pair(DirTriangle(node.first.edgeMidPoint(0), node.first.edgeMidPoint(1), node.first.edgeMidPoint(2)),
-                                               (uint32_t)(node.second * queryPs[queryDepth].x)));
-                queue.push_back(std::make_pair(DirTriangle(node.first.edgeMidPoint(0), node.first.edgeMidPoint(2), node.first[0]),
-                                               (uint32_t)(node.second * queryPs[queryDepth].y)));
-                queue.push_back(std::make_pair(DirTriangle(node.first.edgeMidPoint(0), node.first.edgeMidPoint(1), node.first[1]),
-                                               (uint32_t)(node.second * queryPs[queryDepth].z)));
-                queue.push_back(std::make_pair(DirTriangle(node.first.edgeMidPoint(1), node.first.edgeMidPoint(2), node.first[2]),
-                                               (uint32_t)(node.second * (1 - queryPs[0].x - queryPs[0].y - queryPs[0].z))));
-                queryDepth++;
-            }
-        }
-    }
-    return (double)countNum / DIRECTION_SAMPLE_NUM;
+    return table->countDirection(wi, wo);
 }
 
 Spectrum GlintBxDF::f(const Vec3d &out, const Vec3d &in) const {
@@ -152,21 +293,18 @@ Spectrum GlintBxDF::f(const Vec3d &out, const Vec3d &in) const {
     if (dot(wh, out) < 0) {
         return 0.;
     }
+    double area = 4 * footprint.halfExtent.x * footprint.halfExtent.y;
+    if (area == 0)
+        return {0.};
+    double D = count_spatial();
+    if (D < 1e-8)
+        return {0.};
+    D *= count_direction(in, out);
+    if (D < 1e-8)
+        return {0.};
     double cosI = dot(out, wh.z > 0 ? wh : -wh);
     auto F = Fresnel::conductorReflectance(eta, k, cosI);
     auto G = distrib->G(out, in, alphaXY);
-
-    double du = (it.dudx + it.dudy) / 2, dv = (it.dvdx + it.dvdy) / 2;
-    BoundingBox2d texBox;
-    texBox = BoundingBoxPointUnion(texBox, Point2d(du, dv));
-    texBox = BoundingBoxPointUnion(texBox, Point2d(-du, dv));
-    texBox = BoundingBoxPointUnion(texBox, Point2d(du, -dv));
-    texBox = BoundingBoxPointUnion(texBox, Point2d(-du, -dv));
-
-    double D = count_direction(in, out);
-    D *= count_spatial(texBox);
-    if (D < 1e-8)
-        return {0.};
     return albedo * (dot(in, wh) * F * D * G) /
-           (texBox.getSurfaceArea() * M_PI * (1 - cos(GAMMA)) * cosThetaI * cosThetaO);
-}
\ No newline at end of file
+           (area * M_PI * (1 - cos(ConicQuery::GAMMA)) * cosThetaI * cosThetaO);
+}
@@ -1,43 +1,12 @@
 #pragma once
 #include "BxDF.h"
 #include "MicrofacetDistribution.h"
-#include "../../Intersection.h"
-#include "CoreLayer/Geometry/BoundingBox.h"
-#include <random>
-#include <VecMat.h>
-
-#define MAX_QUERY_DEPTH 1000
-#define SPATIAL_SAMPLE_NUM 10000000
-#define DIRECTION_SAMPLE_NUM 10000000
-#define EPSILON 0.1f
-#define GAMMA 0.087f
-#define Spherical2Cartesian(dir) Point3d(cosf(dir.x) * sinf(dir.y), sinf(dir.x) * sinf(dir.y), cosf(dir.y))
-
-// init posibilities in each depth query
-static std::vector<Point3d> queryPs;
-static int initQueryPs = []() {
-    std::random_device rd;
-    std::mt19937 eng(rd());
-    std::uniform_real_distribution<double> distr(0.f, 1.f);
-    double x, y, z, variance, max;
-
-    for (int i = 0; i < MAX_QUERY_DEPTH;) {
-        x = distr(eng);
-        y = (1 - x) * distr(eng);
-        z = (1 - x - y) * distr(eng);
-        variance = ((x - 0.25) * (x - 0.25) + (y - 0.25) * (y - 0.25) + (z - 0.25) * (z - 0.25) + (0.75 - x - y - z) * (0.75 - x - y - z)) / 4;
-        // when i small, the variance should also be small
-        max = 0.05 + (i * 10 / MAX_QUERY_DEPTH * 0.1);
-        if (variance < max * max) {
-            queryPs.push_back(Point3d(x, y, z));
-            i++;
-        }
-    }
+#include "CoreLayer/Geometry/Frame.h"
+#include <vector>
 
-    return 0;
-}();
+struct Intersection;
 
-// dirction trianle for dirction query
+// dirction trianle for dirction query, x is the azimuth and y the elevation, y == pi/2 is the pole
 struct DirTriangle {
     Point2d verts[3];
 
@@ -61,80 +30,139 @@ struct DirTriangle {
             return Point2d(0.5 * (verts[i].x + verts[j].x), 0.5 * (verts[i].y + verts[j].y));
     }
 
+    // child c of the 4-way midpoint subdivision, the order of GlintParticleTable
+    DirTriangle child(int c) const {
+        Point2d m0 = edgeMidPoint(0), m1 = edgeMidPoint(1), m2 = edgeMidPoint(2);
+        switch (c) {
+            case 0: return DirTriangle(m0, m1, m2);
+            case 1: return DirTriangle(m0, m2, verts[0]);
+            case 2: return DirTriangle(m0, m1, verts[1]);
+            default: return DirTriangle(m1, m2, verts[2]);
+        }
+    }
+
+    // point with barycentric weights w, the azimuth of a top point is taken from the other vertices
+    Point2d interpolate(const double w[3]) const {
+        double x = 0, wx = 0, y = 0;
+        for (int i = 0; i < 3; i++) {
+            y += w[i] * verts[i].y;
+            if (!isTopPoint(i))
+                x += w[i] * verts[i].x, wx += w[i];
+        }
+        return Point2d(wx > 0 ? x / wx : verts[0].x, y);
+    }
+
+    static Vec3d toDirection(const Point2d &p) {
+        return Vec3d(cos(p.x) * cos(p.y), sin(p.x) * cos(p.y), sin(p.y));
+    }
+
     Point2d operator[](int index) const {
         assert(index >= 0 && index < 3);
         return verts[index];
     }
 };
 
-// dirction query struct
+// dirction query struct: the cone of half vectors around normalize(wi + wo) that reflect wi into
+// a cone of angle GAMMA around wo. A direction m is inside if m^T C m < 0 with C = Q diag(lambda1, lambda2, -1) Q^T.
 struct ConicQuery {
+    static constexpr double GAMMA = 0.087;
+
     Vec3d wi, wo;
-    vecmat::mat33d C;
-
-    ConicQuery(const Vec3d &_wi, const Vec3d &_wo) : wi(_wi), wo(_wo) {
-        Vec3d x = normalize(cross(wi, wo)), y = normalize(wi - wo), z = normalize(wi + wo);
-        double lambda1 = (dot(wi, wo) + cosf(GAMMA)) / (1 - cosf(GAMMA)), lambda2 = 1.f / (tanf(GAMMA / 2) * tanf(GAMMA / 2));
-        vecmat::mat33d Q({x[0], y[0], z[0], x[1], y[1], z[1], x[2], y[2], z[2]}),
-            A({lambda1, 0.f, 0.f, 0.f, lambda2, 0.f, 0.f, 0.f, -1.f}),
-            QTranspose;
-        C = Q;
-        C = C * A;
-        QTranspose = Q.transpose();
-        C = C * QTranspose;
+    Vec3d x, y, z;
+    double lambda1, lambda2;
+
+    ConicQuery(const Vec3d &_wi, const Vec3d &_wo);
+
+    double quadratic(const Vec3d &a, const Vec3d &b) const {
+        return lambda1 * dot(x, a) * dot(x, b) + lambda2 * dot(y, a) * dot(y, b) - dot(z, a) * dot(z, b);
+    }
+
+    // largest angle between the cone axis and its boundary
+    double maxAngle() const {
+        if (lambda1 <= 0 || lambda2 <= 0)
+            return M_PI;
+        return atan(1 / sqrt(std::min(lambda1, lambda2)));
+    }
+
+    // smallest angle between the cone axis and its boundary
+    double minAngle() const {
+        if (lambda1 <= 0 || lambda2 <= 0)
+            return 0;
+        return atan(1 / sqrt(std::max(lambda1, lambda2)));
+    }
+
+    //judge if a direction falls in cone
+    bool inConic(const Vec3d &dir) const {
+        return quadratic(dir, dir) < 0.f && dot(dir, z) > 0;
     }
 
-    //judge if a point falls in cone
     bool inConic(const Point2d &p) const {
-        Point3d dir = Spherical2Cartesian(p);
-        vecmat::mat<3, 1, double> m({dir[0], dir[1], dir[2]});
-        return (m.transpose() * C * m).rows[0][0] < 0.f;
+        return inConic(DirTriangle::toDirection(p));
     }
 
     //judge if triangle intersects cone
     //not used yet
-    bool IntersectConic(const DirTriangle &_tri) const {
-        Point3d tri[3] = {Spherical2Cartesian(_tri[0]), Spherical2Cartesian(_tri[1]), Spherical2Cartesian(_tri[2])};
-        vecmat::mat<3, 1, double> c, d;
-        Vec3d _c, _d;
-        double param_a, param_b, param_c, axis;
-        for (int i = 0; i < 3; i++) {
-            _c = tri[i] + tri[(i + 1) % 3] - Point3d(0.f, 0.f, 0.f);
-            _d = tri[i] - tri[(i + 1) % 3];
-            c = vecmat::mat<3, 1, double>(_c[0], _c[1], _c[2]);
-            d = vecmat::mat<3, 1, double>(_d[0], _d[1], _d[2]);
-            // The three coefficients of the equation
-            param_a = (d.transpose() * C * d).rows[0][0];
-            param_b = (d.transpose() * C * c).rows[0][0];
-            param_b *= 2.f;
-            param_c = (c.transpose() * C * c).rows[0][0];
-
-            // root in [-1, 1]
-            if ((param_a - param_b + param_c) * (param_a + param_b + param_c) < 0.f)
-                return true;
-            else {
-                axis = -param_b / (2 * param_a);
-                if (axis < -1.f || axis > 2.f || 4.f * param_a * param_c - param_b * param_b >= 0.f)
-                    continue;
-                else
-                    return true;
-            }
-        }
-        return false;
-    }
+    bool IntersectConic(const DirTriangle &_tri) const;
 
     bool conicContain(const DirTriangle &_tri) const {
         return (inConic(_tri[0]) && inConic(_tri[1]) && inConic(_tri[2]));
     }
 };
 
-// bfs tree node: range and particles number in it
-typedef std::pair<BoundingBox2d, uint32_t> SpatialNode;
-typedef std::pair<DirTriangle, uint32_t> DirectionNode;
+/// @brief Particle counts of the discrete microfacet model, built once per material.
+/// A fixed number of particles is spread over the unit uv square and over the hemisphere of normals.
+/// Both domains are subdivided hierarchically, a quadtree over uv and a 4-way midpoint subdivision of
+/// four spherical triangles over directions, and the count of every node is split among its children
+/// with binomial draws. The counts are stored per node, so a query walks the tree without allocating.
+class GlintParticleTable {
+public:
+    static constexpr uint32_t SPATIAL_SAMPLE_NUM = 10000000;
+    static constexpr uint32_t DIRECTION_SAMPLE_NUM = 10000000;
+    static constexpr int SPATIAL_DEPTH = 8;      ///< 4^8 leaves of the uv square
+    static constexpr int DIRECTION_DEPTH = 6;    ///< 4 * 4^6 leaves of the hemisphere
+
+    explicit GlintParticleTable(uint32_t seed = 0);
+
+    /// @return fraction of the particles inside the uv box, which may reach outside [0, 1] and wraps around.
+    double countSpatial(const Point2d &pMin, const Point2d &pMax) const;
+
+    /// @return fraction of the particles whose normal reflects wi into a small cone around wo.
+    double countDirection(const Vec3d &wi, const Vec3d &wo) const;
+
+    size_t memoryUsage() const { return (spatial.size() + direction.size()) * sizeof(uint32_t); }
+
+private:
+    static size_t spatialOffset(int level) { return ((size_t(1) << (2 * level)) - 1) / 3; }
+
+    static size_t directionOffset(int level) { return ((size_t(4) << (2 * level)) - 4) / 3; }
+
+    double countSpatialClipped(double u0, double v0, double u1, double v1) const;
+
+    /// @brief node shapes of the direction tree, the same for every table.
+    struct DirectionGeometry {
+        static constexpr int LEAF_SAMPLES = 10;
+        std::vector<float> bounds;          ///< per node: bounding cone axis, cos and sin of its angle
+        std::vector<float> leafSamples;     ///< per leaf: LEAF_SAMPLES directions on a barycentric lattice
+    };
+
+    static const DirectionGeometry &directionGeometry();
+
+    std::vector<uint32_t> spatial;      ///< level by level, row major 2^l x 2^l nodes
+    std::vector<uint32_t> direction;    ///< level by level, children of node i are 4i..4i+3 of the next level
+};
 
 class GlintBxDF : public BxDF {
 public:
-    GlintBxDF(Vec3d _eta, Vec3d _k, Spectrum _albedo, double _uRoughness, double _vRoughness, Intersection _it,
+    /// @brief uv region seen by the pixel, see fromIntersection.
+    struct Footprint {
+        Point2d center;
+        Vec2d halfExtent;
+
+        static Footprint fromIntersection(const Intersection &its);
+    };
+
+    GlintBxDF(Vec3d _eta, Vec3d _k, Spectrum _albedo, double _uRoughness, double _vRoughness,
+              const Footprint &_footprint, const GlintParticleTable *_table,
               std::shared_ptr<MicrofacetDistribution> _distrib);
 
     Spectrum f(const Vec3d &out, const Vec3d &in) const override;
@@ -143,7 +171,7 @@ public:
 
     BxDFSampleResult sample(const Vec3d &out, const Point2d &sample) const override;
 
-    double count_spatial(BoundingBox2d &queryBox) const;
+    double count_spatial() const;
 
     double count_direction(const Vec3d &wi, const Vec3d &wo) const;
 
@@ -155,5 +183,6 @@ protected:
     Vec3d eta;
     Vec3d k;
     Spectrum albedo;
-    Intersection it;
+    Footprint footprint;
+    const GlintParticleTable *table;
 };
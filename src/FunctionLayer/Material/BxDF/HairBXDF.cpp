@@ -76,12 +76,22 @@ static double logI0(double x)
         return std::log(I0(x));
 }
 
+// logarithm of Mp, exact for small v where Mp itself under- or overflows
+static double LogM(double v, double sinThetaO, double sinThetaI, double cosThetaO, double cosThetaI) {
+    double b = sinThetaO * sinThetaI / v;
+    double a = cosThetaI * cosThetaO / v;
+    if (v < 0.1)
+        return -b + logI0(a) - 1.0f / v + 0.6931f + std::log(1.0f / (2.0f * v));
+    double csch = 2 / (exp(1 / v) - exp(-1 / v));
+    return std::log(csch) - b + std::log(I0(a));
+}
+
 double Hair::M(double v, double sinThetaO, double sinThetaI, double cosThetaO, double cosThetaI) const {
 
     double b = sinThetaO * sinThetaI / v;
     double a = cosThetaI * cosThetaO / v;
     if (v < 0.1)
-        return std::exp(-b + logI0(a) - 1.0f / v + 0.6931f + std::log(1.0f / (2.0f * v)));
+        return std::exp(LogM(v, sinThetaO, sinThetaI, cosThetaO, cosThetaI));
     double csch = 2 / (exp(1 / v) - exp(-1 / v));
     return csch * exp(-b) * I0(a);
 }
@@ -97,7 +107,7 @@ double Hair::NR(double beta, double cosO, double phi, double h) const {
            Fresnel::dielectricReflectance(1.0 / _eta, cosO * cos(gammaI));
 }
 
-Vec3d Hair::NP(double beta, double cosThetaD, double phi, int p, double h) const {
+void Hair::transmission(double cosThetaD, double h, int p, Vec3d & aph, double & shift) const {
     double iorPrime = std::sqrt(_eta * _eta - ( 1.0 - cosThetaD * cosThetaD )) / cosThetaD;
     double cosThetaT = std::sqrt(1.0 - ( 1.0 - cosThetaD * cosThetaD ) * (1.0 / _eta / _eta));
     Vec3d sigmaAPrime = _sigmaA / cosThetaT;
@@ -112,8 +122,15 @@ Vec3d Hair::NP(double beta, double cosThetaD, double phi, int p, double h) const
     Vec3d Aph = ( 1.0 - f ) * ( 1.0 - f ) * T;
     for ( int i = 1 ; i < p ; ++ i )
         Aph = Aph * f * T;
+    aph = Aph;
+    shift = Phi(gammaI, gammaT, p);
+}
 
-    double deltaPhi = phi - Phi(gammaI, gammaT, p);
+Vec3d Hair::NP(double beta, double cosThetaD, double phi, int p, double h) const {
+    Vec3d Aph;
+    double shift;
+    transmission(cosThetaD, h, p, Aph, shift);
+    double deltaPhi = phi - shift;
     deltaPhi = std::fmod(deltaPhi, 2 * M_PI);
     if ( deltaPhi < 0.0 )
         deltaPhi += 2 * M_PI;
@@ -174,7 +191,7 @@ double Hair::pdf(const Vec3d & out, const Vec3d & in) const {
     double cosThetaI = sqrt(1 - sinThetaI * sinThetaI);
     double thetaI = std::asin(clamp(sinThetaI, - 1.0, 1.0));
     //First choose a lobe to sample
-    std::array < double, pMax + 1 > apPdf = ComputeApPdf(costhetaO, h);
+    std::array < double, pMax + 1 > apPdf = table ? table->apPdf(costhetaO, h) : ComputeApPdf(costhetaO, h);
 
     double thetaOR = thetaO - 2.0 * _scaleAngle;
     double thetaOTT = thetaO + _scaleAngle;
@@ -185,8 +202,20 @@ double Hair::pdf(const Vec3d & out, const Vec3d & in) const {
     double phi = phiI - phiO;
 
     double cosThetaD = cos(0.5 * ( std::asin(sinThetaI) - thetaO ));
-    double iorPrime = std::sqrt(_eta * _eta - ( 1.0 - cosThetaD * cosThetaD )) / cosThetaD;
     double gammaI = std::asin(clamp(h, - 1.0, 1.0));
+
+    if ( table ) {
+        Vec3d aph[2];
+        double shift[2];
+        table->transmission(cosThetaD, h, aph, shift);
+        double pdf = 0;
+        pdf += longitudinal(0, thetaOR, thetaI, sinThetaI, cosThetaI) * apPdf[0] * table->logistic(_roughness, phi + 2.0 * gammaI);
+        pdf += longitudinal(1, thetaOTT, thetaI, sinThetaI, cosThetaI) * apPdf[1] * table->logistic(_roughness, phi - shift[0]);
+        pdf += longitudinal(2, thetaOTRT, thetaI, sinThetaI, cosThetaI) * apPdf[2] * table->logistic(_roughness, phi - shift[1]);
+        return pdf;
+    }
+
+    double iorPrime = std::sqrt(_eta * _eta - ( 1.0 - cosThetaD * cosThetaD )) / cosThetaD;
     double gammaT = std::asin(clamp(h / iorPrime, - 1.0, 1.0));
 
     double pdf = 0;
@@ -204,7 +233,7 @@ BxDFSampleResult Hair::sample(const Vec3d & out, const Point2d & sample) const {
     double costhetaO = trigInverse(sinThetaO);
     double thetaO = std::asin(clamp(sinThetaO, - 1.0, 1.0));
     //First choose a lobe to sample
-    std::array < double, pMax + 1 > apPdf = ComputeApPdf(costhetaO, h);
+    std::array < double, pMax + 1 > apPdf = table ? table->apPdf(costhetaO, h) : ComputeApPdf(costhetaO, h);
     int p;
     for ( p = 0 ; p < pMax ; ++ p ) {
         if ( u0[0] <= apPdf[p] )
@@ -261,17 +290,28 @@ Spectrum Hair::f(const Vec3d & out, const Vec3d & in) const {
     double thetaOTT = thetaO + _scaleAngle;
     double thetaOTRT = thetaO + 4 * _scaleAngle;
 
-    double MR = M(_vR, sin(thetaOR), sinThetaI, cos(thetaOR), cosThetaI);
-    double MTT = M(_vTT, sin(thetaOTT), sinThetaI, cos(thetaOTT), cosThetaI);
-    double MTRT = M(_vTRT, sin(thetaOTRT), sinThetaI, cos(thetaOTRT), cosThetaI);
+    double MR = longitudinal(0, thetaOR, thetaI, sinThetaI, cosThetaI);
+    double MTT = longitudinal(1, thetaOTT, thetaI, sinThetaI, cosThetaI);
+    double MTRT = longitudinal(2, thetaOTRT, thetaI, sinThetaI, cosThetaI);
 
     double phi = std::atan2(in.x, in.z);
     if ( phi < 0.0 )
         phi += 2 * M_PI;
 
-    Vec3d Nr = Vec3d(NR(_betaR, trigInverse(out.y), phi, h));
-    Vec3d Ntt = NP(_betaR, cosThetaD, phi, 1, h);
-    Vec3d Ntrt = NP(_betaR, cosThetaD, phi, 2, h);
+    Vec3d Nr, Ntt, Ntrt;
+    if ( table ) {
+        Vec3d aph[2];
+        double shift[2];
+        table->transmission(cosThetaD, h, aph, shift);
+        double gammaI = std::asin(clamp(h, - 1.0, 1.0));
+        Nr = Vec3d(table->logistic(_roughness, phi + 2.0 * gammaI) * table->fresnel(trigInverse(out.y) * trigInverse(h)));
+        Ntt = aph[0] * table->logistic(_roughness, phi - shift[0]);
+        Ntrt = aph[1] * table->logistic(_roughness, phi - shift[1]);
+    } else {
+        Nr = Vec3d(NR(_betaR, trigInverse(out.y), phi, h));
+        Ntt = NP(_betaR, cosThetaD, phi, 1, h);
+        Ntrt = NP(_betaR, cosThetaD, phi, 2, h);
+    }
     Vec3d fsum = MR * Nr + MTT * Ntt + MTRT * Ntrt;
     if (AbsCosTheta(in) > 0) fsum /= AbsCosTheta(in);
     // return Spectrum(RGB3(Nr.x,Nr.y,Nr.z))/AbsCosTheta(in);
@@ -281,7 +321,7 @@ Spectrum Hair::f(const Vec3d & out, const Vec3d & in) const {
 const Vec3d eumelaninSigmaA = Vec3d(0.419, 0.697, 1.37);
 const Vec3d pheomelaninSigmaA = Vec3d (0.187, 0.4, 1.05);
 
-Hair::Hair(const HairAttribute * attr, double roughness,double  h) : _roughness(roughness),h(h){
+Hair::Hair(const HairAttribute * attr, double roughness,double  h,const HairTable * table) : _roughness(roughness),h(h),table(table){
     type= BXDFType(BXDF_GLOSSY | BXDF_TRANSMISSION | BXDF_REFLECTION);
 
     _scaleAngle =   attr->scaleAngle;
@@ -297,3 +337,157 @@ Hair::Hair(const HairAttribute * attr, double roughness,double  h) : _roughness(
     _vTT = _betaTT * _betaTT;
     _vTRT = _betaTRT * _betaTRT;
 }
+
+double Hair::longitudinal(int p, double thetaO, double thetaI, double sinThetaI, double cosThetaI) const {
+    if ( table )
+        return table->M(p, _roughness, thetaO, thetaI);
+    double v = p == 0 ? _vR : p == 1 ? _vTT : _vTRT;
+    return M(v, sin(thetaO), sinThetaI, cos(thetaO), cosThetaI);
+}
+
+void HairTable::Axis::locate(double x, int & i, double & t) const {
+    if ( size < 2 ) {
+        i = 0, t = 0;
+        return;
+    }
+    double f = clamp(( x - min ) / ( max - min ), 0.0, 1.0) * ( size - 1 );
+    i = std::min(int(f), size - 2);
+    t = f - i;
+}
+
+HairTable::HairTable(const HairAttribute & attr, double roughnessMin, double roughnessMax, const Settings & settings) {
+    int thetaRes = std::max(settings.thetaResolution, 2);
+    int hRes = std::max(settings.hResolution, 2);
+    // odd, so that the cusp of the logistic at 0 is a sample
+    int phiRes = std::max(settings.phiResolution, 2) | 1;
+    int roughnessRes = roughnessMin == roughnessMax ? 1 : std::max(settings.roughnessResolution, 2);
+
+    double thetaOMax = M_PI / 2 + 4 * std::abs(attr.scaleAngle);
+    roughnessAxis = {roughnessMin, roughnessMax, roughnessRes};
+    thetaOAxis = {- thetaOMax, thetaOMax, thetaRes};
+    thetaIAxis = {- M_PI / 2, M_PI / 2, thetaRes};
+    phiAxis = {- M_PI, M_PI, phiRes};
+    cosAxis = {0, 1, thetaRes};
+    hAxis = {- 1, 1, hRes};
+
+    // roughness dependent terms, one slice per roughness sample
+    logM.resize(size_t(pMax) * roughnessRes * thetaRes * thetaRes);
+    logLogistic.resize(size_t(roughnessRes) * phiRes);
+    for ( int r = 0 ; r < roughnessRes ; ++ r ) {
+        Hair hair(&attr, roughnessAxis.at(r), 0);
+        double v[pMax] = {hair._vR, hair._vTT, hair._vTRT};
+        for ( int p = 0 ; p < pMax ; ++ p )
+            for ( int i = 0 ; i < thetaRes ; ++ i ) {
+                double thetaO = thetaOAxis.at(i);
+                float * row = &logM[( ( size_t(p) * roughnessRes + r ) * thetaRes + i ) * thetaRes];
+                for ( int j = 0 ; j < thetaRes ; ++ j ) {
+                    double thetaI = thetaIAxis.at(j);
+                    row[j] = LogM(v[p], sin(thetaO), sin(thetaI), cos(thetaO), cos(thetaI));
+                }
+            }
+        for ( int i = 0 ; i < phiRes ; ++ i )
+            logLogistic[size_t(r) * phiRes + i] =
+                std::log(std::max(TrimmedLogistic(phiAxis.at(i), hair._betaR, - M_PI, M_PI), 1e-300));
+    }
+
+    // absorption dependent terms
+    Hair hair(&attr, roughnessMin, 0);
+    fresnelR.resize(thetaRes);
+    for ( int i = 0 ; i < thetaRes ; ++ i )
+        fresnelR[i] = Fresnel::dielectricReflectance(1.0 / hair._eta, cosAxis.at(i));
+    transmit.resize(size_t(thetaRes) * hRes * 8);
+    lobePdf.resize(size_t(thetaRes) * hRes * pMax);
+    for ( int i = 0 ; i < thetaRes ; ++ i ) {
+        // both terms divide by the cosine
+        double cosTheta = std::max(cosAxis.at(i), 1e-4);
+        for ( int j = 0 ; j < hRes ; ++ j ) {
+            double h = hAxis.at(j);
+            float * cell = &transmit[( size_t(i) * hRes + j ) * 8];
+            for ( int p = 1 ; p <= 2 ; ++ p ) {
+                Vec3d aph;
+                double shift;
+                hair.transmission(cosTheta, h, p, aph, shift);
+                float * lobe = cell + 4 * ( p - 1 );
+                lobe[0] = aph.x, lobe[1] = aph.y, lobe[2] = aph.z, lobe[3] = shift;
+            }
+            std::array < double, pMax + 1 > apPdf = hair.ComputeApPdf(cosTheta, h);
+            for ( int p = 0 ; p < pMax ; ++ p )
+                lobePdf[( size_t(i) * hRes + j ) * pMax + p] = apPdf[p];
+        }
+    }
+}
+
+double HairTable::M(int p, double roughness, double thetaO, double thetaI) const {
+    int r, i, j;
+    double tr, ti, tj;
+    roughnessAxis.locate(roughness, r, tr);
+    thetaOAxis.locate(thetaO, i, ti);
+    thetaIAxis.locate(thetaI, j, tj);
+    int n = thetaIAxis.size;
+    auto slice = [&](int k) {
+        const float * m = &logM[( ( size_t(p) * roughnessAxis.size + k ) * thetaOAxis.size + i ) * n + j];
+        return ( 1 - ti ) * ( ( 1 - tj ) * m[0] + tj * m[1] ) + ti * ( ( 1 - tj ) * m[n] + tj * m[n + 1] );
+    };
+    double value = slice(r);
+    if ( tr > 0 )
+        value = ( 1 - tr ) * value + tr * slice(r + 1);
+    return std::exp(value);
+}
+
+double HairTable::logistic(double roughness, double phi) const {
+    phi = std::remainder(phi, 2 * M_PI);
+    int r, i;
+    double tr, ti;
+    roughnessAxis.locate(roughness, r, tr);
+    phiAxis.locate(phi, i, ti);
+    auto slice = [&](int k) {
+        const float * l = &logLogistic[size_t(k) * phiAxis.size + i];
+        return ( 1 - ti ) * l[0] + ti * l[1];
+    };
+    double value = slice(r);
+    if ( tr > 0 )
+        value = ( 1 - tr ) * value + tr * slice(r + 1);
+    return std::exp(value);
+}
+
+double HairTable::fresnel(double cosTheta) const {
+    int i;
+    double t;
+    cosAxis.locate(cosTheta, i, t);
+    return ( 1 - t ) * fresnelR[i] + t * fresnelR[i + 1];
+}
+
+void HairTable::transmission(double cosThetaD, double h, Vec3d aph[2], double shift[2]) const {
+    int i, j;
+    double ti, tj;
+    cosAxis.locate(cosThetaD, i, ti);
+    hAxis.locate(h, j, tj);
+    int n = hAxis.size;
+    const float * c00 = &transmit[( size_t(i) * n + j ) * 8], * c01 = c00 + 8;
+    const float * c10 = c00 + size_t(n) * 8, * c11 = c10 + 8;
+    double value[8];
+    for ( int k = 0 ; k < 8 ; ++ k )
+        value[k] = ( 1 - ti ) * ( ( 1 - tj ) * c00[k] + tj * c01[k] ) + ti * ( ( 1 - tj ) * c10[k] + tj * c11[k] );
+    aph[0] = Vec3d(value[0], value[1], value[2]);
+    aph[1] = Vec3d(value[4], value[5], value[6]);
+    shift[0] = value[3];
+    shift[1] = value[7];
+}
+
+std::array < double, pMax + 1 > HairTable::apPdf(double cosThetaO, double h) const {
+    int i, j;
+    double ti, tj;
+    cosAxis.locate(cosThetaO, i, ti);
+    hAxis.locate(h, j, tj);
+    int n = hAxis.size;
+    const float * c00 = &lobePdf[( size_t(i) * n + j ) * pMax], * c01 = c00 + pMax;
+    const float * c10 = c00 + size_t(n) * pMax, * c11 = c10 + pMax;
+    std::array < double, pMax + 1 > result{};
+    for ( int p = 0 ; p < pMax ; ++ p )
+        result[p] = ( 1 - ti ) * ( ( 1 - tj ) * c00[p] + tj * c01[p] ) + ti * ( ( 1 - tj ) * c10[p] + tj * c11[p] );
+    return result;
+}
+
+size_t HairTable::memoryUsage() const {
+    return ( logM.size() + logLogistic.size() + fresnelR.size() + transmit.size() + lobePdf.size() ) * sizeof(float);
+}
@@ -1,9 +1,13 @@
+#pragma once
 #include "BxDF.h"
 #include "CoreLayer/Adapter/JsonUtil.h"
+#include <vector>
 
 
 const int pMax = 3;
 
+class HairTable;
+
 /// Hair Bsdf
 
 
@@ -16,9 +20,11 @@ struct HairAttribute {
 };
 
 class Hair : public  BxDF{
+    friend class HairTable;
 public:
     double pdf(const Vec3d & out, const Vec3d & in) const override;
-    Hair(const HairAttribute * attr,double roughness,double h);
+    /// @param table precomputed terms of the material, or null to evaluate everything analytically
+    Hair(const HairAttribute * attr,double roughness,double h,const HairTable * table = nullptr);
     BxDFSampleResult sample(const Vec3d & out, const Point2d & sample) const override;
     Spectrum f(const Vec3d & out, const Vec3d & in) const override;
 
@@ -30,8 +36,14 @@ protected:
     Vec3d  NP(double beta,double cosO,double phi,int p,double h) const;
     double D(double beta,double phi) const;
 
+    /// attenuation Ap and azimuthal shift Phi of the transmitted lobe p >= 1
+    void transmission(double cosThetaD,double h,int p,Vec3d & aph,double & shift) const;
+
     std::array<double, pMax + 1> ComputeApPdf(double cosThetaO,double h) const;
 
+    /// Mp of lobe p, thetaO already tilted for the lobe; from the table if there is one
+    double longitudinal(int p,double thetaO,double thetaI,double sinThetaI,double cosThetaI) const;
+
 
 private:
     double _scaleAngle;
@@ -41,6 +53,56 @@ private:
     Vec3d _sigmaA;
     const double _eta = 1.55;
     double h;
+    const HairTable * table;
+};
+
+/// Precomputed terms of the hair BSDF of one material, built at load.
+/// Mp is stored per lobe over (roughness, thetaO, thetaI) and the trimmed logistic over (roughness, phi),
+/// both as logarithms since they are sharply peaked for smooth hair. The cuticle reflectance, the
+/// attenuation and azimuthal shift of TT and TRT over (cosThetaD, h) and the lobe pdfs over (cosThetaO, h)
+/// only depend on the absorption and are stored directly. Lookups interpolate linearly.
+class HairTable {
+public:
+    struct Settings {
+        int thetaResolution = 128;      ///< samples of each longitudinal angle and of cosThetaD
+        int hResolution = 64;           ///< samples of the azimuthal offset h
+        int phiResolution = 512;        ///< samples of the azimuthal logistic
+        int roughnessResolution = 8;    ///< roughness slices, one when the roughness is constant
+    };
+
+    /// @param roughnessMin, roughnessMax range of roughness the material can produce
+    HairTable(const HairAttribute & attr,double roughnessMin,double roughnessMax,const Settings & settings);
+
+    double M(int p,double roughness,double thetaO,double thetaI) const;
+
+    /// trimmed logistic with the scale of the R lobe, phi is wrapped to [-pi, pi]
+    double logistic(double roughness,double phi) const;
+
+    /// reflectance at the cuticle for the cosine cosThetaO * cos(gammaI)
+    double fresnel(double cosTheta) const;
+
+    /// Ap and Phi of TT and TRT
+    void transmission(double cosThetaD,double h,Vec3d aph[2],double shift[2]) const;
+
+    std::array<double, pMax + 1> apPdf(double cosThetaO,double h) const;
+
+    size_t memoryUsage() const;
+
+private:
+    struct Axis {
+        double min, max;
+        int size;
+        /// cell and weight of the upper sample
+        void locate(double x,int & i,double & t) const;
+        double at(int i) const { return size > 1 ? min + (max - min) * i / (size - 1) : min; }
+    };
+
+    Axis roughnessAxis, thetaOAxis, thetaIAxis, phiAxis, cosAxis, hAxis;
+    std::vector<float> logM;            ///< [p][roughness][thetaO][thetaI]
+    std::vector<float> logLogistic;     ///< [roughness][phi]
+    std::vector<float> fresnelR;        ///< [cosTheta]
+    std::vector<float> transmit;        ///< [cosThetaD][h][TT, TRT][r, g, b, shift]
+    std::vector<float> lobePdf;         ///< [cosThetaO][h][p < pMax]
 };
 
 // https://fgiesen.wordpress.com/2009/12/13/decoding-morton-codes/
@@ -63,5 +125,5 @@ static uint32_t Compact1By1(uint32_t x) {
 static Point2d DemuxDouble(double f) {
     uint64_t v = f * (1ull << 32);
     uint32_t bits[2] = {Compact1By1(v), Compact1By1(v >> 1)};
-    return {bits[0] / double(1 << 16), bits[1] / double(1 << 16)};
+    return {Float(bits[0] / double(1 << 16)), Float(bits[1] / double(1 << 16))};
 }
\ No newline at end of file
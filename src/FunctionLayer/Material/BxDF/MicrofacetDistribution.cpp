@@ -119,8 +119,8 @@ double GGXDistribution::Lambda(const Vec3d &w, const Vec2d &alphaXY) const {
 }
 
 Vec3d GGXDistribution::Sample_wh(const Vec3d &wo, Point2d u, const Vec2d &alphaXY) const {
-    u.x = std::max(0.01, std::min(0.99, u.x));
-    u.y = std::max(0.01, std::min(0.99, u.y));
+    u.x = std::max<double>(0.01, std::min<double>(0.99, u.x));
+    u.y = std::max<double>(0.01, std::min<double>(0.99, u.y));
     double alphaX = alphaXY.x, alphaY = alphaXY.y;
     if (CosTheta(wo) < 0) {
         return Sample_wh(-wo, u, alphaXY);
@@ -138,14 +138,14 @@ Vec3d GGXDistribution::Sample_wh(const Vec3d &wo, Point2d u, const Vec2d &alphaX
         double s = (1 + hemisphereDirOut.z) / 2;
         t2 = (1 - s) * sqrt(1 - t1 * t1) + s * t2;
         // Point in the disk space
-        Vec3d diskN{t1, t2, sqrt(std::max(0.0, 1 - t1 * t1 - t2 * t2))};
+        Vec3d diskN{Float(t1), Float(t2), Float(sqrt(std::max(0.0, 1 - t1 * t1 - t2 * t2)))};
         // Reprojection onto hemisphere -- we get our sampled normal in hemisphere space.
         Vec3d T1 = normalize(Vec3d(-hemisphereDirOut.y, hemisphereDirOut.x, 0));
         Vec3d T2 = cross(hemisphereDirOut, T1);
         Vec3d hemisphereN = t1 * T1 + t2 * T2 + diskN.z * hemisphereDirOut;
 
         // Transforming the normal back to the ellipsoid configuration
-        return normalize(Vec3d(alphaX * hemisphereN.x, alphaY * hemisphereN.y, std::max(0.0, hemisphereN.z)));
+        return normalize(Vec3d(alphaX * hemisphereN.x, alphaY * hemisphereN.y, std::max<double>(0.0, hemisphereN.z)));
     } else {
         double cosTheta, phi = (2 * M_PI) * u[1];
         if (alphaX == alphaY) {
@@ -199,7 +199,7 @@ Vec3d MicrograinDistribution::Sample_wh(const Vec3d &wo, Point2d u, const Vec2d
 
     double cos_theta = fm::sqrt(1. / (1. + tan_theta_2));
     double sin_theta = fm::sqrt(1. - cos_theta * cos_theta);
-    return {sin_theta * fm::cos(phi), cos_theta, sin_theta * fm::sin(phi)};
+    return {Float(sin_theta * fm::cos(phi)), Float(cos_theta), Float(sin_theta * fm::sin(phi))};
 }
 
 std::string MicrograinDistribution::ToString() const {
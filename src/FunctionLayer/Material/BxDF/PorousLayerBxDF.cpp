@@ -34,10 +34,10 @@ BxDFSampleResult PourousLayerBxDF::sample(const Vec3d &out, const Point2d &sampl
     double sampleWeight = tau0;
     if (sample[0] < sampleWeight) {
         double resample = sample[0] / sampleWeight;
-        result = micrograinBRDF->sample(out, {resample, sample[1]});
+        result = micrograinBRDF->sample(out, {Float(resample), sample[1]});
     } else {
         double resample = (1.-sample[0]) / (1.-sampleWeight);
-        result = bulkBxDF->sample(out, {resample, sample[1]});
+        result = bulkBxDF->sample(out, {Float(resample), sample[1]});
         chooseBulkLobe = true;
     }
     double w = getMicrograinWeight(tau0, beta, CosTheta(result.directionIn), CosTheta(out));
@@ -25,13 +25,13 @@ Spectrum ConductorMicrograinBxDF::f(const Vec3d &out, const Vec3d &in) const {
     }
     auto Fr = Fresnel::conductorReflectance(eta, k, dot(half, in));
     double denominator = 4 * CosTheta(out) * CosTheta(in);
-    return (Fr * distrib->D(half, {tau0, beta}) * distrib->G(out, in, {tau0, beta})) / denominator;
+    return (Fr * distrib->D(half, {Float(tau0), Float(beta)}) * distrib->G(out, in, {Float(tau0), Float(beta)})) / denominator;
 }
 
 double ConductorMicrograinBxDF::pdf(const Vec3d &out, const Vec3d &in) const {
     if (CosTheta(out) < 0 || CosTheta(in) < 0) return 0;
     Vec3d half = normalize(in + out);
-    return distrib->Pdf(out, half, {tau0, beta}) / (4 * dot(out, half));
+    return distrib->Pdf(out, half, {Float(tau0), Float(beta)}) / (4 * dot(out, half));
 }
 
 BxDFSampleResult ConductorMicrograinBxDF::sample(const Vec3d &out, const Point2d &sample) const {
@@ -39,7 +39,7 @@ BxDFSampleResult ConductorMicrograinBxDF::sample(const Vec3d &out, const Point2d
     if (CosTheta(out) < 0) {
         return result;
     }
-    Vec3d wh = distrib->Sample_wh(out, sample, {tau0, beta});
+    Vec3d wh = distrib->Sample_wh(out, sample, {Float(tau0), Float(beta)});
     Vec3d in = Frame::reflect(out, wh);
     result.pdf = pdf(out, in);
     result.directionIn = in;
@@ -69,7 +69,7 @@ Spectrum PlasticMicrograinBxDF::f(const Vec3d &out, const Vec3d &in) const {
     Spectrum Fr = Fresnel::dielectricReflectance(eta, dot(half, in));
 
     double denominator = 4 * CosTheta(out) * CosTheta(in);
-    auto specular = (Fr * distrib->D(half, {tau0, beta}) * distrib->G(out, in, {tau0, beta})) / denominator;
+    auto specular = (Fr * distrib->D(half, {Float(tau0), Float(beta)}) * distrib->G(out, in, {Float(tau0), Float(beta)})) / denominator;
 
     auto Ti = -1. * Fresnel::dielectricReflectance(eta, CosTheta(in)) + 1.;
     auto To = -1. * Fresnel::dielectricReflectance(eta, CosTheta(out)) + 1.;
@@ -81,7 +81,7 @@ Spectrum PlasticMicrograinBxDF::f(const Vec3d &out, const Vec3d &in) const {
 double PlasticMicrograinBxDF::pdf(const Vec3d &out, const Vec3d &in) const {
     if (CosTheta(out) < 0 || CosTheta(in) < 0) return 0;
     Vec3d half = normalize(out + in);
-    return distrib->Pdf(out, half, {tau0, beta}) / (4 * dot(out, half));
+    return distrib->Pdf(out, half, {Float(tau0), Float(beta)}) / (4 * dot(out, half));
 }
 
 BxDFSampleResult PlasticMicrograinBxDF::sample(const Vec3d &out, const Point2d &sample) const {
@@ -89,7 +89,7 @@ BxDFSampleResult PlasticMicrograinBxDF::sample(const Vec3d &out, const Point2d &
     if (CosTheta(out) < 0) {
         return result;
     }
-    Vec3d wh = distrib->Sample_wh(out, sample, {tau0, beta});
+    Vec3d wh = distrib->Sample_wh(out, sample, {Float(tau0), Float(beta)});
     Vec3d in = Frame::reflect(out, wh);
     result.pdf = pdf(out, in);
     result.directionIn = in;
@@ -11,12 +11,12 @@ std::shared_ptr < BxDF > ConductorMaterial::getBxDF(const Intersection & interse
         double  uRough = uRoughness?uRoughness->eval(intersect):roughness->eval(intersect);
         double  vRough = uRoughness?uRoughness->eval(intersect):roughness->eval(intersect);
         if(glint)
-            return std::make_shared <GlintBxDF>(eta,k,itsAlbedo, uRough, vRough, intersect, distrib);
-        return std::make_shared <RoughConductorBxDF>(eta,k,itsAlbedo,uRough,vRough,distrib);
+            return makeBxDF<GlintBxDF>(eta,k,itsAlbedo, uRough, vRough, GlintBxDF::Footprint::fromIntersection(intersect), glintTable.get(), distrib);
+        return makeBxDF<RoughConductorBxDF>(eta,k,itsAlbedo,uRough,vRough,distrib);
         //Rough conductor
     }
     else {
-        return  std::make_shared<ConductorBxDF>(eta,k,itsAlbedo);
+        return  makeBxDF<ConductorBxDF>(eta,k,itsAlbedo);
     }
 
 }
@@ -43,6 +43,10 @@ ConductorMaterial::ConductorMaterial(const Json & json): Material(json) {
         vRoughness =  TextureFactory::LoadTexture<double>(json["v_roughness"]);
     if(roughness || uRoughness || vRoughness){
         distrib = LoadDistributionFromJson(json);
+        if(glint)
+            glintTable = std::make_shared<GlintParticleTable>(getOptional(json, "glint_seed", 0));
+    } else {
+        flags |= MATERIAL_DELTA;
     }
     if(!conductorName.empty())
         ComplexIorList::lookup(conductorName,eta,k);
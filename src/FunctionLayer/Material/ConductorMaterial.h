@@ -15,6 +15,7 @@
 #include "Material.h"
 
 class MicrofacetDistribution;
+class GlintParticleTable;
 
 /* The refractive index of conductor materials is a complex number, which is specified in fresnel.h. */
 
@@ -35,4 +36,5 @@ private:
     std::string conductorName;
     std::shared_ptr<Texture<RGB3>> albedo;
     bool glint;
+    std::shared_ptr<GlintParticleTable> glintTable;
 };
\ No newline at end of file
@@ -15,6 +15,14 @@
 #include "FunctionLayer/Texture/TextureFactory.h"
 DielectricMaterial::DielectricMaterial(const Json &json): Material(json) {
     ior = getOptional(json, "ior", 1.33); //water
+    //* Dispersion, given by the Abbe number V = (n_d - 1) / (n_F - n_C), with ior as n_d.
+    //* Only used with hero wavelengths, other builds render the material at ior.
+    double abbe = getOptional(json, "abbe_number", 0.0);
+    if (abbe > 0) {
+        const double lambdaD = 0.5876, lambdaF = 0.4861, lambdaC = 0.6563;
+        cauchyB = (ior - 1) / (abbe * (1 / (lambdaF * lambdaF) - 1 / (lambdaC * lambdaC)));
+        cauchyA = ior - cauchyB / (lambdaD * lambdaD);
+    }
     albedoR = TextureFactory::LoadTexture<>(json,"albedo_reflection",RGB3(1,1,1));
     albedoT = TextureFactory::LoadTexture<>(json,"albedo_transmission",RGB3(1,1,1));
     if(json.contains("roughness"))
@@ -26,19 +34,35 @@ DielectricMaterial::DielectricMaterial(const Json &json): Material(json) {
     if(roughness || uRoughness || vRoughness){
         distrib = LoadDistributionFromJson(json);
     }
+    flags = MATERIAL_TRANSMISSION;
+    if(!distrib)
+        flags |= MATERIAL_DELTA;
     twoSideShading = false;
 }
 
 std::shared_ptr<BxDF> DielectricMaterial::getBxDF(const Intersection & intersect) const  {
     Spectrum specularT = albedoT->eval(intersect);
     Spectrum specularR = albedoR->eval(intersect);
+    double ior = this->ior;
+#ifdef USING_HERO_WAVELENGTHS
+    //* The directions are refracted for the hero wavelength alone, so the other wavelengths
+    //* are terminated. Every value of the BxDF is a multiple of the albedos, hence done there.
+    //* The hero is rescaled at the first dispersive vertex of the path only.
+    if (cauchyB > 0 && HeroWavelengths::current()) {
+        double lambda = HeroWavelengths::current()->heroLambda() * 1e-3;
+        ior = cauchyA + cauchyB / (lambda * lambda);
+        double heroScale = HeroWavelengths::current()->terminateSecondary();
+        specularT.terminateSecondary(heroScale);
+        specularR.terminateSecondary(heroScale);
+    }
+#endif
     if( roughness || uRoughness || vRoughness){
         double  uRough = uRoughness?uRoughness->eval(intersect):roughness->eval(intersect);
         double  vRough = uRoughness?uRoughness->eval(intersect):roughness->eval(intersect);
-        return std::make_shared <RoughDielectricBxDF>(ior,specularR,specularT,uRough,vRough,distrib);
+        return makeBxDF<RoughDielectricBxDF>(ior,specularR,specularT,uRough,vRough,distrib);
     }
     else {
-        return  std::make_shared<DielectricBxDF>(ior,specularR,specularT);
+        return  makeBxDF<DielectricBxDF>(ior,specularR,specularT);
     }
 }
 
@@ -27,6 +27,8 @@ public:
 private:
     std::shared_ptr<Texture<double>> roughness = nullptr, uRoughness = nullptr, vRoughness = nullptr;
     double ior;
+    //* Cauchy fit ior(lambda) = cauchyA + cauchyB / lambda^2 (lambda in um), only set for dispersive materials
+    double cauchyA = 0, cauchyB = 0;
     std::shared_ptr<MicrofacetDistribution> distrib;
     std::shared_ptr<Texture<RGB3>> albedoR,albedoT;
 
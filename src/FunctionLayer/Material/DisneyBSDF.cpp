@@ -18,7 +18,7 @@ static Vec2d  getAnisAlpha(double  roughness,double anis){
     double aspect = sqrt(1-0.9*anis);
     double alphaX = std::max(0.0001,pow(roughness,2)/aspect);
     double alphaY = std::max(0.0001,pow(roughness,2)*aspect);
-    return {alphaX,alphaY};
+    return {Float(alphaX),Float(alphaY)};
 }
 
 
@@ -133,7 +133,7 @@ Spectrum evalDisneyBXDFOP::operator ()(const DisneyDiffuse & disneyBXDF) {
 double pdfDisneyBXDFOP::operator ()(const DisneyDiffuse & disneyBXDF) {
     if ( in.z<0 || out.z<0)
         return 0;
-    return std::max(in.z, 0.0) / M_PI;
+    return std::max<double>(in.z, 0.0) / M_PI;
 }
 
 BxDFSampleResult sampleDisneyBXDFOP::operator ()(const DisneyDiffuse & disneyBXDF) {
@@ -338,7 +338,7 @@ Spectrum evalDisneyBXDFOP::operator ()(const DisneySheen & disneyBXDF) {
 double pdfDisneyBXDFOP::operator ()(const DisneySheen & disneyBXDF) {
     if ( in.z<0 || out.z<0)
         return 0;
-    return std::max(in.z, 0.0) / M_PI;}
+    return std::max<double>(in.z, 0.0) / M_PI;}
 
 BxDFSampleResult sampleDisneyBXDFOP::operator ()(const DisneySheen & disneyBXDF) {
     BxDFSampleResult result;
@@ -403,6 +403,8 @@ double DisneyBSDF::pdf(const Vec3d & out, const Vec3d & in) const {
     if(out.z<0){
         return pdfDisneyBXDF(*disneyGlass,out,in);
     }
+    if(stochasticLobes)
+        return mixturePdf(out,in);
     const double diffuseWeight = ( 1 - metallic ) * ( 1 - specularTransmission );
     const double metalWeight = 1 - specularTransmission * ( 1 - metallic );
     const double glassWeight = ( 1 - metallic ) * specularTransmission;
@@ -428,6 +430,8 @@ BxDFSampleResult DisneyBSDF::sample(const Vec3d & out, const Point2d & sample) c
     if(out.z<0){
         return sampleDisneyBXDF(*disneyGlass,out,sample);
     }
+    if(stochasticLobes)
+        return sampleStochastic(out,sample);
     const double diffuseWeight = ( 1 - metallic ) * ( 1 - specularTransmission );
     const double metalWeight = 1 - specularTransmission * ( 1 - metallic );
     const double glassWeight = ( 1 - metallic ) * specularTransmission;
@@ -451,9 +455,78 @@ BxDFSampleResult DisneyBSDF::sample(const Vec3d & out, const Point2d & sample) c
 }
 
 
+Spectrum DisneyBSDF::evalLobe(int lobe, const Vec3d & out, const Vec3d & in) const {
+    evalDisneyBXDFOP op{out,in};
+    switch ( lobe ) {
+        case DIFFUSE_LOBE: return op(*disneyDiffuse);
+        case METAL_LOBE: return op(*disneyMetal);
+        case GLASS_LOBE: return op(*disneyGlass);
+        case CLEARCOAT_LOBE: return op(*disneyClearCoat);
+        default: return op(*disneySheen);
+    }
+}
+
+double DisneyBSDF::pdfLobe(int lobe, const Vec3d & out, const Vec3d & in) const {
+    pdfDisneyBXDFOP op{out,in};
+    switch ( lobe ) {
+        case DIFFUSE_LOBE: return op(*disneyDiffuse);
+        case METAL_LOBE: return op(*disneyMetal);
+        case GLASS_LOBE: return op(*disneyGlass);
+        case CLEARCOAT_LOBE: return op(*disneyClearCoat);
+        default: return op(*disneySheen);
+    }
+}
+
+BxDFSampleResult DisneyBSDF::sampleLobe(int lobe, const Vec3d & out, const Point2d & sample) const {
+    sampleDisneyBXDFOP op{out,sample};
+    switch ( lobe ) {
+        case DIFFUSE_LOBE: return op(*disneyDiffuse);
+        case METAL_LOBE: return op(*disneyMetal);
+        case GLASS_LOBE: return op(*disneyGlass);
+        case CLEARCOAT_LOBE: return op(*disneyClearCoat);
+        default: return op(*disneySheen);
+    }
+}
+
+double DisneyBSDF::mixturePdf(const Vec3d & out, const Vec3d & in) const {
+    double pdf = 0;
+    for ( int lobe = 0 ; lobe < LOBE_COUNT ; ++ lobe )
+        if ( lobeProb[lobe] > 0 )
+            pdf += lobeProb[lobe] * pdfLobe(lobe,out,in);
+    return pdf;
+}
+
+BxDFSampleResult DisneyBSDF::sampleStochastic(const Vec3d & out, const Point2d & sample) const {
+    // choose the lobe with sample.x and rescale it for the lobe's own sampling
+    double u = sample.x;
+    int lobe = DIFFUSE_LOBE;
+    for ( int k = 0 ; k < LOBE_COUNT ; ++ k ) {
+        if ( lobeProb[k] <= 0 )
+            continue;
+        lobe = k;
+        if ( u < lobeProb[k] )
+            break;
+        u -= lobeProb[k];
+    }
+    u = std::clamp(u / lobeProb[lobe], 0.0, 1.0 - 1e-12);
+
+    BxDFSampleResult result = sampleLobe(lobe, out, Point2d(u, sample.y));
+    double lobePdf = lobeProb[lobe] * pdfLobe(lobe, out, result.directionIn);
+    if ( lobePdf <= 0 ) {
+        result.s = Spectrum(0);
+        result.pdf = 0;
+        return result;
+    }
+    // s / pdf is the one-lobe estimate weight * f / (prob * pdf), while pdf stays the mixture pdf for MIS
+    result.pdf = mixturePdf(out, result.directionIn);
+    result.s = evalLobe(lobe, out, result.directionIn) * ( lobeWeight[lobe] * result.pdf / lobePdf );
+    return result;
+}
+
 DisneyBSDF::DisneyBSDF(const Spectrum & baseColor, double specularTransmission, double metallic, double subsurface,
                        double specular, double roughness, double specularTint, double anisotropic, double sheen,
-                       double sheenTint, double clearCoat, double clearCoatGloss, double eta
+                       double sheenTint, double clearCoat, double clearCoatGloss, double eta,
+                       bool stochasticLobes
                       ) :
                       disneyDiffuse(std::make_unique<DisneyDiffuse>(DisneyDiffuse{baseColor,roughness,subsurface})),
                       disneyMetal(std::make_unique<DisneyMetal>(DisneyMetal(baseColor,roughness,anisotropic))),
@@ -461,8 +534,34 @@ DisneyBSDF::DisneyBSDF(const Spectrum & baseColor, double specularTransmission,
                       disneyGlass(std::make_unique<DisneyGlass>(DisneyGlass{baseColor,roughness,anisotropic,eta})),
                       disneySheen(std::make_unique<DisneySheen>(DisneySheen{baseColor,sheenTint}))
                       ,specularTransmission(specularTransmission),metallic(metallic), clearCoat(clearCoat),
-                                                                       sheen(sheen), ior(eta)
+                                                                       sheen(sheen), ior(eta),
+                                                                       stochasticLobes(stochasticLobes)
                                                                               {
+    // same lobe weights as f()
+    lobeWeight[DIFFUSE_LOBE] = (1-specularTransmission)*(1-metallic);
+    lobeWeight[METAL_LOBE] = 1-specularTransmission*(1-metallic);
+    lobeWeight[GLASS_LOBE] = (1-metallic)*specularTransmission;
+    lobeWeight[CLEARCOAT_LOBE] = 0.25*clearCoat;
+    lobeWeight[SHEEN_LOBE] = (1-metallic)*sheen;
+
+    // rough albedo of each lobe, Schlick averages for the Fresnel terms
+    double lum = std::clamp(baseColor.luminance(), 0.0, 1.0);
+    double R0 = pow((eta-1)/(eta+1),2);
+    double albedo[LOBE_COUNT];
+    albedo[DIFFUSE_LOBE] = lum;
+    albedo[METAL_LOBE] = lum + (1-lum)/21;
+    albedo[GLASS_LOBE] = R0 + (1-R0)*sqrt(lum);
+    albedo[CLEARCOAT_LOBE] = 0.04 + 0.96/21;
+    albedo[SHEEN_LOBE] = 0.1;
+    double sum = 0;
+    for ( int lobe = 0 ; lobe < LOBE_COUNT ; ++ lobe ) {
+        lobeWeight[lobe] = std::max(lobeWeight[lobe], 0.0);
+        // the floor bounds the variance of a lobe whose albedo is underestimated
+        lobeProb[lobe] = lobeWeight[lobe] * std::max(albedo[lobe], 0.05);
+        sum += lobeProb[lobe];
+    }
+    for ( int lobe = 0 ; lobe < LOBE_COUNT ; ++ lobe )
+        lobeProb[lobe] = sum > 0 ? lobeProb[lobe] / sum : ( lobe == DIFFUSE_LOBE );
                                                                               }
 
 double DisneyBSDF::eta(const Vec3d & out, const Vec3d & in) const {
@@ -472,12 +571,12 @@ double DisneyBSDF::eta(const Vec3d & out, const Vec3d & in) const {
 }
 
 std::shared_ptr < BxDF > DisneyMaterial::getBxDF(const Intersection & intersect) const {
-   return std::make_shared <DisneyBSDF>(
+   return makeBxDF<DisneyBSDF>(
             baseColor->eval(intersect),specularTransmission->eval(intersect),
             metallic->eval(intersect),subsurface->eval(intersect),specular->eval(intersect),
             roughness->eval(intersect),specularTint->eval(intersect),
             anisotropic->eval(intersect),sheen->eval(intersect),sheenTint->eval(intersect),
-            clearCoat->eval(intersect),clearCoatGloss->eval(intersect),eta);
+            clearCoat->eval(intersect),clearCoatGloss->eval(intersect),eta,stochasticLobes);
 
 }
 
@@ -499,5 +598,10 @@ DisneyMaterial::DisneyMaterial(const Json & json): Material(json) {
     clearCoat = TextureFactory::LoadTexture<double>(getChild(json,"clear_coat"),0);
     clearCoatGloss = TextureFactory::LoadTexture<double>(getChild(json,"clear_coat_gloss"),0);
     eta = getOptional(json,"eta",1.5);
+    // sample and evaluate a single lobe per scattering event, see DisneyBSDF
+    stochasticLobes = getOptional(json,"stochastic_lobes",false);
+    auto constantTransmission = std::dynamic_pointer_cast<ConstantTexture<double>>(specularTransmission);
+    if(!constantTransmission || constantTransmission->eval(Intersection()) > 0)
+        flags |= MATERIAL_TRANSMISSION;
     twoSideShading = false;
 }
@@ -27,7 +27,8 @@ public:
 
     DisneyBSDF(const Spectrum & baseColor, double specularTransmission, double metallic, double subsurface,
                double specular, double roughness, double specularTint, double anisotropic, double sheen,
-               double sheenTint, double clearCoat, double clearCoatGloss, double eta);
+               double sheenTint, double clearCoat, double clearCoatGloss, double eta,
+               bool stochasticLobes = false);
     double eta(const Vec3d &out,const Vec3d & in) const override;
 
     [[nodiscard]]
@@ -50,6 +51,20 @@ protected:
     std::unique_ptr<DisneyClearCoat> disneyClearCoat;
     std::unique_ptr<DisneySheen> disneySheen;
 
+    //* Stochastic lobe mode: sample() picks one lobe with probability lobeProb, proportional to
+    //* its weight times an albedo estimate, and evaluates only that lobe. The returned pdf is the
+    //* mixture pdf of all lobes, the one pdf() reports, so MIS with light sampling stays consistent.
+    //* f() still evaluates every lobe, as next event estimation needs the full BSDF.
+    enum ELobe { DIFFUSE_LOBE, METAL_LOBE, GLASS_LOBE, CLEARCOAT_LOBE, SHEEN_LOBE, LOBE_COUNT };
+    bool stochasticLobes;
+    double lobeWeight[LOBE_COUNT];
+    double lobeProb[LOBE_COUNT];
+
+    Spectrum evalLobe(int lobe, const Vec3d & out, const Vec3d & in) const;
+    double pdfLobe(int lobe, const Vec3d & out, const Vec3d & in) const;
+    BxDFSampleResult sampleLobe(int lobe, const Vec3d & out, const Point2d & sample) const;
+    double mixturePdf(const Vec3d & out, const Vec3d & in) const;
+    BxDFSampleResult sampleStochastic(const Vec3d & out, const Point2d & sample) const;
 };
 
 class DisneyMaterial: public Material{
@@ -72,4 +87,5 @@ protected:
     std::shared_ptr<Texture<double>>  clearCoatGloss;
 
     double eta;
+    bool stochasticLobes;
 };
\ No newline at end of file
@@ -8,12 +8,29 @@ HairMaterial::HairMaterial(const Json & json) {
     attr.melaninRatio = getOptional(json, "melanin_ratio", 1);
     attr.melaninConcentration = getOptional(json, "melanin_concentration", 1.3);
     roughness = TextureFactory::LoadTexture <double>(json,"roughness",0.1);
+    // "lookup_table": true, or an object with "theta_resolution", "h_resolution", "phi_resolution"
+    // and "roughness_resolution", replaces the analytic terms of the BSDF by tables, see HairTable
+    auto tableJson = json.find("lookup_table");
+    if (tableJson != json.end() && (tableJson->is_object() || *tableJson == true)) {
+        HairTable::Settings settings;
+        if (tableJson->is_object()) {
+            settings.thetaResolution = getOptional(*tableJson, "theta_resolution", settings.thetaResolution);
+            settings.hResolution = getOptional(*tableJson, "h_resolution", settings.hResolution);
+            settings.phiResolution = getOptional(*tableJson, "phi_resolution", settings.phiResolution);
+            settings.roughnessResolution = getOptional(*tableJson, "roughness_resolution", settings.roughnessResolution);
+        }
+        double roughnessMin = 0, roughnessMax = 1;
+        if (auto constant = std::dynamic_pointer_cast<ConstantTexture<double>>(roughness))
+            roughnessMin = roughnessMax = constant->eval(Intersection());
+        table = std::make_shared<HairTable>(attr, roughnessMin, roughnessMax, settings);
+    }
+    flags = MATERIAL_TRANSMISSION;
     twoSideShading = false;
 }
 
 
 std::shared_ptr < BxDF > HairMaterial::getBxDF(const Intersection & intersect) const {
-    return std::make_shared <Hair>(&attr,roughness->eval(intersect),2 * intersect.uv.y - 1 );
+    return makeBxDF<Hair>(&attr,roughness->eval(intersect),2 * intersect.uv.y - 1,table.get());
 }
 
 
@@ -11,6 +11,7 @@ public:
 private:
     HairAttribute attr;
     std::shared_ptr <Texture<double>> roughness;
+    std::shared_ptr <HairTable> table;
 };
 //class RoughHairMaterial : public  Material {
 //public:
@@ -41,7 +41,8 @@ void Material::setOutMedium(std::shared_ptr < Medium > _outsideMedium) {
     outsideMedium = _outsideMedium;
 }
 void Material::setFrame(Intersection &its,const Ray&  ray) const{
-    its.shFrame = Frame(its.geometryNormal);
+    //* shapes put their shading normal in shFrame, which differs from geometryNormal on smooth meshes
+    its.shFrame = Frame(its.shFrame.n);
     if(twoSideShading)
         flipFrame(its,ray);
 }
@@ -54,6 +55,12 @@ void Material::flipFrame(Intersection &its, const Ray &ray) const {
     }
 }
 
+bool Material::canScatter(const Intersection &its, const Vec3d &wo, const Vec3d &wi) const {
+    if (flags & (MATERIAL_NULL | MATERIAL_TRANSMISSION))
+        return true;
+    return dot(its.shFrame.n, wo) * dot(its.shFrame.n, wi) > 0;
+}
+
 Material::Material(const Json &json) {
     twoSideShading = getOptional(json,"two_side_shading",true);
 }
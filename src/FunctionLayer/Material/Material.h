@@ -13,6 +13,7 @@
 #include <memory>
 #include <utility>
 #include "CoreLayer/Adapter/JsonUtil.h"
+#include "CoreLayer/Adapter/MemoryArena.h"
 #include "FunctionLayer/Material/BxDF/BxDF.h"
 template<class T>
 class Texture;
@@ -34,6 +35,13 @@ enum EMaterialType {
     //* Other
 };
 
+/// @brief Properties of a material the integrators query without building a BxDF.
+enum EMaterialFlag {
+    MATERIAL_NULL = 1 << 0,         ///< rays pass straight through, see NullBxDF
+    MATERIAL_DELTA = 1 << 1,        ///< every lobe is a delta, light sampling can be skipped
+    MATERIAL_TRANSMISSION = 1 << 2  ///< may scatter to the other side of the surface
+};
+
 class Ray;
 class Material
 {
@@ -49,7 +57,24 @@ public:
     void setInsideMedium(std::shared_ptr<Medium> _insideMedium);
     void setOutMedium(std::shared_ptr<Medium> _outsideMedium);
     EMaterialType type = EMaterialType::Unkown;
+
+    bool isNull() const { return flags & MATERIAL_NULL; }
+    bool isDelta() const { return flags & MATERIAL_DELTA; }
+    bool hasTransmission() const { return flags & MATERIAL_TRANSMISSION; }
+    /// @brief false if no light can scatter between the world directions wo and wi at its: they lie on
+    /// opposite sides of the shading frame and the surface is opaque. Integrators skip the shadow ray then.
+    bool canScatter(const Intersection &its, const Vec3d &wo, const Vec3d &wi) const;
+    int getFlags() const { return flags; }
 protected:
+    /// @brief construct a BxDF in the shading arena of the calling render thread, on the heap outside of rendering.
+    template<typename T, typename... Args>
+    static std::shared_ptr<T> makeBxDF(Args &&...args) {
+        if (MemoryArena *arena = MemoryArena::current())
+            return std::allocate_shared<T>(ArenaAllocator<T>(arena), std::forward<Args>(args)...);
+        return std::make_shared<T>(std::forward<Args>(args)...);
+    }
+
+    int flags = 0;
     bool twoSideShading;
     std::shared_ptr<Medium> insideMedium;
     std::shared_ptr<Medium> outsideMedium;
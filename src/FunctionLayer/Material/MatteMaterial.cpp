@@ -18,7 +18,7 @@
 std::shared_ptr<BxDF> MatteMaterial::getBxDF(const Intersection & intersect) const
 {
     Spectrum color = albedo->eval(intersect);
-    std::shared_ptr<LambertainBxDF> bxdf = std::make_shared<LambertainBxDF>(color);
+    std::shared_ptr<LambertainBxDF> bxdf = makeBxDF<LambertainBxDF>(color);
     return bxdf;
 }
 
@@ -14,7 +14,7 @@
 #include "MirrorMaterial.h"
 std::shared_ptr<BxDF> MirrorMaterial::getBxDF(const Intersection & intersect) const
 {
-    std::shared_ptr<MirrorBxDF> bxdf = std::make_shared<MirrorBxDF>();
+    std::shared_ptr<MirrorBxDF> bxdf = makeBxDF<MirrorBxDF>();
     return bxdf;
 }
 
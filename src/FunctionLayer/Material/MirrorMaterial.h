@@ -18,6 +18,7 @@
 class MirrorMaterial  : public  Material{
 
 public:
+    MirrorMaterial() { flags = MATERIAL_DELTA; }
     std::shared_ptr<BxDF> getBxDF(const Intersection & intersect) const  override;
     std::shared_ptr<BSSRDF> getBSSRDF(const Intersection & intersect) const override;
 };
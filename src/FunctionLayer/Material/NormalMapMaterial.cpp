@@ -22,6 +22,7 @@ void NormalMapMaterial::setFrame(Intersection &its, const Ray &ray) const {
 
 NormalMapMaterial::NormalMapMaterial(const Json &json) {
     if (json.contains("normal"))
-        normal = TextureFactory::LoadTexture<RGB3>(json.at("normal"));
+        normal = TextureFactory::LoadTexture<RGB3>(json.at("normal"), Image::ImageLoadMode::IMAGE_LOAD_LINEAR);
     innerMaterial = MaterialFactory::LoadMaterialFromJson(json.at("material"));
+    flags = innerMaterial->getFlags();
 }
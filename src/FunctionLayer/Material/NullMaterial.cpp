@@ -3,6 +3,7 @@
 #include "FunctionLayer/Medium/Homogeneous.h"
 NullMaterial::NullMaterial(const Json &json) {
     type = EMaterialType::Null;
+    flags = MATERIAL_NULL;
 }
 
 std::shared_ptr<BxDF>
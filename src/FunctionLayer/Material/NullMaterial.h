@@ -16,7 +16,7 @@
 
 class NullMaterial : public Material{
 public:
-    NullMaterial() = default;
+    NullMaterial() { flags = MATERIAL_NULL; }
     NullMaterial(const Json &json);
 	virtual std::shared_ptr<BxDF> getBxDF(const Intersection & intersect) const override;
 	virtual std::shared_ptr<BSSRDF> getBSSRDF(const Intersection & intersect) const override;
@@ -9,9 +9,9 @@ std::shared_ptr < BxDF > PlasticMaterial::getBxDF(const Intersection & intersect
     if ( roughness || uRoughness || vRoughness ) {
         double uRough = uRoughness ? uRoughness->eval(intersect) : roughness->eval(intersect);
         double vRough = uRoughness ? uRoughness->eval(intersect) : roughness->eval(intersect);
-        return std::make_shared < RoughPlastic >(itsAlbedoDiffuse,ior,_diffuseFresnel,_avgTransmittance,_scaledSigmaA, uRough, vRough, distrib);
+        return makeBxDF<RoughPlastic>(itsAlbedoDiffuse,ior,_diffuseFresnel,_avgTransmittance,_scaledSigmaA, uRough, vRough, distrib);
     } else {
-        return std::make_shared<Plastic>(itsAlbedoDiffuse,ior,_diffuseFresnel,_avgTransmittance,_scaledSigmaA);
+        return makeBxDF<Plastic>(itsAlbedoDiffuse,ior,_diffuseFresnel,_avgTransmittance,_scaledSigmaA);
     }
 }
 
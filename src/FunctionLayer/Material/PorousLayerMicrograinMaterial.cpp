@@ -13,13 +13,13 @@ std::shared_ptr<BxDF> PourousLayerMicrograinMaterial::getBxDF(const Intersection
     double _beta = beta->eval(intersect);
     std::shared_ptr<MicrograinBxDF> micrograinBRDF;
     if (micrograinType == MicrograinType::CONDUCTOR) {
-        micrograinBRDF = std::make_shared<ConductorMicrograinBxDF>(_R0, k, _tau0, _beta);
+        micrograinBRDF = makeBxDF<ConductorMicrograinBxDF>(_R0, k, _tau0, _beta);
 
     } else {
         Spectrum _kd = kd->eval(intersect);
-        micrograinBRDF = std::make_shared<PlasticMicrograinBxDF>(_R0, _kd, _tau0, _beta);
+        micrograinBRDF = makeBxDF<PlasticMicrograinBxDF>(_R0, _kd, _tau0, _beta);
     }
-    return std::make_shared<PourousLayerBxDF>(micrograinBRDF, bulkMaterial->getBxDF(intersect));
+    return makeBxDF<PourousLayerBxDF>(micrograinBRDF, bulkMaterial->getBxDF(intersect));
 }
 
 std::shared_ptr<BSSRDF> PourousLayerMicrograinMaterial::getBSSRDF(const Intersection &intersect) const {
@@ -42,4 +42,5 @@ PourousLayerMicrograinMaterial::PourousLayerMicrograinMaterial(const Json &json)
     }
 
     bulkMaterial = MaterialFactory::LoadMaterialFromJson(json["bulkMaterial"]);
+    flags = bulkMaterial->getFlags() & MATERIAL_TRANSMISSION;
 }
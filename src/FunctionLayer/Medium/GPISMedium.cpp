@@ -71,7 +71,7 @@ Spectrum GPISMedium::evalTransmittance(Point3d from, Point3d dest) const {
     sampleRecord.mediumState = &mediumState;
 
     Intersection its;
-    its.t = (dest - from)[0] / direction[0];
+    its.t = (dest - from).length();
     bool shadowed = sampleDistance(&sampleRecord, ray, its, {});
 
     return 1 - shadowed;
@@ -3,6 +3,7 @@
 #include <nanovdb/util/SampleFromVoxels.h>
 #include <FunctionLayer/Sampler/Independent.h>
 #include <ResourceLayer/File/FileUtils.h>
+#include "CoreLayer/Profiler/LoadProfiler.h"
 
 class RegularTracker {
 public:
@@ -104,37 +105,28 @@ double HeterogeneousMedium::scaleSample(nanovdb::Vec3R index,
 }
 
 Point3d HeterogeneousMedium::worldToIndex(Point3d world) const {
-    world = invTransformMatrix * world;
-    auto index = densityFloatGrid->worldToIndexF(nanovdb::Vec3f{(float)world[0], (float)world[1], (float)world[2]});
-    return Point3d{index[0], index[1], index[2]};
+    return worldToIndexTransform * world;
 }
 
 Point3d HeterogeneousMedium::indexToWorld(Point3d index) const {
-    nanovdb::Vec3f idx{(float)index[0], (float)index[1], (float)index[2]};
-    auto wrd = densityFloatGrid->indexToWorldF(idx);
-    Point3d world{wrd[0], wrd[1], wrd[2]};
-    return transformMatrix * world;
+    return worldToIndexTransform.inversePoint(index);
 }
 
 Vec3d HeterogeneousMedium::worldToIndexDir(Vec3d world) const {
-    world = invTransformMatrix * world;
-    auto index = densityFloatGrid->worldToIndexDirF(nanovdb::Vec3f{(float)world[0], (float)world[1], (float)world[2]});
-    return normalize(Vec3d{index[0], index[1], index[2]});
+    return normalize(worldToIndexTransform * world);
 }
 
 Vec3d HeterogeneousMedium::indexToWorldDir(Vec3d index) const {
-    nanovdb::Vec3f idx{(float)index[0], (float)index[1], (float)index[2]};
-    auto wrd = densityFloatGrid->indexToWorldDirF(idx);
-    Vec3d world{wrd[0], wrd[1], wrd[2]};
-    return normalize(transformMatrix * world);
+    return normalize(worldToIndexTransform.inverseVector(index));
 }
 
 HeterogeneousMedium::HeterogeneousMedium(std::string gridFilePath, std::shared_ptr<PhaseFunction> phase, TransformMatrix3D _transformMatrix, float _sigmaScale) : Medium(phase) {
-    transformMatrix = _transformMatrix;
-    invTransformMatrix = _transformMatrix.getInverse();
-
     std::string fullGridFilePath = FileUtils::getWorkingDir() + gridFilePath;
-    densityGrid = nanovdb::io::readGrid(fullGridFilePath, "density", 1);
+    {
+        ProfileScope profile("nanovdb", fullGridFilePath);
+        densityGrid = nanovdb::io::readGrid(fullGridFilePath, "density", 1);
+        profile.setBytes(densityGrid.size());
+    }
     densityFloatGrid = densityGrid.grid<float>();
 
     sigmaScale = _sigmaScale;
@@ -144,6 +136,14 @@ HeterogeneousMedium::HeterogeneousMedium(std::string gridFilePath, std::shared_p
         exit(1);
     }
 
+    //* the index map of a grid is affine, read it off the images of the origin and the axes
+    auto toVec3d = [](const nanovdb::Vec3f &v) { return Vec3d(v[0], v[1], v[2]); };
+    AffineTransform3D gridIndexMap(toVec3d(densityFloatGrid->worldToIndexDirF(nanovdb::Vec3f(1, 0, 0))),
+                                   toVec3d(densityFloatGrid->worldToIndexDirF(nanovdb::Vec3f(0, 1, 0))),
+                                   toVec3d(densityFloatGrid->worldToIndexDirF(nanovdb::Vec3f(0, 0, 1))),
+                                   toVec3d(densityFloatGrid->worldToIndexF(nanovdb::Vec3f(0, 0, 0))));
+    worldToIndexTransform = gridIndexMap * _transformMatrix.getAffine().inverse();
+
     // Assume every voxel is cube
     voxelSize = densityFloatGrid->voxelSize()[0];
 
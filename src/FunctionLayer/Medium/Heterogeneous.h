@@ -37,7 +37,8 @@ protected:
     Vec3d indexToWorldDir(Vec3d index) const;
 
 private:
-    mutable TransformMatrix3D transformMatrix, invTransformMatrix;
+    /// @brief inverse of the medium transform followed by the index map of the grid, built once the grid is read.
+    AffineTransform3D worldToIndexTransform;
 
     float voxelSize;
     float sigmaScale = 1.f;
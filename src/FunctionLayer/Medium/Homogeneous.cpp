@@ -1,6 +1,28 @@
 #include "Homogeneous.h"
 #include "FastMath.h"
 
+namespace {
+
+/// @brief Bins carried by the camera sample of the calling thread: its hero wavelengths, or the whole spectrum.
+/// The other bins of a spectrum are never read, so they are left at zero instead of paying an exp each.
+struct CarriedBins {
+    CarriedBins() {
+#ifdef USING_HERO_WAVELENGTHS
+        if (const HeroWavelengths *wavelengths = HeroWavelengths::current()) {
+            bins = wavelengths->bins;
+            count = HeroWavelengths::count;
+        }
+#endif
+    }
+
+    int operator[](int k) const { return bins ? bins[k] : k; }
+
+    const int *bins = nullptr;
+    int count = nSpectrumSamples;
+};
+
+}
+
 /// @brief Sample a scattering distance inside the (homogeneous) medium using naive but unbiased sampling strategy (i.e., inverse exponential sampling).
 /// @param mRec Serve as return value.
 /// @param ray Current ray inside medium.
@@ -15,8 +37,9 @@ bool HomogeneousMedium::sampleDistance(MediumSampleRecord *mRec,
 
     auto [x, y] = sample;
 
-    // * randomly pick a channel/frequency and sample a distance.
-    int channelIndex = int(x * nSpectrumSamples);
+    // * randomly pick a carried channel/frequency and sample a distance.
+    CarriedBins carried;
+    int channelIndex = carried[std::min(int(x * carried.count), carried.count - 1)];
     double dist = -fm::log(1 - y) / mSigmaT[channelIndex];
 
     if (dist < its.t) {
@@ -28,10 +51,11 @@ bool HomogeneousMedium::sampleDistance(MediumSampleRecord *mRec,
         mRec->tr = evalTransmittance(ray.origin, mRec->scatterPoint);
         // calculate pdf, i.e., sum of $1\n * \sigma_t^i e^{-\sigma_t^i * t}$.
         mRec->pdf = 0.0;
-        for (int i = 0; i < nSpectrumSamples; i++) {
+        for (int k = 0; k < carried.count; k++) {
+            int i = carried[k];
             mRec->pdf += mSigmaT[i] * fm::exp(-mSigmaT[i] * dist);
         }
-        mRec->pdf /= nSpectrumSamples;
+        mRec->pdf /= carried.count;
         return true;
     } else {
         // sampled a point on object boundary (surface).
@@ -39,10 +63,10 @@ bool HomogeneousMedium::sampleDistance(MediumSampleRecord *mRec,
         mRec->tr = evalTransmittance(ray.origin, its.position);
         // calculate discrete probility (instead of continuous probability density), i.e., sum of $1\n * e^{-\sigma_t^i * t_max}$.
         mRec->pdf = 0.0;
-        for (int i = 0; i < nSpectrumSamples; i++) {
-            mRec->pdf += fm::exp(-mSigmaT[i] * its.t);
+        for (int k = 0; k < carried.count; k++) {
+            mRec->pdf += fm::exp(-mSigmaT[carried[k]] * its.t);
         }
-        mRec->pdf /= nSpectrumSamples;
+        mRec->pdf /= carried.count;
         return false;
     }
     // * Incomprehensible strategy that discrete probabilities and continuous probabilities share the same responsibility.
@@ -55,8 +79,10 @@ bool HomogeneousMedium::sampleDistance(MediumSampleRecord *mRec,
 Spectrum HomogeneousMedium::evalTransmittance(Point3d from,
                                               Point3d dest) const {
     double dist = (dest - from).length();
+    CarriedBins carried;
     Spectrum tr;
-    for (int i = 0; i < nSpectrumSamples; i++) {
+    for (int k = 0; k < carried.count; k++) {
+        int i = carried[k];
         tr[i] = fm::exp(-mSigmaT[i] * dist);
     }
     return tr;
@@ -35,18 +35,12 @@ static uint64_t multiplicative_inverse(int64_t a, int64_t n) {
   return mod(x, n);
 }
 
-std::vector<uint16_t> HaltonSampler::scramblePermutations;
 HaltonSampler::HaltonSampler(int64_t _sppSqrt, int resolution_w,
                              int resolution_h)
     : HaltonSampler(_sppSqrt, resolution_w, resolution_h, 5) {}
 HaltonSampler::HaltonSampler(int64_t _sppSqrt, int resolution_w,
                              int resolution_h, int _nDim)
     : GlobalSampler(_sppSqrt, _nDim) {
-  // Generate scramnle perms
-  if (scramblePermutations.size() == 0) {
-    RandomNumberGenerator rng;
-    scramblePermutations = computeScramblePermutations(rng);
-  }
   // Compute scales for base-2 and base-3
   Point2i res(resolution_w, resolution_h);
   for (int i = 0; i < 2; i++) {
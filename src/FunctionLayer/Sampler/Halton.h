@@ -25,8 +25,6 @@ public:
     virtual std::unique_ptr<Sampler> clone(int seed) const override;
 
 private:
-    /// @brief All instances share the same perms.
-    static std::vector<uint16_t> scramblePermutations;
     /**
      * @brief Value and power required to scale base-2 and base-3
      *        till no less than resoluton_w and resolution_h.
@@ -47,7 +45,7 @@ private:
      * @return const uint16_t* Pointer to the first value of the permutation.
      */
     const uint16_t *permutationOfDimension(int dim) const {
-        assert(0 <= dim && dim <= nPrimes);
-        return &(scramblePermutations[PrimeSums[dim]]);
+        assert(0 <= dim && dim < nPrimes);
+        return scramblePermutation(dim);
     }
 };
\ No newline at end of file
@@ -24,7 +24,7 @@ public:
     }
 
     virtual Point2d sample2D() override {
-        return Point2d{rng(), rng()};
+        return Point2d{Float(rng()), Float(rng())};
     }
 
     virtual std::unique_ptr<Sampler> clone(int seed) const override {
@@ -147,7 +147,7 @@ public:
     /// @brief Sample a double in [0, 1], if curDimension exceeds the nDimensions, just return rng()
     /// @return A double sample
     virtual double sample1D() override {
-        if (curDimensionIndex1D < nDimensions)
+        if (curDimensionIndex1D < size_t(nDimensions))
             return samples1D[curDimensionIndex1D++][curSamplePixelIndex];
         else
             return rng();
@@ -156,10 +156,10 @@ public:
     /// @brief Sample a point2d in [0, 1]^2, if curDimension exceeds the nDimensions, just return {rng(), rng()}
     /// @return A point2d sample
     virtual Point2d sample2D() override {
-        if (curDimensionIndex2D < nDimensions)
+        if (curDimensionIndex2D < size_t(nDimensions))
             return samples2D[curDimensionIndex2D++][curSamplePixelIndex];
         else
-            return Point2d{rng(), rng()};
+            return Point2d{Float(rng()), Float(rng())};
     }
 };
 
@@ -207,7 +207,7 @@ public:
         // To avoid the identical values
         // in case that low-discrepancy sequence is deterministic
         int dim = nDimensions;
-        for (size_t i = 0; i < nDimensions; i++) {
+        for (int i = 0; i < nDimensions; i++) {
             for (int64_t j = 0; j < samplesPerPixel; j++) {
                 int64_t idx = globalSampleIndex(j);
                 // In fact it goes further than nDimensions
@@ -232,17 +232,17 @@ public:
     }
 
     virtual double sample1D() override {
-        if (curDimensionIndex1D < nDimensions)
+        if (curDimensionIndex1D < size_t(nDimensions))
             return samples1D[curDimensionIndex1D++][curSamplePixelIndex];
         else
             return rng();
     }
 
     virtual Point2d sample2D() override {
-        if (curDimensionIndex2D < nDimensions)
+        if (curDimensionIndex2D < size_t(nDimensions))
             return samples2D[curDimensionIndex2D++][curSamplePixelIndex];
         else
-            return Point2d{rng(), rng()};
+            return Point2d{Float(rng()), Float(rng())};
     }
 
     /**
@@ -14,26 +14,81 @@
 #include "FunctionLayer/Acceleration/Embree.h"
 #include "FunctionLayer/Material/MaterialFactory.h"
 #include "FunctionLayer/Shape/EntityFactory.h"
+#include "FunctionLayer/Shape/ProxyMesh.h"
+#include "CoreLayer/Profiler/LoadProfiler.h"
+#include "ResourceLayer/ResourceManager.h"
+#include "ResourceLayer/TextureCache.h"
+#include "ResourceLayer/File/FileUtils.h"
 #include "FunctionLayer/Medium/MediumFactory.h"
+#include <filesystem>
 
 Scene::Scene() : lights(std::make_shared<std::vector<std::shared_ptr<Light>>>()), entities(std::make_shared<std::vector<std::shared_ptr<Entity>>>())
 {
 }
 
 Scene::Scene(const Json & json) {
+    OutOfCoreCache::getInstance()->setBudget(
+        size_t(getOptional(json, "out_of_core_budget", 8192.0) * 1024 * 1024));
+    if (getOptional(json, "hdr_texture_format", std::string("float")) == "half")
+        ImageManager::getInstance()->setHdrFormat(ETexelFormat::HALF);
+    if (json.contains("texture_cache")) {
+        const auto &cacheJson = json.at("texture_cache");
+        auto textureCache = TextureCache::getInstance();
+        textureCache->setBudget(size_t(getOptional(cacheJson, "budget", 1024.0) * 1024 * 1024));
+        textureCache->setTileSize(getOptional(cacheJson, "tile_size", 64));
+        textureCache->setTiledByDefault(getOptional(cacheJson, "tiled", true));
+        //* relative cache directories are relative to the scene, like every other path in it
+        std::string cacheDirectory = getOptional(cacheJson, "directory", std::string());
+        if (!cacheDirectory.empty() && std::filesystem::path(cacheDirectory).is_relative())
+            cacheDirectory = FileUtils::getFullPath(cacheDirectory);
+        textureCache->setCacheDirectory(cacheDirectory);
+    }
     mediums =  MediumFactory::LoadMediumMapFromJson(json.at("mediums"));
     materials = MaterialFactory::LoadMaterialMapFromJson(json.at("materials"),*this);
     lights = std::make_shared<std::vector<std::shared_ptr<Light>>>();
+    // "light_sampler": "bvh" (default) or "power"
+    lightSampler = getOptional(json, "light_sampler", std::string("bvh")) == "power" ?
+                   ELightSampler::POWER : ELightSampler::BVH;
     entities  = std::make_shared<std::vector<std::shared_ptr<Entity>>>
                         (EntityFactory::LoadEntityListFromJson(json.at("entities"),*this));
 
 }
 
 void Scene::build() {
-    for(auto entity:*entities)
-        entity->apply();
-	//accel = std::make_shared<Bvh>(*entities);
-    accel = std::make_shared<EmbreeAccel>(*entities);
+    {
+        ProfileScope profile("apply");
+        for(auto entity:*entities)
+            entity->apply();
+    }
+    {
+        ProfileScope profile("accel");
+	    //accel = std::make_shared<Bvh>(*entities);
+        accel = std::make_shared<EmbreeAccel>(*entities);
+    }
+    {
+        ProfileScope profile("light table");
+        //* infinite lights are weighted by the power they send through the scene bounds
+        BoundingBox3f bounds = accel->getGlobalBoundingBox();
+        double sceneRadius = bounds.pMin.x > bounds.pMax.x ? 0 : 0.5 * (bounds.pMax - bounds.pMin).length();
+        std::vector<double> powers(lights->size());
+        lightIndices.clear();
+        for (int i = 0; i < int(lights->size()); i++) {
+            powers[i] = std::max(0.0, (*lights)[i]->power(sceneRadius));
+            lightIndices[(*lights)[i].get()] = i;
+        }
+        lightTable = AliasTable1D(powers.data(), int(powers.size()));
+    }
+    if (lightSampler == ELightSampler::BVH) {
+        ProfileScope profile("light bvh");
+        lightBvh = std::make_shared<LightBvh>(*lights);
+        profile.setBytes(lightBvh->memoryUsage());
+    }
+    size_t compressedAttributeBytes = 0;
+    for (const auto &meshData : compressedMeshes)
+        compressedAttributeBytes += meshData->compressionSavings();
+    if(compressedAttributeBytes > 0)
+        std::cout << "Compressed vertex attributes saved "
+                  << compressedAttributeBytes / (1024.0 * 1024.0) << " MB\n";
 }
 std::optional<Intersection> Scene::intersect(const Ray &r) const
 {
@@ -48,6 +103,25 @@ std::shared_ptr<std::vector<std::shared_ptr<Light>>> Scene::getLights() const
     return lights;
 }
 
+std::pair<std::shared_ptr<Light>, double> Scene::sampleLight(double lightSample, const Point3d &position) const
+{
+    if (lightBvh)
+        return lightBvh->sample(position, lightSample);
+    if (lightTable.Count() == 0)
+        return {nullptr, 0.0};
+    double pdf;
+    int lightID = lightTable.SampleDiscrete(lightSample, &pdf);
+    return {(*lights)[lightID], pdf};
+}
+
+double Scene::lightPdf(const Light *light, const Point3d &position) const
+{
+    if (lightBvh)
+        return lightBvh->pdf(position, light);
+    auto it = lightIndices.find(light);
+    return it == lightIndices.end() ? 0.0 : lightTable.DiscretePDF(it->second);
+}
+
 void Scene::addEntity(std::shared_ptr<Entity> object)
 {
     entities->push_back(object);
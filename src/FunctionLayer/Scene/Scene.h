@@ -12,6 +12,7 @@
 #pragma once
 
 #include <optional>
+#include <unordered_set>
 #include "nlohmann/json.hpp"
 #include "CoreLayer/Ray/Ray.h"
 #include "FunctionLayer/Shape/Entity.h"
@@ -19,7 +20,16 @@
 #include "FunctionLayer/Acceleration/Accel.h"
 #include "FunctionLayer/Intersection.h"
 #include "FunctionLayer/Light/Light.h"
+#include "FunctionLayer/Light/LightBvh.h"
 #include "FunctionLayer/Medium/Medium.h"
+#include "FunctionLayer/Distribution/Distribution.h"
+#include "ResourceLayer/File/MeshData.h"
+
+/// @brief How Scene::sampleLight picks a light.
+enum class ELightSampler {
+	POWER,	///< alias table proportional to the estimated power of each light
+	BVH		///< light BVH, proportional to the estimated contribution at the receiving point
+};
 
 /// \brief Store the primitives in scene
 class Scene
@@ -30,12 +40,18 @@ class Scene
 	std::shared_ptr<std::vector<std::shared_ptr<Entity>>> entities;
     std::unordered_map<std::string,std::shared_ptr<Material>> materials;
     std::unordered_map<std::string,std::shared_ptr<Medium>> mediums;
+    std::unordered_set<std::shared_ptr<const MeshData>> compressedMeshes;	///< Meshes with compressed attributes, counted once each
+    AliasTable1D lightTable;											///< Light selection proportional to estimated power
+    std::unordered_map<const Light *, int> lightIndices;				///< Index of each light in lightTable
+    ELightSampler lightSampler = ELightSampler::BVH;
+    std::shared_ptr<LightBvh> lightBvh;
 
 public:
 	Scene();
     Scene(const Json & json);
 	void addEntity(std::shared_ptr<Entity> object);
 	void addLight(std::shared_ptr<Light> light);
+	void addCompressedMesh(std::shared_ptr<const MeshData> meshData) { compressedMeshes.insert(meshData); }
 
 	void build();
 	std::optional<Intersection> intersect(const Ray &r) const;
@@ -50,6 +66,14 @@ public:
 
 	std::shared_ptr<std::vector<std::shared_ptr<Light>>> getLights() const;
 
+	// @brief Pick a light for a receiving point, with probability proportional to its estimated power,
+	// or its estimated contribution at that point with the light BVH.
+	// @return The light and the (discrete) probability it is picked with, {nullptr, 0} if no light is picked.
+	std::pair<std::shared_ptr<Light>, double> sampleLight(double lightSample, const Point3d &position) const;
+
+	// @brief The (discrete) probability that sampleLight picks this light for the receiving point.
+	double lightPdf(const Light *light, const Point3d &position) const;
+
     std::shared_ptr<Material> fetchMaterial(const std::string & name = "default") const;
     std::shared_ptr<Medium>   fetchMedium(const std::string & name) const;
 
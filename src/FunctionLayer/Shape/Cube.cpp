@@ -4,17 +4,15 @@
 Cube::Cube(const Json &json) : Entity(json) {
     position = matrix->getTranslate() * Point3d(.0f);
     scale = Matrix4x4::scale(0.5) * matrix->getScale();
-    rotation = matrix->getRotate();
+    rotation = AffineTransform3D(matrix->getRotate().getTransformData());
 }
 
 std::optional<Intersection> Cube::intersect(const Ray &r) const {
-    Matrix4x4 invRotation = rotation.inverse();
-
     //* ori_ is the r.origin in cube coordinate system
     //* dir_ is the r.direction in cube coordinate system 
     //* That is, rotate the ray other than the cube
-    auto ori_ = invRotation * (r.origin - position);
-    auto dir_ = invRotation * r.direction;
+    auto ori_ = rotation.inverseVector(r.origin - position);
+    auto dir_ = rotation.inverseVector(r.direction);
 
     //* Now, the cube is an axis-aligned box
     auto pMin = - (scale * Point3d(1)),
@@ -28,11 +26,11 @@ std::optional<Intersection> Cube::intersect(const Ray &r) const {
     for (int i = 0; i < 3; ++i) {
         auto invD = 1 / dir_[i];
         if (invD >= 0) {
-            tmin = std::max(tmin, (pMin[i] - ori_[i]) * invD);
-            tmax = std::min(tmax, (pMax[i] - ori_[i]) * invD);
+            tmin = std::max<double>(tmin, (pMin[i] - ori_[i]) * invD);
+            tmax = std::min<double>(tmax, (pMax[i] - ori_[i]) * invD);
         } else {
-            tmax = std::min(tmax, (pMin[i] - ori_[i]) * invD);
-            tmin = std::max(tmin, (pMax[i] - ori_[i]) * invD);
+            tmax = std::min<double>(tmax, (pMin[i] - ori_[i]) * invD);
+            tmin = std::max<double>(tmin, (pMax[i] - ori_[i]) * invD);
         }
     }
 
@@ -34,7 +34,7 @@ public:
 
 protected:
     Point3d position;
-    Matrix4x4 rotation;
+    AffineTransform3D rotation;
     Matrix4x4 scale;
 
     virtual void apply() override;
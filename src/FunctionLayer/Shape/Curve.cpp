@@ -41,7 +41,7 @@ inline Vec2d quadraticMinMax(double p0, double p1, double p2) {
         xMin = std::min(xMin, xFlat);
         xMax = std::max(xMax, xFlat);
     }
-    return {xMin, xMax};
+    return {Float(xMin), Float(xMax)};
 }
 
 static BoundingBox3f curveBox(const Vec4d &q0, const Vec4d &q1, const Vec4d &q2) {
@@ -152,12 +152,12 @@ bool pointOnSpline(Vec4d q0, Vec4d q1, Vec4d q2,
         Vec2d pMin = Vec2d(std::min(cur.p0.x, cur.p1.x), std::min(cur.p0.y, cur.p1.y));
         Vec2d pMax = Vec2d(std::max(cur.p0.x, cur.p1.x), std::max(cur.p0.y, cur.p1.y));
         if (tFlat.x > cur.tMin && tFlat.x < cur.tMax) {
-            pMin.x = std::min(pMin.x, xFlat);
-            pMax.x = std::max(pMax.x, xFlat);
+            pMin.x = std::min<double>(pMin.x, xFlat);
+            pMax.x = std::max<double>(pMax.x, xFlat);
         }
         if (tFlat.y > cur.tMin && tFlat.y < cur.tMax) {
-            pMin.y = std::min(pMin.y, yFlat);
-            pMax.y = std::max(pMax.y, yFlat);
+            pMin.y = std::min<double>(pMin.y, yFlat);
+            pMax.y = std::max<double>(pMax.y, yFlat);
         }
 
         double maxWidth = std::max(cur.p0.w, cur.p1.w);
@@ -258,7 +258,7 @@ Curve::Curve(const Json &json) : Entity(json) {
     _overrideThickness = containsAndGet(json, "curve_thickness", _curveThickness);
     bool tapper = getOptional(json, "curve_taper", false);
     if (_overrideThickness || tapper) {
-        for (int i = 0; i < _curveCount; ++i) {
+        for (size_t i = 0; i < _curveCount; ++i) {
             int start = i ? _curveEnds[i - 1] : 0;
             for (int t = start; t < _curveEnds[i]; ++t) {
                 double thickness = _overrideThickness ? _curveThickness : _nodeData[t].w;
@@ -272,7 +272,7 @@ Curve::Curve(const Json &json) : Entity(json) {
     double transformMatrix[] = {0, 0, 0.1, 0, 0.13, 0, 0, 0, 0, 0.1, 0, 0, 0, 9.4, 0, 1};
     matrix = std::make_shared<TransformMatrix3D>(transformMatrix);
 
-    for (int i = 0; i < _nodeData.size(); i++) {
+    for (size_t i = 0; i < _nodeData.size(); i++) {
         Point3d newP = matrix->operator*(Point3d(_nodeData[i].x, _nodeData[i].y, _nodeData[i].z));
         _nodeData[i].x = newP.x;
         _nodeData[i].y = newP.y;
@@ -287,7 +287,7 @@ Curve::Curve(const Json &json) : Entity(json) {
         if (i > 0) {
             start = _curveEnds[i - 1];
         }
-        for (std::uint32_t t = start + 2; t < _curveEnds[i]; ++t) {
+        for (std::uint32_t t = start + 2; t < std::uint32_t(_curveEnds[i]); ++t) {
             curveSegments.emplace_back(std::make_shared<CurveSegment>(&_nodeData, t));
         }
     }
@@ -27,6 +27,21 @@ void Entity::setMaterial(std::shared_ptr<Material> _material) {
     this->material = _material;
 }
 
+Intersection Entity::sampleSolidAngle(const Point3d &ref, const Point2d &positionSample, double *pdf) const {
+    Intersection its = sample(positionSample);
+    *pdf = pdfSolidAngle(ref, its);
+    return its;
+}
+
+double Entity::pdfSolidAngle(const Point3d &ref, const Intersection &its) const {
+    Vec3d d = its.position - ref;
+    double dist2 = d.length2();
+    if (dist2 == 0)
+        return 0;
+    double cosTheta = std::abs(dot(d, its.geometryNormal)) / std::sqrt(dist2);
+    return cosTheta > 0 ? dist2 / (area() * cosTheta) : 0;
+}
+
 void rtcEntityBoundsFunc(const RTCBoundsFunctionArguments *args) {
     Entity *entity = static_cast<Entity *>(args->geometryUserPtr);
     RTCBounds *bounds = args->bounds_o;
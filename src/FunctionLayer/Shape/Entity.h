@@ -57,6 +57,17 @@ public:
 	
 	virtual BoundingBox3f WorldBound() const = 0;
 
+	//* Axis and cosine of the half angle of a cone containing every geometric normal, for bounding light emission.
+	//* The whole sphere unless the shape knows better.
+	virtual std::pair<Vec3d, double> normalCone() const { return {Vec3d(0, 0, 1), -1}; }
+
+	//* Sample a point of the shape as seen from ref, with *pdf set to the solid angle density at ref.
+	//* The area sample converted to solid angle unless the shape can sample the solid angle it subtends.
+	virtual Intersection sampleSolidAngle(const Point3d &ref, const Point2d &positionSample, double *pdf) const;
+
+	//* Solid angle density at ref of sampleSolidAngle choosing its, a point of the shape visible from ref.
+	virtual double pdfSolidAngle(const Point3d &ref, const Intersection &its) const;
+
 protected:
 
 	std::shared_ptr<Light> light;
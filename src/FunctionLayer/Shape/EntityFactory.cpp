@@ -2,6 +2,7 @@
 #include "Quad.h"
 #include "Sphere.h"
 #include "Mesh.h"
+#include "ProxyMesh.h"
 #include "Cube.h"
 #include "Curve.h"
 #include "FunctionLayer/Scene/Scene.h"
@@ -26,12 +27,28 @@ bool handleEntity(std::string type, const Json &json, Scene &scene,
     if (type == "sphere") entity = std::make_shared<Sphere>(json);
     if (type == "cube") entity = std::make_shared<Cube>(json);
     if (type == "curves") entity = std::make_shared<Curve>(json);
-    if (type == "mesh") {
+    if (type == "mesh" && getOptional(json, "out_of_core", false)) {
+        if (json.contains("emission"))
+            std::cerr << "Out-of-core meshes can not be emitters, loading " << std::string(json["file"])
+                      << " in core" << std::endl;
+        else
+            entity = std::make_shared<ProxyMesh>(FileUtils::getWorkingDir() + std::string(json["file"]),
+                                                 scene.fetchMaterial(getOptional(json, "material", std::string("default"))),
+                                                 json);
+    }
+    if (type == "mesh" && !entity) {
         auto meshDataPath = FileUtils::getWorkingDir() + std::string(json["file"]);
+        bool compressAttributes = getOptional(json, "compress_attributes", false);
+        EUVEncoding uvEncoding = getOptional(json, "uv_encoding", std::string("half")) == "unorm16"
+                                     ? EUVEncoding::Unorm16 : EUVEncoding::Half;
         // for convenience. won't cost much cuz meshDataList not actually contains data.
-        auto meshDataList = *(MeshDataManager::getInstance()->getMeshData(meshDataPath));
+        auto meshDataList = compressAttributes
+                                ? *(MeshDataManager::getInstance()->getCompressedMeshData(meshDataPath, uvEncoding))
+                                : *(MeshDataManager::getInstance()->getMeshData(meshDataPath));
         entityCount = meshDataList.size();
         for (auto meshData : meshDataList) {
+            if (compressAttributes)
+                scene.addCompressedMesh(meshData.second);
             auto material = scene.fetchMaterial(getOptional(json,
                                                             "material", std::string("default")));
             entities.push_back(std::make_shared<Mesh>(meshData.second, material, json));
@@ -1,23 +1,33 @@
 #include "Mesh.h"
 
 #include <utility>
+#include <mutex>
 #include "FunctionLayer/Intersection.h"
-using MeshMap = std::unordered_map<const MeshData *,std::shared_ptr<TraceableMesh>>;
+//* weak references, so that meshes released by out-of-core proxies actually free their memory
+using MeshMap = std::unordered_map<const MeshData *,std::weak_ptr<TraceableMesh>>;
 RTCRay toRTCRay(const Ray &ray);
 
+//* the winding of a triangle may disagree with its vertex normals, keep the face normal on their side
+static Normal3d orientFaceNormal(const Normal3d &faceNormal, const Normal3d &shadingNormal) {
+    return dot(faceNormal, shadingNormal) < 0 ? Normal3d(-faceNormal) : faceNormal;
+}
+
 class TraceableMesh {
 public:
     std::shared_ptr<const MeshData> data;
     RTCGeometry geometry;
     RTCScene instanceScene = nullptr ;
     RTCScene scene = nullptr;
-    const Eigen::MatrixXd normals;
 public:
-    TraceableMesh( const std::shared_ptr<const  MeshData>& data) :normals(data->m_normals){
+    TraceableMesh( const std::shared_ptr<const  MeshData>& data) {
         this->data =  std::make_shared<MeshData>(*data);
 
     }
+    ~TraceableMesh(){
+        if(scene) rtcReleaseScene(scene);
+    }
     void initEmbree(RTCDevice device){
+        std::lock_guard<std::mutex> lock(embreeMutex);
         if(scene) return;
         RTCGeometry geom = rtcNewGeometry(device, RTC_GEOMETRY_TYPE_TRIANGLE);
         float *vertices = (float *)rtcSetNewGeometryBuffer(
@@ -38,7 +48,7 @@ public:
             RTC_FORMAT_UINT3, 3 * sizeof(unsigned),
             data->m_indices.size());
         //* brute-force copy
-        for (int i = 0; i < data->m_indices.size(); ++i) {
+        for (size_t i = 0; i < data->m_indices.size(); ++i) {
             auto [i0, i1, i2] = data->m_indices[i];
             indices[i * 3 + 0] = i0;
             indices[i * 3 + 1] = i1;
@@ -51,13 +61,15 @@ public:
         rtcCommitScene(scene);
     }
     static std::shared_ptr<TraceableMesh> getTraceableMesh(std::shared_ptr<const MeshData> meshData){
+        std::lock_guard<std::mutex> lock(mapMutex);
         if(map.count(meshData.get()))
-            return map.at(meshData.get());
+            if(auto traceableMesh = map.at(meshData.get()).lock())
+                return traceableMesh;
         auto traceableMesh = std::make_shared<TraceableMesh>(meshData);
         map[meshData.get()] = traceableMesh;
         return traceableMesh;
     }
-    std::optional<Intersection> intersect(const Ray & ray,std::shared_ptr< TransformMatrix3D> transform ){
+    std::optional<Intersection> intersect(const Ray & ray,const AffineTransform3D & transform ){
         RTCRayHit rayhit;
         rayhit.ray= toRTCRay(ray);
         rayhit.hit.geomID = RTC_INVALID_GEOMETRY_ID;
@@ -75,19 +87,34 @@ public:
         auto p0 = eigenToPoint3d(data->m_vertices.col(i0)),
              p1 = eigenToPoint3d(data->m_vertices.col(i1)),
              p2 = eigenToPoint3d(data->m_vertices.col(i2));
-        auto n0 = eigenToVector3d(data->m_normals.col(i0)),
-             n1 = eigenToVector3d(data->m_normals.col(i1)),
-             n2 = eigenToVector3d(data->m_normals.col(i2));
-        auto uv0 = data->m_UVs[i0],
-             uv1 = data->m_UVs[i1],
-             uv2 = data->m_UVs[i2];
+        auto uv0 = data->getUV(i0),
+             uv1 = data->getUV(i1),
+             uv2 = data->getUV(i2);
 
         Point3d position = (1 - u - v) * p0 + u * p1 + v * p2;
-        Normal3d normal = (1 - u - v) * n0 + u * n1 + v * n2;
+        //* geometryNormal is the face normal, the interpolated vertex normal only shades
+        Normal3d faceNormal = cross(p1 - p0, p2 - p0);
+        Normal3d normal = faceNormal;
+        if (data->hasNormals()) {
+            //* decodes on the fly when the attributes are compressed
+            normal = (1 - u - v) * data->getNormal(i0) + u * data->getNormal(i1) + v * data->getNormal(i2);
+        }
         Point2d uv = (1 - u - v) * uv0 + u * uv1 + v * uv2;
 
-        position = transform->operator*(position);
-        normal = transform->operator*(normal);
+        //* position derivatives w.r.t. uv, needed to turn ray differentials into uv footprints
+        Vec3d dpdu(0.0), dpdv(0.0);
+        Vec3d dp02 = p0 - p2, dp12 = p1 - p2;
+        Vec2d duv02 = uv0 - uv2, duv12 = uv1 - uv2;
+        double determinant = duv02.x * duv12.y - duv02.y * duv12.x;
+        if (std::abs(determinant) > 1e-12) {
+            double invDet = 1 / determinant;
+            dpdu = (duv12.y * dp02 - duv02.y * dp12) * invDet;
+            dpdv = (-duv12.x * dp02 + duv02.x * dp12) * invDet;
+        }
+
+        position = transform * position;
+        normal = transform * normal;
+        faceNormal = orientFaceNormal(transform * faceNormal, normal);
         auto val = reinterpret_cast<uintptr_t>(data.get());
         unsigned char r = (val >> 16) & 0xFF;
         unsigned char g = (val >> 8) & 0xFF;
@@ -97,16 +124,21 @@ public:
         Intersection its;
         its.t = rayhit.ray.tfar;
         its.position = position;
-        its.geometryNormal = normal;
+        its.geometryNormal = faceNormal;
         its.shFrame = Frame{normal};
         its.uv = uv;
+        its.dpdu = transform * dpdu;
+        its.dpdv = transform * dpdv;
         return std::make_optional(its);
     }
 private:
+    std::mutex embreeMutex;
     static MeshMap map;
+    static std::mutex mapMutex;
 };
 
 MeshMap  TraceableMesh::map = MeshMap();
+std::mutex TraceableMesh::mapMutex;
 
 Mesh::Mesh(std::shared_ptr<MeshData> _data,
            std::shared_ptr<Material> _material,
@@ -115,7 +147,7 @@ Mesh::Mesh(std::shared_ptr<MeshData> _data,
                                m_vertices(_data->m_vertices),
                                meshData(TraceableMesh::getTraceableMesh(_data))
                               {
-    inverseMatrix = std::make_shared<TransformMatrix3D>(matrix->getInverse());
+    toWorld = matrix->getAffine();
     this->material = _material;
     auto maxX = meshData->data->m_vertices.row(0).maxCoeff(),
          minX = meshData->data->m_vertices.row(0).minCoeff(),
@@ -128,17 +160,32 @@ Mesh::Mesh(std::shared_ptr<MeshData> _data,
         vertices[i].x = (i & 4)?minX:maxX;
         vertices[i].y = (i & 2)?minY:maxY;
         vertices[i].z = (i & 1)?minZ:maxZ;
-        vertices[i] = matrix ->operator*( vertices[i]);
-        minX = std::min(minX,vertices[i].x);
-        minY = std::min(minY,vertices[i].y);
-        minZ = std::min(minZ,vertices[i].z);
-        maxX = std::max(maxX,vertices[i].x);
-        maxY = std::max(maxY,vertices[i].y);
-        maxZ = std::max(maxZ,vertices[i].z);
+        vertices[i] = toWorld * vertices[i];
+        minX = std::min<double>(minX,vertices[i].x);
+        minY = std::min<double>(minY,vertices[i].y);
+        minZ = std::min<double>(minZ,vertices[i].z);
+        maxX = std::max<double>(maxX,vertices[i].x);
+        maxY = std::max<double>(maxY,vertices[i].y);
+        maxZ = std::max<double>(maxZ,vertices[i].z);
     }
     m_aabb =  BoundingBox3f{
-                Point3d{minX, minY, minZ},
-               Point3d{maxX, maxY, maxZ}};
+                Point3d{Float(minX), Float(minY), Float(minZ)},
+               Point3d{Float(maxX), Float(maxY), Float(maxZ)}};
+
+    //* per-triangle world space area, used by area() and sample()
+    const auto & indices = meshData->data->m_indices;
+    std::vector<double> areas(indices.size());
+    for (size_t i = 0; i < indices.size(); i++) {
+        auto [i0, i1, i2] = indices[i];
+        auto p0 = toWorld * eigenToPoint3d(meshData->data->m_vertices.col(i0)),
+             p1 = toWorld * eigenToPoint3d(meshData->data->m_vertices.col(i1)),
+             p2 = toWorld * eigenToPoint3d(meshData->data->m_vertices.col(i2));
+        areas[i] = 0.5 * cross(p1 - p0, p2 - p0).length();
+    }
+    if (!areas.empty()) {
+        m_triangleTable = AliasTable1D(areas.data(), areas.size());
+        m_area = m_triangleTable.funcInt;
+    }
 }
 
 Triangle Mesh::getTriangle(int idx) const {
@@ -153,15 +200,16 @@ Triangle Mesh::getTriangle(int idx) const {
     return Triangle{vertices, material};
 }
 
-Ray getInverseRay(const Ray & ray,std::shared_ptr<TransformMatrix3D> inverseMatrix){
-    Point3d  convertOrigin = inverseMatrix->operator*(ray.origin);
-    Vec3d convertDir=  normalize(inverseMatrix->operator*(ray.direction));// normalize((inverse(M) * make_vec4(D, 0)).xyz);
+//* the direction is left unnormalized, so that the hit distance is also the distance along the world space ray
+Ray getInverseRay(const Ray & ray,const AffineTransform3D & toWorld){
+    Point3d  convertOrigin = toWorld.inversePoint(ray.origin);
+    Vec3d convertDir = toWorld.inverseVector(ray.direction);
     return {convertOrigin,convertDir,ray.timeMin,ray.timeMax};
 }
 
 std::optional<Intersection> Mesh::intersect(const Ray &r) const {
-    Ray ray = getInverseRay(r,inverseMatrix);
-    auto its =  meshData->intersect(ray,matrix);
+    Ray ray = getInverseRay(r,toWorld);
+    auto its =  meshData->intersect(ray,toWorld);
     if(its) {
         its->object = this;
         its->material = material;
@@ -174,13 +222,42 @@ void Mesh::apply() {
 }
 
 double Mesh::area() const {
-    // TODO
-    return 0;
+    return m_area;
 }
 
+//* Pick a triangle by area with the alias table, then reuse the remapped sample to pick a uniform point in it.
+//* The resulting density is 1 / area() over the whole mesh.
 Intersection Mesh::sample(const Point2d &positionSample) const {
-    // TODO
-    return Intersection();
+    Intersection its;
+    if (m_triangleTable.Count() == 0)
+        return its;
+    double remapped;
+    int primID = m_triangleTable.SampleDiscrete(positionSample.x, nullptr, &remapped);
+    double su = std::sqrt(remapped);
+    double u = positionSample.y * su,
+           v = 1 - su;
+    const auto & data = meshData->data;
+    auto [i0, i1, i2] = data->m_indices[primID];
+    auto p0 = toWorld * eigenToPoint3d(data->m_vertices.col(i0)),
+         p1 = toWorld * eigenToPoint3d(data->m_vertices.col(i1)),
+         p2 = toWorld * eigenToPoint3d(data->m_vertices.col(i2));
+    its.position = (1 - u - v) * p0 + u * p1 + v * p2;
+    //* the face normal, as intersect() reports it: pdfSolidAngle needs the cosine to the actual surface
+    Normal3d normal = cross(p1 - p0, p2 - p0);
+    if (data->hasNormals()) {
+        Normal3d shadingNormal = (1 - u - v) * data->getNormal(i0) + u * data->getNormal(i1) + v * data->getNormal(i2);
+        shadingNormal = toWorld * shadingNormal;
+        normal = orientFaceNormal(normal, shadingNormal);
+        its.shFrame = Frame(shadingNormal);
+    } else {
+        its.shFrame = Frame(normal);
+    }
+    its.geometryNormal = normal;
+    if (data->hasUVs())
+        its.uv = (1 - u - v) * data->getUV(i0) + u * data->getUV(i1) + v * data->getUV(i2);
+    its.object = this;
+    its.material = material;
+    return its;
 }
 
 BoundingBox3f Mesh::WorldBound() const {
@@ -188,10 +265,23 @@ BoundingBox3f Mesh::WorldBound() const {
 }
 
 RTCGeometry Mesh::toEmbreeGeometry(RTCDevice device) const {
-    meshData->initEmbree(device);
+    buildBLAS(device);
     return Entity::toEmbreeGeometry(device);
 }
 
+void Mesh::buildBLAS(RTCDevice device) const {
+    meshData->initEmbree(device);
+}
+
+size_t Mesh::memoryUsage() const {
+    //* the traceable copy, the unused copies kept by Mesh, and embree's vertex/index buffers plus a rough bvh estimate
+    size_t triangles = meshData->data->m_indices.size(),
+           vertices = meshData->data->m_vertices.cols();
+    return meshData->data->memoryUsage() +
+           m_vertices.size() * sizeof(double) + m_indices.size() * sizeof(Point3i) +
+           vertices * 3 * sizeof(float) + triangles * (3 * sizeof(unsigned) + 64);
+}
+
 std::optional<Intersection> Mesh::getIntersectionFromRayHit(const UserRayHit1 &rayhit) const {
     return Entity::getIntersectionFromRayHit(rayhit);
 
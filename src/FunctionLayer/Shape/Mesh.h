@@ -17,6 +17,7 @@
 #include "Triangle.h"
 #include "ResourceLayer/File/MeshData.h"
 #include "FunctionLayer/Acceleration/Bvh.h"
+#include "FunctionLayer/Distribution/Distribution.h"
 
 class TraceableMesh;
 //! Only triangle mesh
@@ -43,13 +44,26 @@ public:
 
     virtual RTCGeometry toEmbreeGeometry(RTCDevice device) const override;
 
+    /// @brief build the per-mesh embree scene, safe to call lazily from render threads.
+    void buildBLAS(RTCDevice device) const;
+
+    /// @brief approximate resident bytes of this mesh, including its embree structures.
+    size_t memoryUsage() const;
+
     virtual std::optional<Intersection> getIntersectionFromRayHit(const UserRayHit1 &rayhit) const override;
 
 protected:
     std::shared_ptr<TraceableMesh> meshData;
-    std::shared_ptr<TransformMatrix3D> inverseMatrix;
+    /// @brief object to world, rays are brought to object space with its inverse.
+    AffineTransform3D toWorld;
     BoundingBox3f m_aabb;
 
+    /// @brief world space surface area, cached at load time.
+    double m_area = 0;
+    /// @brief triangles picked proportional to their world space area.
+    /// An emitter has uniform radiance over the mesh, so this is also proportional to emitted power.
+    AliasTable1D m_triangleTable;
+
     //not used
     Eigen::MatrixXd m_vertices;
     std::vector<Point3i> m_indices;
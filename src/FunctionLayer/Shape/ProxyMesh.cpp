@@ -0,0 +1,164 @@
+/**
+ * @file ProxyMesh.cpp
+ * @author agent
+ * @brief Out-of-core mesh implementation
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ *
+ */
+
+#include "ProxyMesh.h"
+#include "Mesh.h"
+#include "FunctionLayer/Intersection.h"
+#include "ResourceLayer/ResourceManager.h"
+
+std::shared_ptr<OutOfCoreCache> OutOfCoreCache::instance = nullptr;
+
+std::shared_ptr<OutOfCoreCache> OutOfCoreCache::getInstance() {
+    if (!instance)
+        instance.reset(new OutOfCoreCache());
+    return instance;
+}
+
+void OutOfCoreCache::pushFront(const ProxyMesh *proxy) {
+    const ProxyMesh *first = head.load(std::memory_order_relaxed);
+    proxy->lruPrev = nullptr;
+    proxy->lruNext = first;
+    if (first)
+        first->lruPrev = proxy;
+    else
+        tail = proxy;
+    head.store(proxy, std::memory_order_relaxed);
+}
+
+void OutOfCoreCache::unlink(const ProxyMesh *proxy) {
+    if (proxy->lruPrev)
+        proxy->lruPrev->lruNext = proxy->lruNext;
+    else
+        head.store(proxy->lruNext, std::memory_order_relaxed);
+    if (proxy->lruNext)
+        proxy->lruNext->lruPrev = proxy->lruPrev;
+    else
+        tail = proxy->lruPrev;
+    proxy->lruPrev = proxy->lruNext = nullptr;
+}
+
+void OutOfCoreCache::onLoaded(const ProxyMesh *proxy, size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pushFront(proxy);
+    proxy->lruBytes = bytes;
+    proxy->lruListed = true;
+    residentBytes += bytes;
+    //* never evict the mesh that was just loaded, the calling ray needs it
+    while (residentBytes > budget && tail != proxy) {
+        const ProxyMesh *victim = tail;
+        unlink(victim);
+        victim->lruListed = false;
+        victim->evict();
+        residentBytes -= victim->lruBytes;
+    }
+}
+
+void OutOfCoreCache::touch(const ProxyMesh *proxy) {
+    if (head.load(std::memory_order_relaxed) == proxy)
+        return;
+    std::lock_guard<std::mutex> lock(mutex);
+    //* evicted meanwhile, the next acquire reloads and lists it again
+    if (!proxy->lruListed)
+        return;
+    unlink(proxy);
+    pushFront(proxy);
+}
+
+ProxyMesh::ProxyMesh(const std::string &_path, std::shared_ptr<Material> _material, const Json &_json)
+    : Entity(_json), path(_path), json(_json) {
+    material = _material;
+    if (json.contains("bound")) {
+        //* object space bound given in the scene file, nothing is loaded until rendering
+        auto pMin = json.at("bound").at("min").get<Point3d>(),
+             pMax = json.at("bound").at("max").get<Point3d>();
+        for (int i = 0; i < 8; i++) {
+            Point3d corner((i & 4) ? pMin.x : pMax.x,
+                           (i & 2) ? pMin.y : pMax.y,
+                           (i & 1) ? pMin.z : pMax.z);
+            m_aabb = BoundingBoxPointUnion(m_aabb, matrix->operator*(corner));
+        }
+    } else {
+        //* load once to find the bound, then release it
+        for (const auto &mesh : *load())
+            m_aabb = BoundingBoxUnion(m_aabb, mesh->WorldBound());
+    }
+}
+
+std::shared_ptr<const ProxyMesh::MeshList> ProxyMesh::load() const {
+    auto meshDataList = MeshDataManager::getInstance()->loadMeshData(path);
+    auto meshes = std::make_shared<MeshList>();
+    for (const auto &meshData : *meshDataList)
+        meshes->push_back(std::make_shared<Mesh>(meshData.second, material, json));
+    return meshes;
+}
+
+std::shared_ptr<const ProxyMesh::MeshList> ProxyMesh::acquire() const {
+    auto meshes = std::atomic_load(&resident);
+    if (meshes) {
+        OutOfCoreCache::getInstance()->touch(this);
+        return meshes;
+    }
+
+    std::lock_guard<std::mutex> lock(loadMutex);
+    meshes = std::atomic_load(&resident);
+    if (meshes) return meshes;
+    auto loaded = load();
+    size_t bytes = 0;
+    for (const auto &mesh : *loaded) {
+        mesh->buildBLAS(device);
+        bytes += mesh->memoryUsage();
+    }
+    std::atomic_store(&resident, loaded);
+    OutOfCoreCache::getInstance()->onLoaded(this, bytes);
+    return loaded;
+}
+
+//* Rays still holding the old list keep it alive until they finish.
+void ProxyMesh::evict() const {
+    std::atomic_store(&resident, std::shared_ptr<const MeshList>());
+}
+
+std::optional<Intersection> ProxyMesh::intersect(const Ray &r) const {
+    auto meshes = acquire();
+    std::optional<Intersection> closest;
+    Ray ray = r;
+    for (const auto &mesh : *meshes) {
+        auto its = mesh->intersect(ray);
+        if (its && (!closest || its->t < closest->t)) {
+            closest = its;
+            ray.timeMax = its->t;
+        }
+    }
+    //* the inner mesh may be evicted while the intersection is in use
+    if (closest) closest->object = this;
+    return closest;
+}
+
+double ProxyMesh::area() const {
+    return 0;
+}
+
+Intersection ProxyMesh::sample(const Point2d &positionSample) const {
+    return Intersection();
+}
+
+BoundingBox3f ProxyMesh::WorldBound() const {
+    return m_aabb;
+}
+
+RTCGeometry ProxyMesh::toEmbreeGeometry(RTCDevice _device) const {
+    device = _device;
+    return Entity::toEmbreeGeometry(_device);
+}
+
+void ProxyMesh::apply() {
+}
@@ -0,0 +1,104 @@
+/**
+ * @file ProxyMesh.h
+ * @author agent
+ * @brief Out-of-core triangle mesh. Only its bounding box stays resident, the geometry
+ *        is loaded on the first ray that reaches it and evicted under a memory budget.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "Entity.h"
+
+class Mesh;
+class ProxyMesh;
+
+/// @brief Tracks resident out-of-core meshes and evicts the least recently used ones
+/// when their total size exceeds the budget. Resident proxies form an intrusive list,
+/// most recently used first, so eviction takes the tail without scanning.
+class OutOfCoreCache {
+    static std::shared_ptr<OutOfCoreCache> instance;
+
+public:
+    // @brief singleton pattern get.
+    static std::shared_ptr<OutOfCoreCache> getInstance();
+
+    void setBudget(size_t bytes) { budget = bytes; }
+
+    size_t getBudget() const { return budget; }
+
+    size_t getResidentBytes() const { return residentBytes; }
+
+    /// @brief register a freshly loaded proxy and evict others if over budget.
+    void onLoaded(const ProxyMesh *proxy, size_t bytes);
+
+    /// @brief move a resident proxy to the front of the list.
+    void touch(const ProxyMesh *proxy);
+
+private:
+    void pushFront(const ProxyMesh *proxy);
+
+    void unlink(const ProxyMesh *proxy);
+
+    std::mutex mutex;
+    //* read without the lock to skip touching the proxy that is already the most recent
+    std::atomic<const ProxyMesh *> head{nullptr};
+    const ProxyMesh *tail = nullptr;
+    size_t budget = size_t(8) << 30;
+    size_t residentBytes = 0;
+};
+
+/// @brief Entity standing in for a mesh file that is not kept in memory.
+/// Emission is not supported on proxies, since light sampling would keep them resident anyway.
+class ProxyMesh : public Entity {
+public:
+    friend class OutOfCoreCache;
+
+    ProxyMesh(const std::string &path, std::shared_ptr<Material> _material, const Json &json);
+
+    virtual std::optional<Intersection> intersect(const Ray &r) const override;
+
+    //* Geometry is not resident, so proxies cannot be sampled.
+    virtual double area() const override;
+
+    virtual Intersection sample(const Point2d &positionSample) const override;
+
+    virtual BoundingBox3f WorldBound() const override;
+
+    virtual RTCGeometry toEmbreeGeometry(RTCDevice device) const override;
+
+protected:
+    virtual void apply() override;
+
+private:
+    using MeshList = std::vector<std::shared_ptr<Mesh>>;
+
+    /// @brief load the mesh file and build the per-mesh embree scenes.
+    std::shared_ptr<const MeshList> load() const;
+
+    /// @brief return the resident meshes, loading them if necessary.
+    std::shared_ptr<const MeshList> acquire() const;
+
+    void evict() const;
+
+    std::string path;
+    Json json;
+    BoundingBox3f m_aabb;
+
+    mutable RTCDevice device = nullptr;
+    mutable std::shared_ptr<const MeshList> resident;
+    mutable std::mutex loadMutex;
+
+    //* links and size in the OutOfCoreCache list, guarded by its mutex
+    mutable const ProxyMesh *lruPrev = nullptr, *lruNext = nullptr;
+    mutable size_t lruBytes = 0;
+    mutable bool lruListed = false;
+};
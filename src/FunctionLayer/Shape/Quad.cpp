@@ -45,6 +45,8 @@ std::optional<Intersection> Quad::intersect(const Ray &r) const {
     ans.shFrame = Frame(n);
     ans.uv.x = l0;
     ans.uv.y = l1;
+    ans.dpdu = _edge0;
+    ans.dpdv = _edge1;
     ans.object = this;
 
     return std::make_optional(ans);
@@ -72,6 +74,86 @@ BoundingBox3f Quad::WorldBound() const {
     return bb;
 }
 
+std::pair<Vec3d, double> Quad::normalCone() const {
+    return {normalize(cross(_edge1, _edge0)), 1};
+}
+
+//* Spherical rectangle sampling, Urena et al. 2013,
+//* "An Area-Preserving Parametrization for Spherical Rectangles".
+struct SphericalQuad {
+    Point3d o;
+    Vec3d x, y, z;
+    double z0, x0, y0, x1, y1, b0, b1, k, S;
+
+    SphericalQuad(const Point3d &ref, const Point3d &base, const Vec3d &edge0, const Vec3d &edge1) : o(ref) {
+        double exl = edge0.length(), eyl = edge1.length();
+        x = edge0 / exl;
+        y = edge1 / eyl;
+        z = cross(x, y);
+        Vec3d d = base - ref;
+        z0 = dot(d, z);
+        //* flip z to make it point against the rectangle
+        if (z0 > 0) {
+            z *= -1;
+            z0 *= -1;
+        }
+        x0 = dot(d, x);
+        y0 = dot(d, y);
+        x1 = x0 + exl;
+        y1 = y0 + eyl;
+        Vec3d v00(x0, y0, z0), v01(x0, y1, z0), v10(x1, y0, z0), v11(x1, y1, z0);
+        Vec3d n0 = normalize(cross(v00, v10)), n1 = normalize(cross(v10, v11));
+        Vec3d n2 = normalize(cross(v11, v01)), n3 = normalize(cross(v01, v00));
+        double g0 = std::acos(clamp(-dot(n0, n1), -1.0, 1.0)), g1 = std::acos(clamp(-dot(n1, n2), -1.0, 1.0));
+        double g2 = std::acos(clamp(-dot(n2, n3), -1.0, 1.0)), g3 = std::acos(clamp(-dot(n3, n0), -1.0, 1.0));
+        b0 = n0.z;
+        b1 = n2.z;
+        k = 2 * M_PI - g2 - g3;
+        //* solid angle of the rectangle
+        S = g0 + g1 - k;
+    }
+
+    Point3d sample(const Point2d &u) const {
+        //* x of the sample from the first coordinate
+        double au = u.x * S + k;
+        double fu = (std::cos(au) * b0 - b1) / std::sin(au);
+        double cu = clamp((fu > 0 ? 1 : -1) / std::sqrt(fu * fu + b0 * b0), -1.0, 1.0);
+        double xu = clamp(-(cu * z0) / std::sqrt(std::max(0.0, 1 - cu * cu)), x0, x1);
+        //* then y along the segment at xu
+        double d = std::sqrt(xu * xu + z0 * z0);
+        double h0 = y0 / std::sqrt(d * d + y0 * y0), h1 = y1 / std::sqrt(d * d + y1 * y1);
+        double hv = h0 + u.y * (h1 - h0), hv2 = hv * hv;
+        double yv = hv2 < 1 - 1e-6 ? (hv * d) / std::sqrt(1 - hv2) : y1;
+        return o + x * xu + y * yv + z * z0;
+    }
+};
+
+//* Tiny solid angles lose precision and a sheared quad is no rectangle, both keep the area sampling.
+static bool useSphericalSampling(const Vec3d &edge0, const Vec3d &edge1, const SphericalQuad &quad) {
+    return std::abs(dot(edge0, edge1)) <= 1e-6 * edge0.length() * edge1.length() &&
+           std::isfinite(quad.S) && quad.S > 1e-4;
+}
+
+Intersection Quad::sampleSolidAngle(const Point3d &ref, const Point2d &positionSample, double *pdf) const {
+    SphericalQuad quad(ref, _base, _edge0, _edge1);
+    if (!useSphericalSampling(_edge0, _edge1, quad))
+        return Entity::sampleSolidAngle(ref, positionSample, pdf);
+
+    Point3d position = quad.sample(positionSample);
+    Vec3d v = position - _base;
+    Intersection its = sample(Point2d(clamp(dot(v, _edge0) * _invSq.x, 0.0, 1.0),
+                                      clamp(dot(v, _edge1) * _invSq.y, 0.0, 1.0)));
+    *pdf = 1 / quad.S;
+    return its;
+}
+
+double Quad::pdfSolidAngle(const Point3d &ref, const Intersection &its) const {
+    SphericalQuad quad(ref, _base, _edge0, _edge1);
+    if (!useSphericalSampling(_edge0, _edge1, quad))
+        return Entity::pdfSolidAngle(ref, its);
+    return 1 / quad.S;
+}
+
 void Quad::apply() {
 
     //    _base = matrix->operator *(_base);
@@ -28,6 +28,12 @@ public:
 
     virtual BoundingBox3f WorldBound() const override;
 
+    virtual std::pair<Vec3d, double> normalCone() const override;
+
+    virtual Intersection sampleSolidAngle(const Point3d &ref, const Point2d &positionSample, double *pdf) const override;
+
+    virtual double pdfSolidAngle(const Point3d &ref, const Intersection &its) const override;
+
 protected:
     Point3d  _base;
     Vec3d _edge0,_edge1;
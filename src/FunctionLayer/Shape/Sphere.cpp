@@ -80,7 +80,7 @@ double Sphere::area() const {
 
 Intersection Sphere::sample(const Point2d &positionSample) const {
     Intersection ans;
-    Polar3d polar = Polar3d(1.0, Angle(positionSample.x * 2 * M_PI, Angle::EAngleType::ANGLE_RAD), Angle(acos(positionSample.y * 2.0 - 1.0), Angle::EAngleType::ANGLE_RAD));
+    Polar3d polar = Polar3d(1.0, Angle(positionSample.x * 2 * M_PI, Angle::EAngleType::ANGLE_RAD), Angle(asin(positionSample.y * 2.0 - 1.0), Angle::EAngleType::ANGLE_RAD));
     Vec3d v = polar.toVec3d();
     ans.position = center + v * radius;
     ans.geometryNormal = v;
@@ -91,6 +91,49 @@ Intersection Sphere::sample(const Point2d &positionSample) const {
     return ans;
 }
 
+//* 1 - cos of the half angle of the cone from ref around the sphere, 0 when ref is inside
+static double oneMinusCosThetaMax(const Point3d &ref, const Point3d &center, double radius) {
+    double dc2 = (center - ref).length2();
+    if (dc2 <= radius * radius)
+        return 0;
+    double sin2ThetaMax = radius * radius / dc2;
+    //* small cones lose 1 - cos to cancellation, use its Taylor expansion
+    return sin2ThetaMax < 0.00068523 ? sin2ThetaMax / 2 : 1 - std::sqrt(1 - sin2ThetaMax);
+}
+
+Intersection Sphere::sampleSolidAngle(const Point3d &ref, const Point2d &positionSample, double *pdf) const {
+    double coneWidth = oneMinusCosThetaMax(ref, center, radius);
+    if (coneWidth <= 0)
+        return Entity::sampleSolidAngle(ref, positionSample, pdf);
+
+    //* direction uniform in the cone, then the point of the sphere it hits first
+    double dc = (center - ref).length();
+    double cosTheta = 1 - positionSample.x * coneWidth;
+    double sin2Theta = std::max(0.0, 1 - cosTheta * cosTheta);
+    double ds = dc * cosTheta - std::sqrt(std::max(0.0, radius * radius - dc * dc * sin2Theta));
+    double cosAlpha = clamp((dc * dc + radius * radius - ds * ds) / (2 * dc * radius), -1.0, 1.0);
+    double sinAlpha = std::sqrt(std::max(0.0, 1 - cosAlpha * cosAlpha));
+    double phi = positionSample.y * 2 * M_PI;
+
+    Frame frame(normalize(ref - center));
+    Vec3d n = frame.toWorld(Vec3d(sinAlpha * std::cos(phi), sinAlpha * std::sin(phi), cosAlpha));
+    Intersection ans;
+    ans.position = center + n * radius;
+    ans.geometryNormal = n;
+    ans.geometryTangent = normalize(Vec3d(n.z, 0, -n.x));
+    ans.geometryBitangent = normalize(cross(n, ans.geometryTangent));
+    ans.material = material;
+    *pdf = 1 / (2 * M_PI * coneWidth);
+    return ans;
+}
+
+double Sphere::pdfSolidAngle(const Point3d &ref, const Intersection &its) const {
+    double coneWidth = oneMinusCosThetaMax(ref, center, radius);
+    if (coneWidth <= 0)
+        return Entity::pdfSolidAngle(ref, its);
+    return 1 / (2 * M_PI * coneWidth);
+}
+
 BoundingBox3f Sphere::WorldBound() const {
     Point3d pMin = center - Vec3d(radius);
     Point3d pMax = center + Vec3d(radius);
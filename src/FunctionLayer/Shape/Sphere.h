@@ -29,6 +29,10 @@ public:
 
 	virtual BoundingBox3f WorldBound() const override;
 
+    virtual Intersection sampleSolidAngle(const Point3d &ref, const Point2d &positionSample, double *pdf) const override;
+
+    virtual double pdfSolidAngle(const Point3d &ref, const Intersection &its) const override;
+
 protected:
     double radius;
     Point3d center;
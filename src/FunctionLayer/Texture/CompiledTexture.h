@@ -0,0 +1,244 @@
+/**
+ * @file CompiledTexture.h
+ * @author agent
+ * @brief Texture trees flattened into a node array at scene load.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ *
+ */
+#pragma once
+
+#include <typeinfo>
+#include <vector>
+#include "Texture.h"
+#include "TextureMapping.h"
+#include "ImageTexture.h"
+#include "ProceduralTexture.h"
+
+/// @brief Per-lookup state shared by every node of a program, so the uv mapping runs at most once.
+class TextureEvalContext
+{
+public:
+    explicit TextureEvalContext(const Intersection &intersection) : intersection(intersection) { }
+
+    const Intersection &intersection;
+
+    const TextureCoord2D &uv()
+    {
+        if (!hasUV) {
+            static const UVTextureMapping2D uvMapping;
+            coord = uvMapping.UVTextureMapping2D::mapping(intersection);
+            hasUV = true;
+        }
+        return coord;
+    }
+
+private:
+    TextureCoord2D coord;
+    bool hasUV = false;
+};
+
+/// \brief A texture tree compiled into a flat node array.
+/// Constant subtrees are folded, and the known node types (constant, image with uv mapping,
+/// checkerboard, mix) are evaluated by one switch with non-virtual calls. Only the outer eval
+/// stays virtual. Unknown textures are kept as generic nodes and evaluated through their own eval.
+/// \ingroup Texture
+template <typename Tvalue>
+class CompiledTexture : public Texture<Tvalue>
+{
+public:
+    /// @return the compiled texture, or the plain constant if the whole tree folds to one value.
+    static std::shared_ptr<Texture<Tvalue>> compile(const std::shared_ptr<Texture<Tvalue>> &texture);
+
+    /// @brief same as compile, but always returns a program, used for nested inputs.
+    static std::shared_ptr<CompiledTexture<Tvalue>> compileProgram(const std::shared_ptr<Texture<Tvalue>> &texture);
+
+    virtual Tvalue eval(const Intersection &intersection) const override
+    {
+        TextureEvalContext context(intersection);
+        return evalNode(root, context);
+    }
+
+    /// @brief non-virtual entry for programs nested in another program.
+    Tvalue eval(TextureEvalContext &context) const
+    {
+        return evalNode(root, context);
+    }
+
+    bool isConstant() const { return nodes[root].op == EOp::CONSTANT; }
+
+    /// @brief value of a program that folded to a constant.
+    const Tvalue &getConstant() const { return nodes[root].value; }
+
+    int getNodeCount() const { return nodes.size(); }
+
+private:
+    enum class EOp : uint8_t {
+        CONSTANT,
+        IMAGE_DIRECT,
+        IMAGE_MIPMAP,
+        IMAGE_TILED,
+        CHECKER,
+        MIX,
+        GENERIC
+    };
+
+    struct Node {
+        EOp op;
+        Tvalue value{}, offValue{};                             ///< constant value, or checker colors
+        int resU = 0, resV = 0;
+        int a = -1, b = -1;                                     ///< mix inputs
+        double factor = 0;                                      ///< mix factor when it is constant
+        std::shared_ptr<CompiledTexture<double>> factorProgram; ///< mix factor otherwise
+        PrefilteredImage<RGB3> *sampler = nullptr;
+        std::shared_ptr<Texture<Tvalue>> source;                ///< keeps the sampler alive, evaluated by GENERIC nodes
+    };
+
+    /// @brief append the nodes of a subtree, children first.
+    /// @return index of the subtree root.
+    int emit(const std::shared_ptr<Texture<Tvalue>> &texture);
+
+    int emitConstant(const Tvalue &value)
+    {
+        Node node;
+        node.op = EOp::CONSTANT;
+        node.value = value;
+        nodes.push_back(node);
+        return nodes.size() - 1;
+    }
+
+    Tvalue evalNode(int index, TextureEvalContext &context) const;
+
+    static Tvalue fromRGB(const RGB3 &rgb);
+
+    std::vector<Node> nodes;
+    int root = 0;
+};
+
+template <>
+inline double CompiledTexture<double>::fromRGB(const RGB3 &rgb)
+{
+    return rgb[0];
+}
+
+template <>
+inline RGB3 CompiledTexture<RGB3>::fromRGB(const RGB3 &rgb)
+{
+    return rgb;
+}
+
+template <>
+inline Spectrum CompiledTexture<Spectrum>::fromRGB(const RGB3 &rgb)
+{
+    return Spectrum(rgb);
+}
+
+template <typename Tvalue>
+std::shared_ptr<CompiledTexture<Tvalue>> CompiledTexture<Tvalue>::compileProgram(const std::shared_ptr<Texture<Tvalue>> &texture)
+{
+    auto program = std::make_shared<CompiledTexture<Tvalue>>();
+    program->root = program->emit(texture);
+    return program;
+}
+
+template <typename Tvalue>
+std::shared_ptr<Texture<Tvalue>> CompiledTexture<Tvalue>::compile(const std::shared_ptr<Texture<Tvalue>> &texture)
+{
+    if (!texture || std::dynamic_pointer_cast<ConstantTexture<Tvalue>>(texture))
+        return texture;
+    auto program = compileProgram(texture);
+    if (program->isConstant())
+        return std::make_shared<ConstantTexture<Tvalue>>(program->getConstant());
+    return program;
+}
+
+template <typename Tvalue>
+int CompiledTexture<Tvalue>::emit(const std::shared_ptr<Texture<Tvalue>> &texture)
+{
+    if (auto constant = std::dynamic_pointer_cast<ConstantTexture<Tvalue>>(texture))
+        return emitConstant(constant->value);
+
+    if (auto mix = std::dynamic_pointer_cast<MixTexture<Tvalue>>(texture)) {
+        int a = emit(mix->srcA), b = emit(mix->srcB);
+        auto factorProgram = CompiledTexture<double>::compileProgram(mix->factor);
+        if (factorProgram->isConstant()) {
+            double alpha = factorProgram->getConstant();
+            if (alpha == 1) return a;
+            if (alpha == 0) return b;
+            if (nodes[a].op == EOp::CONSTANT && nodes[b].op == EOp::CONSTANT)
+                return emitConstant(nodes[a].value * alpha + nodes[b].value * (1 - alpha));
+            Node node;
+            node.op = EOp::MIX;
+            node.a = a;
+            node.b = b;
+            node.factor = alpha;
+            nodes.push_back(node);
+            return nodes.size() - 1;
+        }
+        Node node;
+        node.op = EOp::MIX;
+        node.a = a;
+        node.b = b;
+        node.factorProgram = factorProgram;
+        nodes.push_back(node);
+        return nodes.size() - 1;
+    }
+
+    Node node;
+    node.op = EOp::GENERIC;
+    node.source = texture;
+    auto isUV = [](const auto &mapping) {
+        return mapping && typeid(*mapping) == typeid(UVTextureMapping2D);
+    };
+    if (auto image = std::dynamic_pointer_cast<ImageTexture<Tvalue, RGB3>>(texture);
+        image && typeid(*image) == typeid(ImageTexture<Tvalue, RGB3>) && isUV(image->mapping)) {
+        const auto &sampler = *image->imageSampler;
+        if (typeid(sampler) == typeid(DirectImage<RGB3>))
+            node.op = EOp::IMAGE_DIRECT;
+        else if (typeid(sampler) == typeid(LinearMIPMap<RGB3>))
+            node.op = EOp::IMAGE_MIPMAP;
+        else if (typeid(sampler) == typeid(TiledMIPMap<RGB3>))
+            node.op = EOp::IMAGE_TILED;
+        node.sampler = image->imageSampler.get();
+    } else if (auto checker = std::dynamic_pointer_cast<Checkerboard2D<Tvalue>>(texture);
+               checker && typeid(*checker) == typeid(Checkerboard2D<Tvalue>) && isUV(checker->mapping)) {
+        node.op = EOp::CHECKER;
+        node.value = checker->onColor;
+        node.offValue = checker->offColor;
+        node.resU = checker->resU;
+        node.resV = checker->resV;
+    }
+    nodes.push_back(node);
+    return nodes.size() - 1;
+}
+
+template <typename Tvalue>
+Tvalue CompiledTexture<Tvalue>::evalNode(int index, TextureEvalContext &context) const
+{
+    const Node &node = nodes[index];
+    switch (node.op) {
+        case EOp::CONSTANT:
+            return node.value;
+        case EOp::IMAGE_DIRECT:
+            return fromRGB(static_cast<DirectImage<RGB3> *>(node.sampler)->DirectImage<RGB3>::eval(context.uv()));
+        case EOp::IMAGE_MIPMAP:
+            return fromRGB(static_cast<LinearMIPMap<RGB3> *>(node.sampler)->LinearMIPMap<RGB3>::eval(context.uv()));
+        case EOp::IMAGE_TILED:
+            return fromRGB(static_cast<TiledMIPMap<RGB3> *>(node.sampler)->TiledMIPMap<RGB3>::eval(context.uv()));
+        case EOp::CHECKER: {
+            const Point2d &uv = context.uv().coord;
+            int x = uv.x * node.resU;
+            int y = uv.y * node.resV;
+            return ((x ^ y) & 1) ? node.value : node.offValue;
+        }
+        case EOp::MIX: {
+            double alpha = node.factorProgram ? node.factorProgram->eval(context) : node.factor;
+            return evalNode(node.a, context) * alpha + evalNode(node.b, context) * (1 - alpha);
+        }
+        default:
+            return node.source->eval(context.intersection);
+    }
+}
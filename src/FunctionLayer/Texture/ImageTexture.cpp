@@ -12,11 +12,8 @@
 
 #include "ImageTexture.h"
 
-template <>
-RGB3 DirectImage<RGB3>::eval(const TextureCoord2D &coord)
+static RGB3 bilinearLookup(const std::shared_ptr<Image> &image, const Point2d &uv)
 {
-    Point2d uv = coord.coord;
-
     //apply linear lerp
 
     int _w = image->getResolution().x;
@@ -49,7 +46,12 @@ RGB3 DirectImage<RGB3>::eval(const TextureCoord2D &coord)
             u,
             v
     );
+}
 
+template <>
+RGB3 DirectImage<RGB3>::eval(const TextureCoord2D &coord)
+{
+    return bilinearLookup(image, coord.coord);
 
     // todo: apply wrap mode
 //    uv.x = std::max(0.0, std::min(0.99999, uv.x)) * image->getResolution().x;
@@ -58,6 +60,47 @@ RGB3 DirectImage<RGB3>::eval(const TextureCoord2D &coord)
 //    return image->getRGBColorAt(xy);
 }
 
+/// @brief fractional mip level for the footprint of the texture coordinate differentials, see pbrt-v3 MIPMap::Lookup
+static double footprintLevel(const TextureCoord2D &coord, int width, int height)
+{
+    double footprint = 2 * std::max({std::abs(coord.dcdx.x), std::abs(coord.dcdx.y),
+                                     std::abs(coord.dcdy.x), std::abs(coord.dcdy.y)});
+    footprint *= std::max(width, height);
+    return std::log2(std::max(footprint, 1e-8));
+}
+
+template <>
+RGB3 LinearMIPMap<RGB3>::eval(const TextureCoord2D &coord)
+{
+    int nLevels = pyramid.size();
+    double level = footprintLevel(coord, getImageWidth(), getImageHeight());
+    if (level <= 0)
+        return bilinearLookup(pyramid[0], coord.coord);
+    if (level >= nLevels - 1)
+        return bilinearLookup(pyramid[nLevels - 1], coord.coord);
+    int iLevel = std::floor(level);
+    double delta = level - iLevel;
+    return bilinearLookup(pyramid[iLevel], coord.coord) * (1 - delta) +
+           bilinearLookup(pyramid[iLevel + 1], coord.coord) * delta;
+}
+
+template <>
+RGB3 TiledMIPMap<RGB3>::eval(const TextureCoord2D &coord)
+{
+    if (fallback)
+        return fallback->LinearMIPMap<RGB3>::eval(coord);
+    int nLevels = image->getLevels();
+    double level = footprintLevel(coord, getImageWidth(), getImageHeight());
+    if (level <= 0)
+        return image->bilinear(0, coord.coord);
+    if (level >= nLevels - 1)
+        return image->bilinear(nLevels - 1, coord.coord);
+    int iLevel = std::floor(level);
+    double delta = level - iLevel;
+    return image->bilinear(iLevel, coord.coord) * (1 - delta) +
+           image->bilinear(iLevel + 1, coord.coord) * delta;
+}
+
 template<>
 Spectrum ImageTexture<Spectrum, RGB3>::eval(const TextureCoord2D &coord) const
 {
@@ -14,6 +14,7 @@
 #include "CoreLayer/ColorSpace/Color.h"
 #include "ResourceLayer/File/Image.h"
 #include "ResourceLayer/ResourceManager.h"
+#include "ResourceLayer/TextureCache.h"
 #include "FunctionLayer/Intersection.h"
 #include "Texture.h"
 #include "TextureMapping.h"
@@ -29,10 +30,13 @@ class PrefilteredImage
 {
 protected:
     WrapMode wrapMode;
+    Image::ImageLoadMode loadMode = Image::ImageLoadMode::IMAGE_LOAD_COLOR;
 
 public:
     virtual void setWrapMode(enum WrapMode _wrapMode);
     virtual WrapMode getWrapMode();
+    /// @brief how the texels of the next loaded image are decoded, e.g. linear for normal maps.
+    void setLoadMode(Image::ImageLoadMode mode) { loadMode = mode; }
     // todo: other common parameters
 
     virtual T eval(const TextureCoord2D &coord) = 0;
@@ -58,16 +62,42 @@ public:
     int getImageHeight( ) const override;
 };
 
+/// @brief Trilinear mip-mapped lookup, the level is chosen from the texture coordinate differentials.
+/// Without differentials (dcdx = dcdy = 0) it is a plain bilinear lookup at level 0.
 template <typename T>
 class LinearMIPMap : public PrefilteredImage<T>
 {
 protected:
-    std::shared_ptr<Image> image;
+    /// @brief level 0 is the source image, every next level halves the resolution with a box filter.
+    std::vector<std::shared_ptr<Image>> pyramid;
 
 public:
     virtual void loadImage(const std::string &filename) override;
-    virtual T eval(const TextureCoord2D &coord);
-    virtual T texel(const Point2i &coord);
+    virtual T eval(const TextureCoord2D &coord) override;
+    virtual T texel(const Point2i &coord) override;
+
+    int getImageWidth( ) const override;
+    int getImageHeight( ) const override;
+    int getLevels() const { return pyramid.size(); }
+};
+
+/// @brief Same lookup as LinearMIPMap, but the pyramid lives in a tiled cache file and
+/// only the tiles that are sampled are paged in, see TextureCache.
+/// When the cache file can not be written the image is loaded into a LinearMIPMap instead.
+template <typename T>
+class TiledMIPMap : public PrefilteredImage<T>
+{
+protected:
+    std::shared_ptr<TiledImage> image;
+    std::shared_ptr<LinearMIPMap<T>> fallback;
+
+public:
+    virtual void loadImage(const std::string &filename) override;
+    virtual T eval(const TextureCoord2D &coord) override;
+    virtual T texel(const Point2i &coord) override;
+
+    int getImageWidth( ) const override;
+    int getImageHeight( ) const override;
 };
 
 /// \brief Image-based texture
@@ -75,6 +105,8 @@ public:
 template <typename Treturn, typename Tmemory>
 class ImageTexture : public StdTexture<Treturn, TextureCoord2D>
 {
+    template <typename> friend class CompiledTexture;
+
 protected:
     std::shared_ptr<PrefilteredImage<Tmemory>> imageSampler;
 
@@ -115,7 +147,7 @@ WrapMode PrefilteredImage<T>::getWrapMode()
 template <typename T>
 void DirectImage<T>::loadImage(const std::string &filename)
 {
-    image = ImageManager::getInstance()->getImage(filename);
+    image = ImageManager::getInstance()->getImage(filename, this->loadMode);
 }
 
 template <typename T>
@@ -134,6 +166,62 @@ int DirectImage < T >::getImageHeight( ) const {
     return image->getHeight();
 }
 
+template <typename T>
+void LinearMIPMap<T>::loadImage(const std::string &filename)
+{
+    pyramid.clear();
+    pyramid.push_back(ImageManager::getInstance()->getImage(filename, this->loadMode));
+    //* levels are shared through ImageManager, so scene snapshots keep them too
+    while (pyramid.back()->getWidth() > 1 || pyramid.back()->getHeight() > 1)
+        pyramid.push_back(ImageManager::getInstance()->getMipLevel(filename, int(pyramid.size()), this->loadMode));
+}
+
+template <typename T>
+T LinearMIPMap<T>::texel(const Point2i &coord)
+{
+    return pyramid[0]->getRGBColorAt(coord);
+}
+
+template < typename T >
+int LinearMIPMap < T >::getImageWidth( ) const {
+    return pyramid[0]->getWidth();
+}
+
+template < typename T >
+int LinearMIPMap < T >::getImageHeight( ) const {
+    return pyramid[0]->getHeight();
+}
+
+template <typename T>
+void TiledMIPMap<T>::loadImage(const std::string &filename)
+{
+    image = TextureCache::getInstance()->open(filename, this->loadMode);
+    fallback = nullptr;
+    if (!image) {
+        fallback = std::make_shared<LinearMIPMap<T>>();
+        fallback->setLoadMode(this->loadMode);
+        fallback->loadImage(filename);
+    }
+}
+
+template <typename T>
+T TiledMIPMap<T>::texel(const Point2i &coord)
+{
+    if (fallback)
+        return fallback->texel(coord);
+    return image->texel(0, coord);
+}
+
+template < typename T >
+int TiledMIPMap < T >::getImageWidth( ) const {
+    return fallback ? fallback->getImageWidth() : image->getWidth();
+}
+
+template < typename T >
+int TiledMIPMap < T >::getImageHeight( ) const {
+    return fallback ? fallback->getImageHeight() : image->getHeight();
+}
+
 template <typename Treturn, typename Tmemory>
 ImageTexture<Treturn, Tmemory>::ImageTexture(const std::string &filename,
                                              std::shared_ptr<TextureMapping2D> mapping) : StdTexture<Treturn, TextureCoord2D>(mapping)
@@ -147,7 +235,7 @@ ImageTexture<Treturn, Tmemory>::ImageTexture(const std::string &filename,
 template <typename Treturn, typename Tmemory>
 ImageTexture<Treturn, Tmemory>::ImageTexture(const std::string &filename,
                                              std::shared_ptr<PrefilteredImage<Tmemory>> imageSampler,
-                                             std::shared_ptr<TextureMapping2D> mapping) : imageSampler(imageSampler), StdTexture<Treturn, TextureCoord2D>(mapping)
+                                             std::shared_ptr<TextureMapping2D> mapping) : StdTexture<Treturn, TextureCoord2D>(mapping), imageSampler(imageSampler)
 {
     this->imageSampler->loadImage(filename);
 }
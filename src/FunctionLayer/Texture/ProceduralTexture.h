@@ -17,6 +17,8 @@
 template<class T>
 class Checkerboard2D : public StdTexture<T, TextureCoord2D>
 {
+    template <typename> friend class CompiledTexture;
+
 protected:
     T onColor;
     T offColor;
@@ -18,6 +18,9 @@
 // Tvalue can be float or any specturm type
 /// \defgroup Texture
 
+template <typename Tvalue>
+class CompiledTexture;
+
 /// \brief Base class for all textures
 /// \ingroup Texture
 template <typename Tvalue>
@@ -57,6 +60,8 @@ typedef TextureMapping<TextureCoord3D> TextureMapping3D;
 template <typename Tvalue>
 class ConstantTexture : public Texture<Tvalue>
 {
+    template <typename> friend class CompiledTexture;
+
 protected:
     Tvalue value;
 
@@ -68,6 +73,8 @@ public:
 template <typename Tvalue>
 class MixTexture : public Texture<Tvalue>
 {
+    template <typename> friend class CompiledTexture;
+
 protected:
     std::shared_ptr<Texture<Tvalue>> srcA;
     std::shared_ptr<Texture<Tvalue>> srcB;
@@ -86,6 +93,8 @@ public:
 template <typename Tvalue, typename Tcoord>
 class StdTexture : public Texture<Tvalue>
 {
+    template <typename> friend class CompiledTexture;
+
 protected:
     std::shared_ptr<TextureMapping<Tcoord>> mapping;
 
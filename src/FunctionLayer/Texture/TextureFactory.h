@@ -13,12 +13,23 @@
 #include "Texture.h"
 #include "ImageTexture.h"
 #include "ProceduralTexture.h"
+#include "CompiledTexture.h"
 
 #include "ResourceLayer/File/FileUtils.h"
+#include <type_traits>
 
 namespace  TextureFactory{
+    /// @brief 8-bit color textures are sRGB encoded, scalar ones (roughness, metallic...) hold linear data.
     template <class T>
-    std::shared_ptr<Texture<T>> LoadTexture(const Json & textureJson){
+    Image::ImageLoadMode DefaultLoadMode(){
+        return std::is_same_v<T, double> ? Image::ImageLoadMode::IMAGE_LOAD_LINEAR : Image::ImageLoadMode::IMAGE_LOAD_COLOR;
+    }
+
+    /// @brief build the texture tree as described in the json, without compiling it.
+    /// @param loadMode decoding of image files that do not set "colorspace" themselves.
+    template <class T>
+    std::shared_ptr<Texture<T>> LoadTextureTree(const Json & textureJson,
+                                                Image::ImageLoadMode loadMode = DefaultLoadMode<T>()){
         if(textureJson.is_null()){
             return nullptr;
         }
@@ -29,8 +40,14 @@ namespace  TextureFactory{
             return std::make_shared <ConstantTexture<T>>(textureJson);
         }
         if(textureJson.is_string()){
+            std::shared_ptr<PrefilteredImage<RGB3>> sampler;
+            if(TextureCache::getInstance()->isTiledByDefault())
+                sampler = std::make_shared<TiledMIPMap<RGB3>>();
+            else
+                sampler = std::make_shared<LinearMIPMap<RGB3>>();
+            sampler->setLoadMode(loadMode);
             auto emission = std::make_shared < ImageTexture < T, RGB3>>(
-                    FileUtils::getFullPath(textureJson) );
+                    FileUtils::getFullPath(textureJson), sampler );
             return emission;
         }
         if(textureJson.is_object()){
@@ -42,11 +59,43 @@ namespace  TextureFactory{
                 int resV = getOptional(textureJson,"res_v",20);
                 return std::make_shared<Checkerboard2D<T>>(onColor,offColor,resU,resV);
             }
+            if(type == "image"){
+                // "filter": "trilinear" (default) or "bilinear"
+                // "tiled": page the mip levels in from a tiled cache file, see TextureCache
+                // "colorspace": "srgb" or "linear", how 8-bit color channels are decoded
+                std::shared_ptr<PrefilteredImage<RGB3>> sampler;
+                if(getOptional(textureJson,"filter",std::string("trilinear")) == "bilinear")
+                    sampler = std::make_shared<DirectImage<RGB3>>();
+                else if(getOptional(textureJson,"tiled",TextureCache::getInstance()->isTiledByDefault()))
+                    sampler = std::make_shared<TiledMIPMap<RGB3>>();
+                else
+                    sampler = std::make_shared<LinearMIPMap<RGB3>>();
+                if(textureJson.contains("colorspace"))
+                    loadMode = textureJson["colorspace"] == "linear" ? Image::ImageLoadMode::IMAGE_LOAD_LINEAR
+                                                                     : Image::ImageLoadMode::IMAGE_LOAD_COLOR;
+                sampler->setLoadMode(loadMode);
+                return std::make_shared < ImageTexture < T, RGB3>>(
+                        FileUtils::getFullPath(textureJson.at("file")), sampler );
+            }
+            if(type == "mix"){
+                // srcA * factor + srcB * (1 - factor)
+                return std::make_shared<MixTexture<T>>(
+                        LoadTextureTree<T>(textureJson.at("a"), loadMode),
+                        LoadTextureTree<T>(textureJson.at("b"), loadMode),
+                        LoadTextureTree<double>(textureJson.at("factor")));
+            }
             //todo
         }
         return nullptr;
     }
 
+    /// @brief load a texture and compile it, see CompiledTexture.
+    template <class T>
+    std::shared_ptr<Texture<T>> LoadTexture(const Json & textureJson,
+                                            Image::ImageLoadMode loadMode = DefaultLoadMode<T>()){
+        return CompiledTexture<T>::compile(LoadTextureTree<T>(textureJson, loadMode));
+    }
+
     template <class T>
     std::shared_ptr<Texture<T>> LoadTexture(const nlohmann::json & textureJson,T defaultValue){
         if(auto texture = LoadTexture<T>(textureJson))
@@ -16,7 +16,8 @@ TextureCoord2D UVTextureMapping2D::mapping(const Intersection &intersection) con
 {
     TextureCoord2D answer;
     answer.coord = intersection.uv;
-    // todo: eval dctdx and dctdy
+    answer.dcdx = Vec2d(intersection.dudx, intersection.dvdx);
+    answer.dcdy = Vec2d(intersection.dudy, intersection.dvdy);
     return answer;
 }
 
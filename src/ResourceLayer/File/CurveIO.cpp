@@ -153,14 +153,14 @@ void CurveIO::LoadCurve(const std::string & path, std::vector < int > * curveEnd
     std::vector<Vec3f> fNodeColor,fNodeNormals;
     LoadCurve(path,curveEnds,&fnodeData,&fNodeColor,&fNodeNormals);
     nodeData->resize(fnodeData.size()/4);
-    for(int i = 0 ;i<nodeData->size();i++)
+    for(size_t i = 0 ;i<nodeData->size();i++)
         nodeData->operator [](i)  = Vec4d (fnodeData[4*i],fnodeData[4*i+1],fnodeData[4*i+2],fnodeData[4*i+3]);
     nodeColor->resize(fNodeColor.size());
-    for(int i = 0 ;i<fNodeColor.size();i++)
+    for(size_t i = 0 ;i<fNodeColor.size();i++)
         nodeColor->operator [](i)  =
                 Vec3d(fNodeColor.operator [](i).x,fNodeColor.operator [](i).y,fNodeColor.operator [](i).z);
     nodeNormals->resize(fNodeNormals.size());
-    for(int i = 0 ;i<fNodeColor.size();i++)
+    for(size_t i = 0 ;i<fNodeColor.size();i++)
         nodeNormals->operator [](i)  =
                 Vec3d(fNodeNormals.operator [](i).x,fNodeNormals.operator [](i).y,fNodeNormals.operator [](i).z);
 }
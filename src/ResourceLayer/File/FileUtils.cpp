@@ -2,6 +2,7 @@
 #include <stdexcept>
 #include <memory>
 #include <algorithm>
+#include <filesystem>
 #include "FileUtils.h"
 
 inline bool fileExists (const std::string& name) {
@@ -49,6 +50,14 @@ namespace FileUtils{
         //return std::move(destPath);
         return destPath;
     }
+
+    bool getFileStamp(const std::string & path, uint64_t & size, int64_t & time){
+        std::error_code ec;
+        size = std::filesystem::file_size(path, ec);
+        if(ec) return false;
+        time = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+        return !ec;
+    }
 }
 
 std::string FileUtils::getFileExtension(const std::string & path) {
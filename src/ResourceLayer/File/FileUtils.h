@@ -10,6 +10,7 @@
  */
 #pragma  once
 
+#include <cstdint>
 #include <string>
 #include <fstream>
 #include <vector>
@@ -20,6 +21,10 @@ namespace FileUtils{
     std::string getFileExtension(const std::string & path);
     std::string getFullPath(const std::string & path);
 
+    /// @brief size and last write time of a file, used to tell whether a derived cache is stale.
+    /// @return false if the file can not be queried.
+    bool getFileStamp(const std::string & path, uint64_t & size, int64_t & time);
+
     template<typename T>
     static inline void streamRead(std::istream &in, T &dst)
     {
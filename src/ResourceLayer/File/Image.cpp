@@ -1,5 +1,6 @@
 #include "Image.h"
 #include "ResourceLayer/File/FileUtils.h"
+#include <vector>
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb/stb_image.h"
 #define STB_IMAGE_WRITE_IMPLEMENTATION
@@ -20,53 +21,45 @@ T *Image::as() const {
 
 Image::Image(const std::string &path, ImageLoadMode ilm) {
 
-    // todo: support alpha reading
-    // todo: do gamma correction
+    // keep the bit depth and channel count of the file, texels are converted at lookup
     isHdr = stbi_is_hdr(path.c_str());
+    int desiredChannels = ilm == ImageLoadMode::IMAGE_LOAD_BW ? 1 : 0;
     int w, h, c;
-    if (isHdr) {
-        float *data = stbi_loadf(path.c_str(), &w, &h, &c, 3);
-        imageRawData = new float[w * h * c];
-        std::memcpy(imageRawData, data, w * h * c * sizeof(float));
-        free(data);
-    } else
-    // todo: bw mode
-    {
-        unsigned char *data = stbi_load(path.c_str(), &w, &h, &c, 3);
-        if (!data) {
-            std::cout << "Fail to load image " << path << std::endl;
-            return;
-        }
-        imageRawData = new float[w * h * c];
-        for (int k = 0; k < c; ++k) {
-            for (int j = 0; j < h; ++j) {
-                for (int i = 0; i < w; ++i) {
-                    int destIdx = i + w * j + w * h * k;
-                    int srcIdx = i + w * j + w * h * k;
-                    // todo: gamma
-                    as<float>()[destIdx] = (float)data[srcIdx] / 255;
-                }
-            }
-        }
-        free(data);
+    void *data;
+    if (isHdr)
+        data = stbi_loadf(path.c_str(), &w, &h, &c, desiredChannels);
+    else
+        data = stbi_load(path.c_str(), &w, &h, &c, desiredChannels);
+    if (!data) {
+        std::cout << "Fail to load image " << path << std::endl;
+        imageRawData = nullptr;
+        resolution = Point2i(0, 0);
+        channels = 0;
+        return;
     }
+    if (desiredChannels)
+        c = desiredChannels;
 
     resolution = Point2i(w, h);
     channels = c;
+    // 8-bit color images are sRGB encoded, 8-bit grey images (roughness, masks...) and
+    // images loaded as linear (normal maps...) hold linear data
+    if (isHdr)
+        format = ETexelFormat::FLOAT;
+    else
+        format = c >= 3 && ilm == ImageLoadMode::IMAGE_LOAD_COLOR ? ETexelFormat::SRGB8 : ETexelFormat::UNORM8;
+    imageRawData = new uint8_t[getMemoryUsage()];
+    std::memcpy(imageRawData, data, getMemoryUsage());
+    free(data);
 }
 
-Image::Image(const Point2i &resolution, int channels) : resolution(resolution), channels(channels) {
-    int w = resolution.x;
-    int h = resolution.y;
-    int c = channels;
-    imageRawData = new float[w * h * c];
+Image::Image(const Point2i &resolution, int channels, ETexelFormat format) :
+    resolution(resolution), channels(channels), format(format) {
+    imageRawData = new uint8_t[getMemoryUsage()];
 }
 
 Image::Image(const Point3i &shape) : resolution(shape.x, shape.y), channels(shape.z) {
-    int w = resolution.x;
-    int h = resolution.y;
-    int c = channels;
-    imageRawData = new float[w * h * c]();
+    imageRawData = new uint8_t[getMemoryUsage()]();
 }
 
 Point2i Image::getResolution() const {
@@ -85,38 +78,99 @@ int Image::getHeight() const {
     return resolution.y;
 }
 
+ETexelFormat Image::getFormat() const {
+    return format;
+}
+
+int Image::getBytesPerPixel() const {
+    return channels * TexelFormat::channelBytes(format);
+}
+
+size_t Image::getMemoryUsage() const {
+    return size_t(resolution.x) * resolution.y * getBytesPerPixel();
+}
+
+const uint8_t *Image::getPixelData(const Point2i &p) const {
+    return imageRawData + (size_t(p.x) + size_t(resolution.x) * p.y) * getBytesPerPixel();
+}
+
+void Image::convertTo(ETexelFormat newFormat) {
+    if (newFormat == format)
+        return;
+    size_t count = size_t(resolution.x) * resolution.y * channels;
+    auto *converted = new uint8_t[count * TexelFormat::channelBytes(newFormat)];
+    if (format == ETexelFormat::FLOAT && newFormat == ETexelFormat::HALF) {
+        TexelFormat::floatToHalf(as<float>(), reinterpret_cast<uint16_t *>(converted), count);
+    } else {
+        int srcStride = TexelFormat::channelBytes(format), dstStride = TexelFormat::channelBytes(newFormat);
+        for (size_t i = 0; i < count; ++i)
+            TexelFormat::encodeChannel(converted + i * dstStride, newFormat,
+                                       TexelFormat::decodeChannel(imageRawData + i * srcStride, format));
+    }
+    delete[] imageRawData;
+    imageRawData = converted;
+    format = newFormat;
+}
+
 void Image::setColorAt(const Point2i &p, const RGB3 &rgb) {
-    int i = p.x;
-    int j = p.y;
-    int c = 3;
-    int w = resolution.x;
-    int srcIdx = c * i + c * w * j;
-
-    as<float>()[srcIdx + 0] = rgb[0];
-    as<float>()[srcIdx + 1] = rgb[1];
-    as<float>()[srcIdx + 2] = rgb[2];
-}
-
-RGB3 Image::getRGBColorAt(const Point2i &p) {
-    RGB3 ans;
-    int i = p.x;
-    int j = p.y;
-    int c = 3;
-    int w = resolution.x;
-    int srcIdx = c * i + c * w * j;
-    ans[0] = as<float>()[srcIdx + 0];
-    ans[1] = as<float>()[srcIdx + 1];
-    ans[2] = as<float>()[srcIdx + 2];
-    return ans;
-}
-
-Spectrum Image::getSpectrumColorAt(const Point2i &p) {
+    TexelFormat::encodeRGB(const_cast<uint8_t *>(getPixelData(p)), format, channels, rgb);
+}
+
+RGB3 Image::getRGBColorAt(const Point2i &p) const {
+    return TexelFormat::decodeRGB(getPixelData(p), format, channels);
+}
+
+Spectrum Image::getSpectrumColorAt(const Point2i &p) const {
     return Spectrum(getRGBColorAt(p));
 }
 
+/// @brief source texels under each destination texel of one axis, weighted by their overlap.
+/// Even sizes give two halves; odd sizes give three taps, so no row or column is dropped.
+static std::vector<std::vector<std::pair<int, double>>> boxFootprints(int src, int dst) {
+    std::vector<std::vector<std::pair<int, double>>> footprints(dst);
+    double scale = double(src) / dst;
+    for (int i = 0; i < dst; ++i) {
+        double begin = i * scale, end = (i + 1) * scale;
+        for (int k = int(begin); k < std::min(src, int(std::ceil(end))); ++k) {
+            double overlap = std::min<double>(end, k + 1) - std::max<double>(begin, k);
+            if (overlap > 0)
+                footprints[i].emplace_back(k, overlap / scale);
+        }
+    }
+    return footprints;
+}
+
+std::shared_ptr<Image> Image::downsample() const {
+    int srcW = resolution.x, srcH = resolution.y;
+    int w = std::max(1, srcW / 2), h = std::max(1, srcH / 2);
+    auto dst = std::make_shared<Image>(Point2i(w, h), channels, format);
+    auto columns = boxFootprints(srcW, w), rows = boxFootprints(srcH, h);
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            RGB3 sum(0.0);
+            for (const auto &[sy, wy] : rows[y])
+                for (const auto &[sx, wx] : columns[x])
+                    sum += getRGBColorAt(Point2i(sx, sy)) * (wx * wy);
+            dst->setColorAt(Point2i(x, y), sum);
+        }
+    }
+    return dst;
+}
+
 bool Image::saveTo(const std::string &path) {
     auto destpath = FileUtils::getFilePath(path, "hdr", false);
     const char *destHdrPath = destpath.c_str();
-    stbi_write_hdr(destHdrPath, resolution.x, resolution.y, 3, imageRawData);
+    if (format == ETexelFormat::FLOAT && channels == 3) {
+        stbi_write_hdr(destHdrPath, resolution.x, resolution.y, 3, as<float>());
+        return true;
+    }
+    std::vector<float> rgb(size_t(resolution.x) * resolution.y * 3);
+    for (int j = 0; j < resolution.y; ++j)
+        for (int i = 0; i < resolution.x; ++i) {
+            RGB3 color = getRGBColorAt(Point2i(i, j));
+            for (int k = 0; k < 3; ++k)
+                rgb[3 * (i + size_t(resolution.x) * j) + k] = color[k];
+        }
+    stbi_write_hdr(destHdrPath, resolution.x, resolution.y, 3, rgb.data());
     return true;
 }
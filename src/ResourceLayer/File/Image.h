@@ -11,35 +11,41 @@
  */
 #pragma once
 
+#include <memory>
 #include <string>
 #include "CoreLayer/Geometry/Geometry.h"
 #include "CoreLayer/ColorSpace/Color.h"
+#include "TexelFormat.h"
 
-///@brief All type will be transformed to float
+///@brief Texels keep the bit depth and channel count of the file and are converted to float RGB at lookup.
 class ImageManager;
 
 class Image {
 
     friend class ImageManager;
+    friend class SceneSnapshot;
 
 public:
     enum class ImageLoadMode {
         IMAGE_LOAD_BW,
-        IMAGE_LOAD_COLOR
+        IMAGE_LOAD_COLOR,
+        IMAGE_LOAD_LINEAR       ///< color channels holding data (normal, bump, roughness maps), never sRGB decoded
     };
 
 private:
-    float *imageRawData;
+    uint8_t *imageRawData;
 
     Point2i resolution;
 
     int channels;
 
+    ETexelFormat format = ETexelFormat::FLOAT;
+
     bool isHdr = false;
 
     /// @brief load an image from path. Can ONLY be accessed from ImageManager. If you want to load an image from path, call ImageManager::getInstance::getImage.
     /// @param path path for the image.
-    /// @param ilm load mode for image, color or black/white.
+    /// @param ilm load mode for image, color, linear color or black/white.
     Image(const std::string &path, ImageLoadMode ilm = ImageLoadMode::IMAGE_LOAD_COLOR);
 
 public:
@@ -49,22 +55,37 @@ public:
     Image();
     ~Image();
 
-    // @brief generate one black image with resolution [width,height] and channels. Could be accessed directly.
-    Image(const Point2i &resolution, int channels);
+    // @brief generate one image with resolution [width,height] and channels. Could be accessed directly.
+    Image(const Point2i &resolution, int channels, ETexelFormat format = ETexelFormat::FLOAT);
     Image(const Point3i &shape);
 
     Point2i getResolution() const;
     int getChannels() const;
     int getWidth() const;
     int getHeight() const;
+    ETexelFormat getFormat() const;
+    int getBytesPerPixel() const;
+
+    /// @brief size of the texel storage in bytes.
+    size_t getMemoryUsage() const;
+
+    /// @brief raw texel at p, getBytesPerPixel() bytes in the image's format.
+    const uint8_t *getPixelData(const Point2i &p) const;
+
+    /// @brief re-encode all texels in place, e.g. float HDR to half.
+    void convertTo(ETexelFormat newFormat);
 
     void setColorAt(const Point2i &p, const Spectrum &s) {
         setColorAt(p, s.toRGB3());
     }
 
     void setColorAt(const Point2i &p, const RGB3 &rgb);
-    RGB3 getRGBColorAt(const Point2i &p);
-    Spectrum getSpectrumColorAt(const Point2i &p);
+    RGB3 getRGBColorAt(const Point2i &p) const;
+    Spectrum getSpectrumColorAt(const Point2i &p) const;
+
+    /// @brief half resolution copy in the same format, box filtered in linear space. Used to build mip levels.
+    /// Odd sizes are weighted over three texels, so the last row or column still contributes.
+    std::shared_ptr<Image> downsample() const;
 
     bool saveTo(const std::string &path);
 };
@@ -0,0 +1,97 @@
+#include "MeshData.h"
+#include "VertexCompression.h"
+
+using namespace VertexCompression;
+
+static std::vector<uint32_t> packUnitVectors(const Eigen::MatrixXd &vectors) {
+    std::vector<uint32_t> packed(vectors.cols());
+    for (int i = 0; i < vectors.cols(); ++i)
+        packed[i] = encodeOctahedral(vectors(0, i), vectors(1, i), vectors(2, i));
+    return packed;
+}
+
+static size_t denseBytes(const Eigen::MatrixXd &matrix) {
+    return matrix.size() * sizeof(double);
+}
+
+size_t MeshData::compressAttributes(EUVEncoding uvEncoding) {
+    if (m_compressed) return 0;
+    size_t before = denseBytes(m_normals) + denseBytes(m_tangents) + denseBytes(m_bitangents) +
+                    m_UVs.size() * sizeof(Point2d);
+
+    m_packedNormals = packUnitVectors(m_normals);
+    m_packedTangents = packUnitVectors(m_tangents);
+    m_packedBitangents = packUnitVectors(m_bitangents);
+
+    m_uvEncoding = uvEncoding;
+    m_packedUVs.resize(m_UVs.size());
+    if (uvEncoding == EUVEncoding::Unorm16 && !m_UVs.empty()) {
+        Point2d uvMax = m_UVs[0];
+        m_uvMin = m_UVs[0];
+        for (const auto &uv : m_UVs) {
+            m_uvMin = Point2d(std::min(m_uvMin.x, uv.x), std::min(m_uvMin.y, uv.y));
+            uvMax = Point2d(std::max(uvMax.x, uv.x), std::max(uvMax.y, uv.y));
+        }
+        m_uvExtent = Point2d(uvMax.x - m_uvMin.x, uvMax.y - m_uvMin.y);
+        Point2d invExtent(m_uvExtent.x > 0 ? 1 / m_uvExtent.x : 0,
+                          m_uvExtent.y > 0 ? 1 / m_uvExtent.y : 0);
+        for (size_t i = 0; i < m_UVs.size(); ++i)
+            m_packedUVs[i] = encodeUnorm16x2(m_UVs[i], m_uvMin, invExtent);
+    } else {
+        for (size_t i = 0; i < m_UVs.size(); ++i)
+            m_packedUVs[i] = encodeHalf2(m_UVs[i]);
+    }
+
+    // release the dense storage
+    m_normals.resize(0, 0);
+    m_tangents.resize(0, 0);
+    m_bitangents.resize(0, 0);
+    std::vector<Point2d>().swap(m_UVs);
+    m_compressed = true;
+
+    size_t after = (m_packedNormals.size() + m_packedTangents.size() + m_packedBitangents.size() +
+                    m_packedUVs.size()) * sizeof(uint32_t);
+    m_savedBytes = before > after ? before - after : 0;
+    return m_savedBytes;
+}
+
+size_t MeshData::memoryUsage() const {
+    return denseBytes(m_vertices) + denseBytes(m_normals) + denseBytes(m_tangents) + denseBytes(m_bitangents) +
+           m_UVs.size() * sizeof(Point2d) + m_indices.size() * sizeof(Point3i) +
+           (m_packedNormals.size() + m_packedTangents.size() + m_packedBitangents.size() + m_packedUVs.size()) *
+               sizeof(uint32_t);
+}
+
+bool MeshData::hasNormals() const {
+    return m_compressed ? !m_packedNormals.empty() : m_normals.size() != 0;
+}
+
+bool MeshData::hasTangents() const {
+    return m_compressed ? !m_packedTangents.empty() : m_tangents.size() != 0;
+}
+
+bool MeshData::hasUVs() const {
+    return m_compressed ? !m_packedUVs.empty() : !m_UVs.empty();
+}
+
+Vec3d MeshData::getNormal(int idx) const {
+    if (m_compressed) return decodeOctahedral(m_packedNormals[idx]);
+    return eigenToVector3d(m_normals.col(idx));
+}
+
+Vec3d MeshData::getTangent(int idx) const {
+    if (m_compressed) return decodeOctahedral(m_packedTangents[idx]);
+    return eigenToVector3d(m_tangents.col(idx));
+}
+
+Vec3d MeshData::getBitangent(int idx) const {
+    if (m_compressed) return decodeOctahedral(m_packedBitangents[idx]);
+    return eigenToVector3d(m_bitangents.col(idx));
+}
+
+Point2d MeshData::getUV(int idx) const {
+    if (!m_compressed) return m_UVs[idx];
+    if (m_uvEncoding == EUVEncoding::Unorm16)
+        return decodeUnorm16x2(m_packedUVs[idx], m_uvMin, m_uvExtent);
+    return decodeHalf2(m_packedUVs[idx]);
+}
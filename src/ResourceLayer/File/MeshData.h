@@ -18,11 +18,41 @@
 #include "CoreLayer/Geometry/Geometry.h"
 #include "CoreLayer/Geometry/BoundingBox.h"
 
+/// @brief Encoding used for compressed uv coordinates.
+enum class EUVEncoding {
+	Half,		///< two IEEE half floats, keeps tiling uv outside [0,1]
+	Unorm16		///< two 16-bit unorms relative to the uv bounds of the mesh
+};
+
 /// @brief Raw mesh data.
 class MeshData
 {
 public:
 	friend class MeshDataManager;
+	friend class SceneSnapshot;
+
+	/// @brief Replace normals, tangents, bitangents and uvs with their compressed form
+	/// (32-bit octahedral unit vectors and 32-bit uv pairs) and release the dense storage.
+	/// @return bytes saved. Calling it on already compressed data returns 0.
+	size_t compressAttributes(EUVEncoding uvEncoding = EUVEncoding::Half);
+
+	bool isCompressed() const { return m_compressed; }
+
+	/// @brief bytes compressAttributes saved, 0 for dense data.
+	size_t compressionSavings() const { return m_savedBytes; }
+
+	/// @brief bytes held by all vertex and index arrays.
+	size_t memoryUsage() const;
+
+	bool hasNormals() const;
+	bool hasTangents() const;
+	bool hasUVs() const;
+
+	/// @brief Attribute access that works on both dense and compressed storage.
+	Vec3d getNormal(int idx) const;
+	Vec3d getTangent(int idx) const;
+	Vec3d getBitangent(int idx) const;
+	Point2d getUV(int idx) const;
 
 	/// @brief matrix for all vertices; vertices organized as column vectors.
 	Eigen::MatrixXd m_vertices;
@@ -42,4 +72,15 @@ public:
 	/// @brief array for all vectex indices.
 	std::vector<Point3i> m_indices;
 
+private:
+	bool m_compressed = false;
+	EUVEncoding m_uvEncoding = EUVEncoding::Half;
+	/// @brief octahedral encoded unit vectors, one uint32 per vertex.
+	std::vector<uint32_t> m_packedNormals, m_packedTangents, m_packedBitangents;
+	/// @brief packed uv pairs, one uint32 per vertex.
+	std::vector<uint32_t> m_packedUVs;
+	/// @brief uv bounds for EUVEncoding::Unorm16.
+	Point2d m_uvMin{0, 0}, m_uvExtent{1, 1};
+	size_t m_savedBytes = 0;
+
 };
\ No newline at end of file
@@ -0,0 +1,377 @@
+#include "SceneSnapshot.h"
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include "ResourceLayer/ResourceManager.h"
+#include "ResourceLayer/File/FileUtils.h"
+#include "CoreLayer/Profiler/LoadProfiler.h"
+#include "FunctionLayer/Distribution/Distribution.h"
+#if !defined(_WIN32)
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char SNAPSHOT_MAGIC[8] = {'M', 'O', 'E', 'R', 'S', 'N', 'A', 'P'};
+constexpr uint32_t SNAPSHOT_VERSION = 3;
+constexpr size_t SNAPSHOT_ALIGN = 16;
+
+enum class ERecordType : uint32_t {
+    MESH = 0,
+    IMAGE = 1,
+    DISTRIBUTION = 2
+};
+
+struct SourceStamp {
+    uint64_t size = 0;
+    int64_t time = 0;
+
+    bool operator==(const SourceStamp &other) const {
+        return size == other.size && time == other.time;
+    }
+};
+
+//* derived resources (mip levels, compressed meshes, distributions) are stamped with the file they come from
+bool getSourceStamp(const std::string &key, SourceStamp &stamp) {
+    return FileUtils::getFileStamp(ImageManager::sourcePath(key), stamp.size, stamp.time);
+}
+
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(const std::string &path) : out(path, std::ios::binary) { }
+
+    bool good() const { return out.good(); }
+
+    template<typename T>
+    void write(const T &value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+        offset += sizeof(T);
+    }
+
+    void writeString(const std::string &s) {
+        write<uint64_t>(s.size());
+        out.write(s.data(), s.size());
+        offset += s.size();
+    }
+
+    /// @brief byte count, padding, then the aligned payload.
+    void writeArray(const void *data, size_t bytes) {
+        write<uint64_t>(bytes);
+        static const char zeros[SNAPSHOT_ALIGN] = {};
+        size_t pad = (SNAPSHOT_ALIGN - offset % SNAPSHOT_ALIGN) % SNAPSHOT_ALIGN;
+        out.write(zeros, pad);
+        out.write(reinterpret_cast<const char *>(data), bytes);
+        offset += pad + bytes;
+    }
+
+    void writeMatrix(const Eigen::MatrixXd &matrix) {
+        write<uint64_t>(matrix.rows());
+        write<uint64_t>(matrix.cols());
+        writeArray(matrix.data(), matrix.size() * sizeof(double));
+    }
+
+    template<typename T>
+    void writeVector(const std::vector<T> &v) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        writeArray(v.data(), v.size() * sizeof(T));
+    }
+
+private:
+    std::ofstream out;
+    size_t offset = 0;
+};
+
+/// @brief read-only view of the snapshot, memory mapped where available.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string &path) {
+#if defined(_WIN32)
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) return;
+        buffer.resize(in.tellg());
+        in.seekg(0);
+        in.read(buffer.data(), buffer.size());
+        data = buffer.data();
+        size = buffer.size();
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st{};
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void *ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (ptr != MAP_FAILED) {
+                data = static_cast<const char *>(ptr);
+                size = st.st_size;
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    ~MappedFile() {
+#if !defined(_WIN32)
+        if (data) munmap(const_cast<char *>(data), size);
+#endif
+    }
+
+    const char *data = nullptr;
+    size_t size = 0;
+
+private:
+#if defined(_WIN32)
+    std::vector<char> buffer;
+#endif
+};
+
+class SnapshotReader {
+public:
+    SnapshotReader(const char *_data, size_t _size) : data(_data), size(_size) { }
+
+    bool ok() const { return !failed; }
+
+    template<typename T>
+    T read() {
+        T value{};
+        if (!require(sizeof(T))) return value;
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+
+    std::string readString() {
+        auto length = read<uint64_t>();
+        if (!require(length)) return {};
+        std::string s(data + offset, length);
+        offset += length;
+        return s;
+    }
+
+    /// @brief returns a pointer into the mapped file, valid while the file is mapped.
+    const char *readArray(size_t &bytes) {
+        bytes = read<uint64_t>();
+        offset += (SNAPSHOT_ALIGN - offset % SNAPSHOT_ALIGN) % SNAPSHOT_ALIGN;
+        if (!require(bytes)) return nullptr;
+        const char *ptr = data + offset;
+        offset += bytes;
+        return ptr;
+    }
+
+    void readMatrix(Eigen::MatrixXd &matrix) {
+        auto rows = read<uint64_t>(), cols = read<uint64_t>();
+        size_t bytes;
+        const char *ptr = readArray(bytes);
+        if (!ptr || bytes != rows * cols * sizeof(double)) {
+            failed = true;
+            return;
+        }
+        matrix.resize(rows, cols);
+        std::memcpy(matrix.data(), ptr, bytes);
+    }
+
+    template<typename T>
+    void readVector(std::vector<T> &v) {
+        size_t bytes;
+        const char *ptr = readArray(bytes);
+        if (!ptr || bytes % sizeof(T)) {
+            failed = true;
+            return;
+        }
+        v.resize(bytes / sizeof(T));
+        std::memcpy(v.data(), ptr, bytes);
+    }
+
+private:
+    bool require(size_t bytes) {
+        if (failed || offset + bytes > size) {
+            failed = true;
+            return false;
+        }
+        return true;
+    }
+
+    const char *data;
+    size_t size;
+    size_t offset = 0;
+    bool failed = false;
+};
+
+}// namespace
+
+bool SceneSnapshot::save(const std::string &path) {
+    ProfileScope profile("snapshot save", path);
+    SnapshotWriter writer(path);
+    if (!writer.good()) {
+        std::cerr << "Can not write scene snapshot " << path << std::endl;
+        return false;
+    }
+    const auto &meshes = MeshDataManager::getInstance()->getResources();
+    const auto &images = ImageManager::getInstance()->getResources();
+    const auto &distributions = DistributionManager::getInstance()->getResources();
+
+    writer.write(SNAPSHOT_MAGIC);
+    writer.write(SNAPSHOT_VERSION);
+    writer.write<uint64_t>(meshes.size() + images.size() + distributions.size());
+
+    for (const auto &[source, collection] : meshes) {
+        SourceStamp stamp;
+        getSourceStamp(source, stamp);
+        writer.write(ERecordType::MESH);
+        writer.writeString(source);
+        writer.write(stamp);
+        writer.write<uint64_t>(collection->size());
+        for (const auto &[name, mesh] : *collection) {
+            writer.writeString(name);
+            writer.writeMatrix(mesh->m_vertices);
+            writer.writeMatrix(mesh->m_normals);
+            writer.writeMatrix(mesh->m_tangents);
+            writer.writeMatrix(mesh->m_bitangents);
+            writer.writeVector(mesh->m_UVs);
+            writer.writeVector(mesh->m_indices);
+            writer.write<uint8_t>(mesh->m_compressed);
+            writer.write(mesh->m_uvEncoding);
+            writer.write(mesh->m_uvMin);
+            writer.write(mesh->m_uvExtent);
+            writer.writeVector(mesh->m_packedNormals);
+            writer.writeVector(mesh->m_packedTangents);
+            writer.writeVector(mesh->m_packedBitangents);
+            writer.writeVector(mesh->m_packedUVs);
+            writer.write<uint64_t>(mesh->m_savedBytes);
+        }
+    }
+
+    for (const auto &[source, image] : images) {
+        SourceStamp stamp;
+        getSourceStamp(source, stamp);
+        writer.write(ERecordType::IMAGE);
+        writer.writeString(source);
+        writer.write(stamp);
+        writer.write(image->resolution);
+        writer.write<int32_t>(image->channels);
+        writer.write(image->format);
+        writer.write<uint8_t>(image->isHdr);
+        writer.writeArray(image->imageRawData, image->getMemoryUsage());
+    }
+
+    for (const auto &[source, distribution] : distributions) {
+        SourceStamp stamp;
+        getSourceStamp(source, stamp);
+        writer.write(ERecordType::DISTRIBUTION);
+        writer.writeString(source);
+        writer.write(stamp);
+        writer.write(distribution->sampling);
+        writer.write<int32_t>(distribution->nu);
+        writer.write<int32_t>(distribution->nv);
+        writer.write(distribution->marginalFuncInt);
+        writer.writeVector(distribution->func);
+        writer.writeVector(distribution->rowFuncInt);
+        writer.writeVector(distribution->conditionalCdf);
+        writer.writeVector(distribution->conditionalBins);
+        writer.writeVector(distribution->marginalBins);
+        writer.writeVector(distribution->marginalPdf);
+    }
+    return writer.good();
+}
+
+int SceneSnapshot::restore(const std::string &path) {
+    MappedFile file(path);
+    if (!file.data) return 0;
+    ProfileScope profile("snapshot restore", path);
+    profile.setBytes(file.size);
+
+    SnapshotReader reader(file.data, file.size);
+    auto magic = reader.read<std::array<char, 8>>();
+    auto version = reader.read<uint32_t>();
+    if (!reader.ok() || std::memcmp(magic.data(), SNAPSHOT_MAGIC, 8) != 0 || version != SNAPSHOT_VERSION) {
+        std::cerr << "Ignoring invalid scene snapshot " << path << std::endl;
+        return 0;
+    }
+
+    int restored = 0;
+    auto recordCount = reader.read<uint64_t>();
+    for (uint64_t r = 0; r < recordCount && reader.ok(); r++) {
+        auto type = reader.read<ERecordType>();
+        auto source = reader.readString();
+        auto stamp = reader.read<SourceStamp>();
+        SourceStamp current;
+        bool upToDate = getSourceStamp(source, current) && current == stamp;
+
+        if (type == ERecordType::MESH) {
+            auto collection = std::make_shared<MeshDataCollection>();
+            auto meshCount = reader.read<uint64_t>();
+            for (uint64_t m = 0; m < meshCount && reader.ok(); m++) {
+                auto name = reader.readString();
+                auto mesh = std::make_shared<MeshData>();
+                reader.readMatrix(mesh->m_vertices);
+                reader.readMatrix(mesh->m_normals);
+                reader.readMatrix(mesh->m_tangents);
+                reader.readMatrix(mesh->m_bitangents);
+                reader.readVector(mesh->m_UVs);
+                reader.readVector(mesh->m_indices);
+                mesh->m_compressed = reader.read<uint8_t>();
+                mesh->m_uvEncoding = reader.read<EUVEncoding>();
+                mesh->m_uvMin = reader.read<Point2d>();
+                mesh->m_uvExtent = reader.read<Point2d>();
+                reader.readVector(mesh->m_packedNormals);
+                reader.readVector(mesh->m_packedTangents);
+                reader.readVector(mesh->m_packedBitangents);
+                reader.readVector(mesh->m_packedUVs);
+                mesh->m_savedBytes = reader.read<uint64_t>();
+                (*collection)[name] = mesh;
+            }
+            if (upToDate && reader.ok()) {
+                MeshDataManager::getInstance()->insert(source, collection);
+                restored++;
+            }
+        } else if (type == ERecordType::IMAGE) {
+            auto resolution = reader.read<Point2i>();
+            auto channels = reader.read<int32_t>();
+            auto format = reader.read<ETexelFormat>();
+            bool isHdr = reader.read<uint8_t>();
+            size_t bytes;
+            const char *pixels = reader.readArray(bytes);
+            size_t expectedBytes = size_t(resolution.x) * resolution.y * channels * TexelFormat::channelBytes(format);
+            if (upToDate && pixels && bytes == expectedBytes) {
+                auto image = std::make_shared<Image>(resolution, channels, format);
+                image->isHdr = isHdr;
+                std::memcpy(image->imageRawData, pixels, bytes);
+                ImageManager::getInstance()->insert(source, image);
+                restored++;
+            }
+        } else if (type == ERecordType::DISTRIBUTION) {
+            std::shared_ptr<Distribution2D> distribution(new Distribution2D());
+            distribution->sampling = reader.read<EDistributionSampling>();
+            distribution->nu = reader.read<int32_t>();
+            distribution->nv = reader.read<int32_t>();
+            distribution->marginalFuncInt = reader.read<double>();
+            reader.readVector(distribution->func);
+            reader.readVector(distribution->rowFuncInt);
+            reader.readVector(distribution->conditionalCdf);
+            reader.readVector(distribution->conditionalBins);
+            reader.readVector(distribution->marginalBins);
+            reader.readVector(distribution->marginalPdf);
+            size_t cells = size_t(distribution->nu) * distribution->nv;
+            bool complete = distribution->func.size() == cells && distribution->rowFuncInt.size() == size_t(distribution->nv) &&
+                            (distribution->sampling == EDistributionSampling::CDF
+                                 ? distribution->conditionalCdf.size() == cells + distribution->nv
+                                 : distribution->conditionalBins.size() == cells);
+            if (upToDate && reader.ok() && complete) {
+                //* the marginal cdf is a single row, cheaper to rebuild than to store
+                if (distribution->sampling == EDistributionSampling::CDF)
+                    distribution->marginal = std::make_unique<Distribution1D>(distribution->rowFuncInt.data(), distribution->nv);
+                DistributionManager::getInstance()->insert(source, distribution);
+                restored++;
+            }
+        } else {
+            break;
+        }
+    }
+    if (!reader.ok())
+        std::cerr << "Scene snapshot " << path << " is truncated, restored " << restored << " resources" << std::endl;
+    return restored;
+}
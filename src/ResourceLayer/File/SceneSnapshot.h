@@ -0,0 +1,32 @@
+/**
+ * @file SceneSnapshot.h
+ * @author agent
+ * @brief Binary snapshot of the loaded scene resources, restored with plain memory copies.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ *
+ */
+#pragma once
+
+#include <string>
+
+/// @brief Writes every mesh, decoded image and sampling distribution held by MeshDataManager,
+/// ImageManager and DistributionManager into one file, and registers them back into the managers
+/// on restore. Derived resources, such as mip levels, compressed meshes and environment map
+/// distributions, are kept under their derived keys.
+/// Layout: header, then one record per resource; every array is 16-byte aligned so the
+/// file can be memory mapped and copied out without parsing.
+/// Each record keeps the size and timestamp of its source file and is skipped on restore if
+/// the source changed. Materials, lights and media are built from the json again and find
+/// their heavy data in the managers; embree BVHs can not be serialized and are rebuilt.
+class SceneSnapshot {
+public:
+    /// @return false if the file can not be written.
+    static bool save(const std::string &path);
+
+    /// @return number of resources restored, 0 if the file is missing or invalid.
+    static int restore(const std::string &path);
+};
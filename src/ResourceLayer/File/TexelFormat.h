@@ -0,0 +1,137 @@
+/**
+ * @file TexelFormat.h
+ * @author agent
+ * @brief Storage formats of image texels and their conversion to linear float.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ *
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include "CoreLayer/ColorSpace/Color.h"
+#include "VertexCompression.h"
+#if defined(__F16C__)
+#   include <immintrin.h>
+#endif
+
+/// @brief How one channel of a texel is stored.
+enum class ETexelFormat : uint8_t {
+    UNORM8,         ///< 8-bit, linear
+    SRGB8,          ///< 8-bit, sRGB transfer function
+    HALF,           ///< IEEE binary16
+    FLOAT           ///< IEEE binary32
+};
+
+namespace TexelFormat {
+
+inline int channelBytes(ETexelFormat format) {
+    switch (format) {
+        case ETexelFormat::UNORM8:
+        case ETexelFormat::SRGB8:
+            return 1;
+        case ETexelFormat::HALF:
+            return 2;
+        default:
+            return 4;
+    }
+}
+
+inline double srgbToLinear(double v) {
+    return v <= 0.04045 ? v / 12.92 : std::pow((v + 0.055) / 1.055, 2.4);
+}
+
+inline double linearToSrgb(double v) {
+    return v <= 0.0031308 ? v * 12.92 : 1.055 * std::pow(v, 1.0 / 2.4) - 0.055;
+}
+
+/// @brief decode table for 8-bit channels, indexed by the stored byte.
+inline const std::array<float, 256> &decodeTable(ETexelFormat format) {
+    static const auto tables = [] {
+        std::array<std::array<float, 256>, 2> t;
+        for (int i = 0; i < 256; ++i) {
+            t[0][i] = i / 255.f;
+            t[1][i] = srgbToLinear(i / 255.0);
+        }
+        return t;
+    }();
+    return tables[format == ETexelFormat::SRGB8];
+}
+
+inline float decodeChannel(const uint8_t *p, ETexelFormat format) {
+    switch (format) {
+        case ETexelFormat::UNORM8:
+        case ETexelFormat::SRGB8:
+            return decodeTable(format)[*p];
+        case ETexelFormat::HALF: {
+            uint16_t h;
+            std::memcpy(&h, p, sizeof(h));
+            return VertexCompression::halfToFloat(h);
+        }
+        default: {
+            float f;
+            std::memcpy(&f, p, sizeof(f));
+            return f;
+        }
+    }
+}
+
+inline void encodeChannel(uint8_t *p, ETexelFormat format, double v) {
+    switch (format) {
+        case ETexelFormat::UNORM8:
+            *p = std::lround(std::clamp(v, 0.0, 1.0) * 255);
+            break;
+        case ETexelFormat::SRGB8:
+            *p = std::lround(linearToSrgb(std::clamp(v, 0.0, 1.0)) * 255);
+            break;
+        case ETexelFormat::HALF: {
+            uint16_t h = VertexCompression::floatToHalf(v);
+            std::memcpy(p, &h, sizeof(h));
+            break;
+        }
+        default: {
+            float f = v;
+            std::memcpy(p, &f, sizeof(f));
+        }
+    }
+}
+
+/// @brief RGB of one texel with any channel count: grey images are replicated, alpha is ignored.
+inline RGB3 decodeRGB(const uint8_t *texel, ETexelFormat format, int channels) {
+    int stride = channelBytes(format);
+    float r = decodeChannel(texel, format);
+    if (channels < 3)
+        return RGB3(r, r, r);
+    return RGB3(r, decodeChannel(texel + stride, format), decodeChannel(texel + 2 * stride, format));
+}
+
+/// @brief store RGB into a texel; grey images keep the red channel, alpha is set to one.
+inline void encodeRGB(uint8_t *texel, ETexelFormat format, int channels, const RGB3 &rgb) {
+    int stride = channelBytes(format);
+    for (int k = 0; k < channels; ++k) {
+        bool isColor = channels < 3 ? k == 0 : k < 3;
+        encodeChannel(texel + k * stride, format, isColor ? rgb[channels < 3 ? 0 : k] : 1.0);
+    }
+}
+
+/// @brief bulk binary32 -> binary16, eight at a time with F16C when the build enables it.
+inline void floatToHalf(const float *src, uint16_t *dst, size_t count) {
+    size_t i = 0;
+#if defined(__F16C__)
+    for (; i + 8 <= count; i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), h);
+    }
+#endif
+    for (; i < count; ++i)
+        dst[i] = VertexCompression::floatToHalf(src[i]);
+}
+
+}// namespace TexelFormat
@@ -0,0 +1,134 @@
+/**
+ * @file VertexCompression.h
+ * @author agent
+ * @brief Compact encodings for per-vertex attributes: octahedral unit vectors and half / 16-bit uv.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ *
+ */
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include "CoreLayer/Geometry/Geometry.h"
+
+namespace VertexCompression {
+
+/// @brief Map [-1,1] to a signed 16-bit integer stored in the low bits of a uint32_t.
+inline uint32_t packSnorm16(double v) {
+    v = std::clamp(v, -1.0, 1.0);
+    return static_cast<uint16_t>(static_cast<int16_t>(std::round(v * 32767.0)));
+}
+
+inline double unpackSnorm16(uint32_t bits) {
+    return std::max(static_cast<int16_t>(bits & 0xFFFF) / 32767.0, -1.0);
+}
+
+/// @brief Octahedral encoding of a unit vector into 32 bits (2 x snorm16).
+/// @see "A Survey of Efficient Representations for Independent Unit Vectors", Cigolle et al. 2014
+inline uint32_t encodeOctahedral(double x, double y, double z) {
+    double invL1 = 1.0 / (std::abs(x) + std::abs(y) + std::abs(z) + 1e-20);
+    double u = x * invL1, v = y * invL1;
+    if (z < 0) {
+        double fu = (1.0 - std::abs(v)) * (u >= 0 ? 1.0 : -1.0);
+        double fv = (1.0 - std::abs(u)) * (v >= 0 ? 1.0 : -1.0);
+        u = fu;
+        v = fv;
+    }
+    return packSnorm16(u) | (packSnorm16(v) << 16);
+}
+
+inline Vec3d decodeOctahedral(uint32_t bits) {
+    double u = unpackSnorm16(bits), v = unpackSnorm16(bits >> 16);
+    double z = 1.0 - std::abs(u) - std::abs(v);
+    if (z < 0) {
+        double fu = (1.0 - std::abs(v)) * (u >= 0 ? 1.0 : -1.0);
+        double fv = (1.0 - std::abs(u)) * (v >= 0 ? 1.0 : -1.0);
+        u = fu;
+        v = fv;
+    }
+    return normalize(Vec3d(u, v, z));
+}
+
+/// @brief IEEE 754 binary32 -> binary16, round to nearest even. Handles inf/nan and denormals.
+inline uint16_t floatToHalf(float value) {
+    uint32_t f;
+    std::memcpy(&f, &value, sizeof(f));
+    uint32_t sign = (f >> 16) & 0x8000;
+    uint32_t absF = f & 0x7FFFFFFF;
+    if (absF >= 0x47800000) {
+        // overflow to inf, keep nan payload non-zero
+        return sign | (absF > 0x7F800000 ? 0x7E00 : 0x7C00);
+    }
+    if (absF < 0x38800000) {
+        // denormal or zero in half precision
+        if (absF < 0x33000000) return sign;
+        uint32_t mant = (absF & 0x007FFFFF) | 0x00800000;
+        int shift = 126 - static_cast<int>(absF >> 23);
+        uint32_t half = mant >> shift;
+        uint32_t rest = mant & ((1u << shift) - 1);
+        uint32_t halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1))) ++half;
+        return sign | half;
+    }
+    uint32_t half = ((absF - 0x38000000) >> 13);
+    uint32_t rest = absF & 0x1FFF;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) ++half;
+    return sign | half;
+}
+
+inline float halfToFloat(uint16_t h) {
+    uint32_t sign = (h & 0x8000u) << 16;
+    uint32_t exp = (h >> 10) & 0x1F;
+    uint32_t mant = h & 0x3FF;
+    uint32_t f;
+    if (exp == 0) {
+        if (mant == 0) {
+            f = sign;
+        } else {
+            // renormalize the denormal
+            exp = 113;
+            while (!(mant & 0x400)) {
+                mant <<= 1;
+                --exp;
+            }
+            f = sign | (exp << 23) | ((mant & 0x3FF) << 13);
+        }
+    } else if (exp == 31) {
+        f = sign | 0x7F800000 | (mant << 13);
+    } else {
+        f = sign | ((exp + 112) << 23) | (mant << 13);
+    }
+    float result;
+    std::memcpy(&result, &f, sizeof(result));
+    return result;
+}
+
+inline uint32_t encodeHalf2(const Point2d &uv) {
+    return floatToHalf(static_cast<float>(uv.x)) |
+           (static_cast<uint32_t>(floatToHalf(static_cast<float>(uv.y))) << 16);
+}
+
+inline Point2d decodeHalf2(uint32_t bits) {
+    return Point2d(halfToFloat(bits & 0xFFFF), halfToFloat(bits >> 16));
+}
+
+/// @brief 16-bit unorm quantization relative to the uv bounds of the mesh.
+inline uint32_t encodeUnorm16x2(const Point2d &uv, const Point2d &uvMin, const Point2d &uvInvExtent) {
+    double u = std::clamp<double>((uv.x - uvMin.x) * uvInvExtent.x, 0.0, 1.0);
+    double v = std::clamp<double>((uv.y - uvMin.y) * uvInvExtent.y, 0.0, 1.0);
+    return static_cast<uint32_t>(std::round(u * 65535.0)) |
+           (static_cast<uint32_t>(std::round(v * 65535.0)) << 16);
+}
+
+inline Point2d decodeUnorm16x2(uint32_t bits, const Point2d &uvMin, const Point2d &uvExtent) {
+    return Point2d(uvMin.x + (bits & 0xFFFF) * (uvExtent.x / 65535.0),
+                   uvMin.y + (bits >> 16) * (uvExtent.y / 65535.0));
+}
+
+}// namespace VertexCompression
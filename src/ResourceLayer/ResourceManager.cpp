@@ -1,4 +1,5 @@
 #include "ResourceManager.h"
+#include "CoreLayer/Profiler/LoadProfiler.h"
 
 #if defined(MESH_LOADER_ASSIMP)
 #   include <assimp/Importer.hpp>
@@ -169,6 +170,44 @@ MeshDataManager::getMeshData(const std::string &path) {
         return ret->second;
     }
 
+    auto result = loadMeshData(path);
+    hash[path]=result;
+    return result;
+}
+
+std::shared_ptr<MeshDataCollection>
+MeshDataManager::getCompressedMeshData(const std::string &path, EUVEncoding uvEncoding) {
+    std::string key = compressedKey(path, uvEncoding);
+    auto ret = hash.find(key);
+    if (ret != hash.end()) {
+        return ret->second;
+    }
+
+    // compress a private copy if the dense data is shared, otherwise load a fresh one.
+    std::shared_ptr<MeshDataCollection> result;
+    auto dense = hash.find(path);
+    if (dense != hash.end()) {
+        result = std::make_shared<MeshDataCollection>();
+        for (const auto &[name, meshData] : *dense->second)
+            (*result)[name] = std::make_shared<MeshData>(*meshData);
+    } else {
+        result = loadMeshData(path);
+    }
+    for (auto &[name, meshData] : *result)
+        meshData->compressAttributes(uvEncoding);
+    hash[key] = result;
+    return result;
+}
+
+std::string MeshDataManager::compressedKey(const std::string &path, EUVEncoding uvEncoding) {
+    return derivedKey(path, uvEncoding == EUVEncoding::Unorm16 ? "compressed-unorm16" : "compressed-half");
+}
+
+/// @brief load meshes from path without caching them in the manager.
+std::shared_ptr<MeshDataCollection>
+MeshDataManager::loadMeshData(const std::string &path) const {
+
+    ProfileScope profile("mesh", path);
     std::shared_ptr<MeshDataCollection> result = std::make_shared<MeshDataCollection>();
 
 #if defined(MESH_LOADER_ASSIMP)
@@ -375,8 +414,10 @@ MeshDataManager::getMeshData(const std::string &path) {
         result->insert(std::make_pair(name, mesh_data));
     }
 #endif
-    hash[path]=result;
-    
+    size_t bytes = 0;
+    for (const auto &[name, meshData] : *result)
+        bytes += meshData->memoryUsage();
+    profile.setBytes(bytes);
     return result;
 }
 
@@ -392,13 +433,56 @@ ImageManager::getInstance(){
 }
 
 std::shared_ptr<Image> ImageManager::getImage(const std::string &path, Image::ImageLoadMode mode){
-    auto ret=hash.find(path);
+    std::string key=imageKey(path,mode);
+    auto ret=hash.find(key);
     if(ret!=hash.end()){
         return ret->second;
     }
 
+    std::shared_ptr<Image> imgPtr=loadImage(path,mode);
+    hash[key]=imgPtr;
+    return imgPtr;
+}
+
+std::shared_ptr<Image> ImageManager::loadImage(const std::string &path, Image::ImageLoadMode mode) const{
+    ProfileScope profile("texture", path);
     Image* img=new Image(path,mode);
-    std::shared_ptr<Image> imgPtr(img);
-    hash[path]=imgPtr;
+    if(img->isHdr)
+        img->convertTo(hdrFormat);
+    profile.setBytes(img->getMemoryUsage());
+    return std::shared_ptr<Image>(img);
+}
+
+std::shared_ptr<Image> ImageManager::getMipLevel(const std::string &path, int level, Image::ImageLoadMode mode) {
+    if (level == 0)
+        return getImage(path, mode);
+    std::string key = derivedKey(imageKey(path, mode), "mip" + std::to_string(level));
+    auto ret = hash.find(key);
+    if (ret != hash.end()) {
+        return ret->second;
+    }
+    std::shared_ptr<Image> imgPtr = getMipLevel(path, level - 1, mode)->downsample();
+    hash[key] = imgPtr;
     return imgPtr;
-}
\ No newline at end of file
+}
+
+std::string ImageManager::imageKey(const std::string &path, Image::ImageLoadMode mode) {
+    switch (mode) {
+        case Image::ImageLoadMode::IMAGE_LOAD_BW:
+            return derivedKey(path, "grey");
+        case Image::ImageLoadMode::IMAGE_LOAD_LINEAR:
+            return derivedKey(path, "linear");
+        default:
+            return path;
+    }
+}
+
+// DistributionManager implemention
+
+std::shared_ptr<DistributionManager> DistributionManager::instance = nullptr;
+
+std::shared_ptr<DistributionManager> DistributionManager::getInstance() {
+    if (!instance)
+        instance.reset(new DistributionManager());
+    return instance;
+}
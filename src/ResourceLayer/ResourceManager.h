@@ -33,17 +33,63 @@ protected:
 
 public:
 	ResourceManager() { };
+
+	/// @brief register an already loaded resource, e.g. one restored from a snapshot.
+	void insert(const std::string &path, std::shared_ptr<BaseType> resource) { hash[path] = resource; }
+
+	/// @return the resource registered under key, null if there is none. Never loads anything.
+	std::shared_ptr<BaseType> find(const std::string &key) const {
+		auto ret = hash.find(key);
+		return ret != hash.end() ? ret->second : nullptr;
+	}
+
+	/// @brief all loaded resources, keyed by full path.
+	const std::map<std::string, std::shared_ptr<BaseType>> &getResources() const { return hash; }
+
+	/// @brief key of a resource derived from the file at path, e.g. a mip level or a compressed copy.
+	static std::string derivedKey(const std::string &path, const std::string &tag) { return path + "|" + tag; }
+
+	/// @brief file a key was loaded or derived from.
+	static std::string sourcePath(const std::string &key) { return key.substr(0, key.find('|')); }
 };
 
 class ImageManager : public ResourceManager<Image>
 {
 	static std::shared_ptr<ImageManager> instance;
 
+	/// @brief storage format of HDR images loaded from now on, float or half.
+	ETexelFormat hdrFormat = ETexelFormat::FLOAT;
+
 public:
 	// @brief singleton pattern get.
 	static std::shared_ptr<ImageManager> getInstance();
 
 	std::shared_ptr<Image> getImage(const std::string &path, Image::ImageLoadMode mode=Image::ImageLoadMode::IMAGE_LOAD_COLOR);
+
+	void setHdrFormat(ETexelFormat format) { hdrFormat = format; }
+
+	/// @brief load an image bypassing the cache, so the caller controls its lifetime.
+	std::shared_ptr<Image> loadImage(const std::string &path, Image::ImageLoadMode mode=Image::ImageLoadMode::IMAGE_LOAD_COLOR) const;
+
+	/// @brief level of the mip pyramid of path, 0 being the image itself. Levels are cached like images.
+	std::shared_ptr<Image> getMipLevel(const std::string &path, int level,
+	                                   Image::ImageLoadMode mode=Image::ImageLoadMode::IMAGE_LOAD_COLOR);
+
+	/// @brief cache key of path loaded in mode; the same file loaded in another mode is another image.
+	static std::string imageKey(const std::string &path, Image::ImageLoadMode mode);
+};
+
+struct Distribution2D;
+
+/// @brief Sampling distributions built from images, e.g. for environment maps.
+/// Keys are derived from the image path, see ResourceManager::derivedKey.
+class DistributionManager : public ResourceManager<Distribution2D>
+{
+	static std::shared_ptr<DistributionManager> instance;
+
+public:
+	// @brief singleton pattern get.
+	static std::shared_ptr<DistributionManager> getInstance();
 };
 
 /// @brief mesh data collection for simplifying.
@@ -58,4 +104,14 @@ public:
 	static std::shared_ptr<MeshDataManager> getInstance();
 
     std::shared_ptr<MeshDataCollection> getMeshData(const std::string &path);
+
+	/// @brief mesh data of path with compressed attributes. It is cached apart from getMeshData,
+	/// so entities loading the same file without compression keep the dense attributes.
+	std::shared_ptr<MeshDataCollection> getCompressedMeshData(const std::string &path, EUVEncoding uvEncoding);
+
+	/// @brief cache key of getCompressedMeshData.
+	static std::string compressedKey(const std::string &path, EUVEncoding uvEncoding);
+
+	/// @brief load a mesh file bypassing the cache, so the caller controls its lifetime.
+	std::shared_ptr<MeshDataCollection> loadMeshData(const std::string &path) const;
 };
@@ -0,0 +1,341 @@
+#include "TextureCache.h"
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "ResourceLayer/ResourceManager.h"
+#include "ResourceLayer/File/FileUtils.h"
+#include "CoreLayer/Profiler/LoadProfiler.h"
+#if !defined(_WIN32)
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+
+namespace {
+
+constexpr char TILE_CACHE_MAGIC[8] = {'M', 'O', 'E', 'R', 'T', 'I', 'L', 'E'};
+constexpr uint32_t TILE_CACHE_VERSION = 2;
+constexpr size_t TILE_CACHE_ALIGN = 16;
+
+/// @brief fixed part of the cache file header, followed by levelCount x (width, height).
+struct TileCacheHeader {
+    char magic[8];
+    uint32_t version;
+    int32_t tileSize;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    int32_t levelCount;
+    int32_t channels;
+    ETexelFormat format;
+    uint8_t padding[7];
+};
+
+uint64_t alignOffset(uint64_t offset) {
+    return (offset + TILE_CACHE_ALIGN - 1) / TILE_CACHE_ALIGN * TILE_CACHE_ALIGN;
+}
+
+size_t tileBytes(int tileSize, int channels, ETexelFormat format) {
+    return size_t(tileSize) * tileSize * channels * TexelFormat::channelBytes(format);
+}
+
+}// namespace
+
+// TiledImage implemention
+
+TiledImage::~TiledImage() {
+#if !defined(_WIN32)
+    if (fd >= 0) close(fd);
+#endif
+}
+
+bool TiledImage::openCacheFile() {
+    std::ifstream in(cachePath, std::ios::binary);
+    if (!in) return false;
+    TileCacheHeader header{};
+    in.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (!in || std::memcmp(header.magic, TILE_CACHE_MAGIC, 8) != 0 || header.version != TILE_CACHE_VERSION)
+        return false;
+    uint64_t sourceSize;
+    int64_t sourceTime;
+    if (!FileUtils::getFileStamp(sourcePath, sourceSize, sourceTime) ||
+        sourceSize != header.sourceSize || sourceTime != header.sourceTime)
+        return false;
+    if (header.tileSize <= 0 || (header.tileSize & (header.tileSize - 1)) || header.levelCount <= 0 ||
+        header.channels <= 0 || header.channels > 4 || header.format > ETexelFormat::FLOAT)
+        return false;
+
+    tileSize = header.tileSize;
+    channels = header.channels;
+    format = header.format;
+    tileShift = 0;
+    while ((1 << tileShift) < tileSize) ++tileShift;
+    levels.resize(header.levelCount);
+    uint64_t tileCount = 0;
+    for (auto &level : levels) {
+        std::array<int32_t, 2> resolution;
+        in.read(reinterpret_cast<char *>(resolution.data()), sizeof(resolution));
+        level.resolution = Point2i(resolution[0], resolution[1]);
+        level.tilesX = (resolution[0] + tileSize - 1) >> tileShift;
+        level.tilesY = (resolution[1] + tileSize - 1) >> tileShift;
+        level.firstTile = tileCount;
+        tileCount += uint64_t(level.tilesX) * level.tilesY;
+    }
+    if (!in) return false;
+    dataOffset = alignOffset(sizeof(TileCacheHeader) + levels.size() * 2 * sizeof(int32_t));
+
+    uint64_t cacheSize;
+    int64_t cacheTime;
+    if (!FileUtils::getFileStamp(cachePath, cacheSize, cacheTime) ||
+        cacheSize < dataOffset + tileCount * tileBytes(tileSize, channels, format))
+        return false;
+#if defined(_WIN32)
+    file.open(cachePath, std::ios::binary);
+    return file.good();
+#else
+    fd = ::open(cachePath.c_str(), O_RDONLY);
+    return fd >= 0;
+#endif
+}
+
+std::shared_ptr<const TextureTile> TiledImage::readTile(uint64_t tileIndex) const {
+    auto tile = std::make_shared<TextureTile>();
+    tile->tileSize = tileSize;
+    tile->channels = channels;
+    tile->format = format;
+    size_t bytes = tileBytes(tileSize, channels, format);
+    tile->texels.resize(bytes);
+    uint64_t offset = dataOffset + tileIndex * bytes;
+    bool ok;
+#if defined(_WIN32)
+    {
+        std::lock_guard<std::mutex> lock(fileMutex);
+        file.seekg(offset);
+        file.read(reinterpret_cast<char *>(tile->texels.data()), bytes);
+        ok = file.good();
+        file.clear();
+    }
+#else
+    ok = pread(fd, tile->texels.data(), bytes, offset) == ssize_t(bytes);
+#endif
+    if (!ok)
+        std::cerr << "Fail to read tile " << tileIndex << " of " << cachePath << std::endl;
+    return tile;
+}
+
+std::shared_ptr<const TextureTile> TiledImage::getTile(int level, const Point2i &p) const {
+    const Level &l = levels[level];
+    uint64_t index = l.firstTile + uint64_t(p.y >> tileShift) * l.tilesX + (p.x >> tileShift);
+    return cache->getTile(*this, index);
+}
+
+RGB3 TiledImage::texel(int level, const Point2i &p) const {
+    int mask = tileSize - 1;
+    return getTile(level, p)->at(p.x & mask, p.y & mask);
+}
+
+RGB3 TiledImage::bilinear(int level, const Point2d &uv) const {
+    int w = getWidth(level), h = getHeight(level);
+    double u = uv.x * w - 0.5, v = uv.y * h - 0.5;
+    int iu0 = std::floor(u), iv0 = std::floor(v);
+    u -= iu0;
+    v -= iv0;
+    int xs[2] = {clamp(iu0, 0, w - 1), clamp(iu0 + 1, 0, w - 1)};
+    int ys[2] = {clamp(iv0, 0, h - 1), clamp(iv0 + 1, 0, h - 1)};
+
+    //* only fetch again when a texel crosses into another tile
+    int mask = tileSize - 1;
+    Point2i tileCoord(-1, -1);
+    std::shared_ptr<const TextureTile> tile;
+    RGB3 c[4];
+    for (int j = 0; j < 2; ++j)
+        for (int i = 0; i < 2; ++i) {
+            Point2i p(xs[i], ys[j]);
+            if ((p.x >> tileShift) != tileCoord.x || (p.y >> tileShift) != tileCoord.y) {
+                tileCoord = Point2i(p.x >> tileShift, p.y >> tileShift);
+                tile = getTile(level, p);
+            }
+            c[2 * j + i] = tile->at(p.x & mask, p.y & mask);
+        }
+    return lerp(c[0], c[1], c[2], c[3], u, v);
+}
+
+// TextureCache implemention
+
+std::shared_ptr<TextureCache> TextureCache::instance = nullptr;
+
+std::shared_ptr<TextureCache> TextureCache::getInstance() {
+    if (!instance)
+        instance.reset(new TextureCache());
+    return instance;
+}
+
+void TextureCache::setTileSize(int size) {
+    tileSize = 8;
+    while (tileSize < size && tileSize < 1024) tileSize <<= 1;
+}
+
+std::string TextureCache::getCachePath(const std::string &sourcePath, Image::ImageLoadMode mode) const {
+    //* other load modes get cache files of their own, e.g. normal.png.linear.tiles
+    std::string key = ImageManager::imageKey(sourcePath, mode);
+    std::string suffix = (key.size() > sourcePath.size() ? "." + key.substr(sourcePath.size() + 1) : "") + ".tiles";
+    if (cacheDirectory.empty())
+        return sourcePath + suffix;
+    //* the hash of the full path keeps images with the same file name apart
+    std::error_code ec;
+    std::filesystem::path source = std::filesystem::absolute(sourcePath, ec);
+    std::ostringstream name;
+    name << source.filename().string() << "." << std::hex << std::hash<std::string>()(source.string()) << suffix;
+    return (std::filesystem::path(cacheDirectory) / name.str()).string();
+}
+
+bool TextureCache::convert(const std::string &sourcePath, const std::string &cachePath, Image::ImageLoadMode mode) const {
+    ProfileScope profile("texture tiling", sourcePath);
+    TileCacheHeader header{};
+    std::memcpy(header.magic, TILE_CACHE_MAGIC, 8);
+    header.version = TILE_CACHE_VERSION;
+    header.tileSize = tileSize;
+    if (!FileUtils::getFileStamp(sourcePath, header.sourceSize, header.sourceTime))
+        return false;
+
+    std::shared_ptr<const Image> image = ImageManager::getInstance()->loadImage(sourcePath, mode);
+    header.channels = image->getChannels();
+    header.format = image->getFormat();
+    std::vector<std::array<int32_t, 2>> resolutions{{image->getWidth(), image->getHeight()}};
+    while (resolutions.back()[0] > 1 || resolutions.back()[1] > 1)
+        resolutions.push_back({std::max(1, resolutions.back()[0] / 2), std::max(1, resolutions.back()[1] / 2)});
+    header.levelCount = resolutions.size();
+
+    //* write to a temporary file so an interrupted conversion never leaves a valid looking cache
+    std::string tmpPath = cachePath + ".tmp";
+    std::error_code ec;
+    std::filesystem::path cacheParent = std::filesystem::path(cachePath).parent_path();
+    if (!cacheParent.empty())
+        std::filesystem::create_directories(cacheParent, ec);
+    {
+        std::ofstream out(tmpPath, std::ios::binary);
+        if (!out) return false;
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(resolutions.data()), resolutions.size() * sizeof(resolutions[0]));
+        uint64_t offset = sizeof(header) + resolutions.size() * sizeof(resolutions[0]);
+        static const char zeros[TILE_CACHE_ALIGN] = {};
+        out.write(zeros, alignOffset(offset) - offset);
+
+        int bytesPerPixel = image->getBytesPerPixel();
+        std::vector<uint8_t> tile(tileBytes(tileSize, header.channels, header.format));
+        for (int level = 0; level < header.levelCount; ++level) {
+            if (level > 0) image = image->downsample();
+            int w = image->getWidth(), h = image->getHeight();
+            for (int ty = 0; ty < (h + tileSize - 1) / tileSize; ++ty)
+                for (int tx = 0; tx < (w + tileSize - 1) / tileSize; ++tx) {
+                    //* border tiles repeat the last row and column
+                    for (int y = 0; y < tileSize; ++y)
+                        for (int x = 0; x < tileSize; ++x) {
+                            Point2i p(std::min(tx * tileSize + x, w - 1), std::min(ty * tileSize + y, h - 1));
+                            std::memcpy(&tile[(x + y * tileSize) * bytesPerPixel], image->getPixelData(p), bytesPerPixel);
+                        }
+                    out.write(reinterpret_cast<const char *>(tile.data()), tile.size());
+                }
+        }
+        if (!out) {
+            out.close();
+            std::filesystem::remove(tmpPath, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(tmpPath, cachePath, ec);
+    if (ec) {
+        std::filesystem::remove(tmpPath, ec);
+        return false;
+    }
+    profile.setBytes(std::filesystem::file_size(cachePath, ec));
+    return true;
+}
+
+std::shared_ptr<TiledImage> TextureCache::open(const std::string &path, Image::ImageLoadMode mode) {
+    std::lock_guard<std::mutex> lock(openMutex);
+    std::string key = ImageManager::imageKey(path, mode);
+    auto found = images.find(key);
+    if (found != images.end())
+        return found->second;
+
+    std::shared_ptr<TiledImage> image(new TiledImage());
+    image->sourcePath = path;
+    image->cachePath = getCachePath(path, mode);
+    if (!image->openCacheFile()) {
+        std::cout << "Converting " << path << " to tiled texture cache" << std::endl;
+        if (!convert(path, image->cachePath, mode) || !image->openCacheFile()) {
+            //* remembered as null so the other textures using this image do not retry the conversion
+            std::cerr << "Can not build tiled texture cache " << image->cachePath
+                      << ", loading " << path << " into memory instead" << std::endl;
+            images[key] = nullptr;
+            return nullptr;
+        }
+    }
+    image->cache = this;
+    image->id = images.size();
+    images[key] = image;
+    return image;
+}
+
+std::shared_ptr<const TextureTile> TextureCache::getTile(const TiledImage &image, uint64_t tileIndex) {
+    uint64_t key = (uint64_t(image.id) << 40) | tileIndex;
+    Shard &shard = shards[((key * 0x9E3779B97F4A7C15ull) >> 32) % SHARD_COUNT];
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.map.find(key);
+        if (it != shard.map.end()) {
+            shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+            image.hits.fetch_add(1, std::memory_order_relaxed);
+            return it->second->tile;
+        }
+    }
+    image.misses.fetch_add(1, std::memory_order_relaxed);
+    auto tile = image.readTile(tileIndex);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.map.find(key);
+    if (it != shard.map.end()) {
+        //* another thread read the same tile meanwhile
+        shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+        return it->second->tile;
+    }
+    shard.lru.push_front({key, tile});
+    shard.map[key] = shard.lru.begin();
+    shard.bytes += tile->texels.size();
+    //* evicted tiles stay alive until the lookups holding them finish
+    size_t shardBudget = budget / SHARD_COUNT;
+    while (shard.bytes > shardBudget && shard.lru.size() > 1) {
+        const Entry &victim = shard.lru.back();
+        shard.bytes -= victim.tile->texels.size();
+        shard.map.erase(victim.key);
+        shard.lru.pop_back();
+    }
+    return tile;
+}
+
+size_t TextureCache::getResidentBytes() const {
+    size_t bytes = 0;
+    for (auto &shard : shards) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        bytes += shard.bytes;
+    }
+    return bytes;
+}
+
+void TextureCache::printStatistics(std::ostream &os) const {
+    std::lock_guard<std::mutex> lock(openMutex);
+    if (images.empty()) return;
+    os << "texture cache: " << getResidentBytes() / (1024.0 * 1024.0) << " MB resident, budget "
+       << budget / (1024.0 * 1024.0) << " MB\n";
+    for (const auto &[path, image] : images) {
+        if (!image) continue;
+        uint64_t hits = image->hits.load(), misses = image->misses.load();
+        uint64_t requests = hits + misses;
+        os << "  " << path << " " << image->getWidth() << "x" << image->getHeight()
+           << ", " << requests << " tile requests, hit rate "
+           << std::fixed << std::setprecision(2) << (requests ? 100.0 * hits / requests : 0.0) << "%\n"
+           << std::defaultfloat;
+    }
+}
@@ -0,0 +1,170 @@
+/**
+ * @file TextureCache.h
+ * @author agent
+ * @brief On-demand tiled texture storage under a memory budget.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ *
+ */
+#pragma once
+
+#include <atomic>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "CoreLayer/ColorSpace/Color.h"
+#include "CoreLayer/Geometry/Geometry.h"
+#include "ResourceLayer/File/Image.h"
+#include "ResourceLayer/File/TexelFormat.h"
+
+class TextureCache;
+
+/// @brief One square block of texels of a mip level, in the format of the source image.
+/// Border tiles are padded to full size.
+struct TextureTile {
+    std::vector<uint8_t> texels;
+    int tileSize;
+    int channels;
+    ETexelFormat format;
+
+    RGB3 at(int x, int y) const {
+        int bytesPerPixel = channels * TexelFormat::channelBytes(format);
+        return TexelFormat::decodeRGB(&texels[(x + y * tileSize) * bytesPerPixel], format, channels);
+    }
+};
+
+/// @brief A mip-mapped image stored as tiles in a cache file, next to its source or in the cache directory.
+/// Only the tiles touched by lookups are read, through the TextureCache.
+/// The cache file is written once from the source image and rebuilt when the source changes:
+/// header, per-level resolution, then every tile of every level in order, row major.
+class TiledImage {
+    friend class TextureCache;
+
+public:
+    ~TiledImage();
+
+    int getWidth(int level = 0) const { return levels[level].resolution.x; }
+
+    int getHeight(int level = 0) const { return levels[level].resolution.y; }
+
+    int getLevels() const { return levels.size(); }
+
+    const std::string &getSourcePath() const { return sourcePath; }
+
+    RGB3 texel(int level, const Point2i &p) const;
+
+    /// @brief bilinear lookup with clamped borders; the four texels usually share one tile.
+    RGB3 bilinear(int level, const Point2d &uv) const;
+
+private:
+    struct Level {
+        Point2i resolution;
+        int tilesX, tilesY;
+        uint64_t firstTile;         ///< index of the first tile of this level in the file
+    };
+
+    TiledImage() = default;
+
+    /// @brief read the header of the cache file and open it for tile reads.
+    /// @return false if the file is missing, corrupt, or older than its source.
+    bool openCacheFile();
+
+    /// @brief read one tile from the cache file, called by the cache on a miss.
+    std::shared_ptr<const TextureTile> readTile(uint64_t tileIndex) const;
+
+    std::shared_ptr<const TextureTile> getTile(int level, const Point2i &p) const;
+
+    std::string sourcePath, cachePath;
+    TextureCache *cache = nullptr;
+    uint32_t id = 0;
+    int tileSize = 0, tileShift = 0;
+    int channels = 3;
+    ETexelFormat format = ETexelFormat::FLOAT;
+    std::vector<Level> levels;
+    uint64_t dataOffset = 0;
+#if defined(_WIN32)
+    mutable std::mutex fileMutex;
+    mutable std::ifstream file;
+#else
+    int fd = -1;
+#endif
+
+    mutable std::atomic<uint64_t> hits{0}, misses{0};
+};
+
+/// @brief Resident tiles of all tiled images. Tiles are spread over independently locked shards,
+/// each with its own LRU list and an equal part of the budget, so render threads rarely contend
+/// and a miss only blocks the shard while the tile is inserted, not while it is read from disk.
+class TextureCache {
+    static std::shared_ptr<TextureCache> instance;
+
+public:
+    // @brief singleton pattern get.
+    static std::shared_ptr<TextureCache> getInstance();
+
+    void setBudget(size_t bytes) { budget = bytes; }
+
+    size_t getBudget() const { return budget; }
+
+    /// @brief tile edge in texels for newly converted images, rounded up to a power of two.
+    void setTileSize(int size);
+
+    /// @brief whether image textures without an explicit "tiled" field go through the cache.
+    void setTiledByDefault(bool tiled) { tiledByDefault = tiled; }
+
+    bool isTiledByDefault() const { return tiledByDefault; }
+
+    /// @brief directory for the tile cache files, created on demand.
+    /// Empty (the default) writes them next to their source images.
+    void setCacheDirectory(const std::string &directory) { cacheDirectory = directory; }
+
+    /// @brief open the tiled version of an image, converting it first if the cache file is missing or stale.
+    /// @param mode how the texels are decoded, see Image::ImageLoadMode; each mode has its own cache file.
+    /// @return nullptr if the cache file can not be written, e.g. in a read-only directory;
+    /// callers then keep the image in memory.
+    std::shared_ptr<TiledImage> open(const std::string &path,
+                                     Image::ImageLoadMode mode = Image::ImageLoadMode::IMAGE_LOAD_COLOR);
+
+    std::shared_ptr<const TextureTile> getTile(const TiledImage &image, uint64_t tileIndex);
+
+    size_t getResidentBytes() const;
+
+    /// @brief per-texture lookup count and tile hit rate.
+    void printStatistics(std::ostream &os) const;
+
+private:
+    static constexpr int SHARD_COUNT = 32;
+
+    struct Entry {
+        uint64_t key;
+        std::shared_ptr<const TextureTile> tile;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::list<Entry> lru;           ///< most recently used first
+        std::unordered_map<uint64_t, std::list<Entry>::iterator> map;
+        size_t bytes = 0;
+    };
+
+    std::string getCachePath(const std::string &sourcePath, Image::ImageLoadMode mode) const;
+
+    bool convert(const std::string &sourcePath, const std::string &cachePath, Image::ImageLoadMode mode) const;
+
+    mutable Shard shards[SHARD_COUNT];
+    size_t budget = size_t(1) << 30;
+    int tileSize = 64;
+    bool tiledByDefault = false;
+    std::string cacheDirectory;
+
+    mutable std::mutex openMutex;
+    std::unordered_map<std::string, std::shared_ptr<TiledImage>> images;
+};
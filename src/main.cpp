@@ -3,11 +3,15 @@
 #include "FunctionLayer/Integrator/PathIntegrator-new.h"
 #include "FunctionLayer/Integrator/NormalIntegrator.h"
 #include "FunctionLayer/Integrator/VolPathIntegrator.h"
+#include "FunctionLayer/Integrator/ReSTIRIntegrator.h"
 #include "FunctionLayer/Sampler/Halton.h"
 #include "ResourceLayer/File/FileUtils.h"
+#include "ResourceLayer/File/SceneSnapshot.h"
 #include "FunctionLayer/TileGenerator/SequenceTileGenerator.h"
 #include "FunctionLayer/Sampler/Independent.h"
 #include "FunctionLayer/Camera/CameraFactory.h"
+#include "CoreLayer/Profiler/LoadProfiler.h"
+#include "ResourceLayer/TextureCache.h"
 
 struct RenderSettings {
     int spp;
@@ -23,39 +27,67 @@ struct TimeCounter {
     TimeCounter() {
         start = std::chrono::high_resolution_clock::now();
     }
+    double elapsedSeconds() const {
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+        return elapsed.count();
+    }
     void Done() {
-        std::chrono::time_point end = std::chrono::high_resolution_clock::now();
-        auto sToken = std::chrono::duration_cast<std::chrono::seconds>(end - start).count();
         std::cout << "rendering done take\n"
-                  << sToken << "s";
+                  << elapsedSeconds() << "s";
     }
 };
 
 struct Render {
 public:
-    static void RenderScene(const std::string sceneWorkingDir) {
+    /// @param writeSnapshot store the loaded resources in scene.snapshot; otherwise an existing snapshot is restored.
+    static void RenderScene(const std::string sceneWorkingDir, bool writeSnapshot = false) {
         TimeCounter renderClock;
 
         FileUtils::setWorkingDir(sceneWorkingDir + "/");
+        LoadProfiler::getInstance()->reset();
+        LoadProfiler::getInstance()->setEnabled(true);
+        std::string snapshotPath = FileUtils::getWorkingDir() + "scene.snapshot";
+        if (!writeSnapshot) {
+            int restored = SceneSnapshot::restore(snapshotPath);
+            if (restored > 0)
+                std::cout << "restored " << restored << " resources from " << snapshotPath << std::endl;
+        }
         Json sceneJson;
-        std::ifstream sceneFile(FileUtils::getWorkingDir() + std::string("scene.json"));
-        sceneFile >> sceneJson;
+        {
+            ProfileScope profile("json", FileUtils::getWorkingDir() + std::string("scene.json"));
+            std::ifstream sceneFile(FileUtils::getWorkingDir() + std::string("scene.json"));
+            sceneFile >> sceneJson;
+        }
         std::shared_ptr<Scene> scene = std::make_shared<Scene>(sceneJson);
         std::cout << "scene created" << std::endl;
         std::cout << "building accelerator" << std::endl;
         scene->build();
-        std::cout << "scene prepared" << std::endl;
+        std::cout << "scene prepared in " << renderClock.elapsedSeconds() << "s" << std::endl;
+        if (writeSnapshot && SceneSnapshot::save(snapshotPath))
+            std::cout << "snapshot written to " << snapshotPath << std::endl;
 
         const Json &settingsJson = sceneJson["renderer"];
         settings = new RenderSettings(settingsJson);
+        LoadProfiler::getInstance()->print(std::cout);
+        LoadProfiler::getInstance()->saveJson(settings->outputPath + "_load_profile.json");
+        // the report is out; out-of-core meshes reloaded by render threads would only grow it
+        LoadProfiler::getInstance()->setEnabled(false);
         auto camera = CameraFactory::LoadCameraFromJson(sceneJson["camera"]);
         Point2i resolution = getOptional(sceneJson["camera"], "resolution", Point2i(512, 512));
-        VolPathIntegrator integrator(camera, std::make_unique<Film>(resolution, 3),
-                                     std::make_unique<SequenceTileGenerator>(resolution), std::make_shared<IndependentSampler>(settings->spp, 5), settings->spp, 12);
+        // "integrator": "volpath" (default) or "restir", the latter configured by "restir": { ... }
+        std::unique_ptr<Integrator> integrator;
+        if (getOptional(settingsJson, "integrator", std::string("volpath")) == "restir")
+            integrator = std::make_unique<ReSTIRIntegrator>(camera, std::make_unique<Film>(resolution, 3),
+                                                            std::make_unique<SequenceTileGenerator>(resolution), std::make_shared<IndependentSampler>(settings->spp, 5), settings->spp, 12,
+                                                            getOptional(settingsJson, "restir", Json()));
+        else
+            integrator = std::make_unique<VolPathIntegrator>(camera, std::make_unique<Film>(resolution, 3),
+                                                             std::make_unique<SequenceTileGenerator>(resolution), std::make_shared<IndependentSampler>(settings->spp, 5), settings->spp, 12);
 
         std::cout << "start rendering" << std::endl;
-        integrator.render(scene);
-        integrator.save(settings->outputPath);
+        integrator->render(scene);
+        integrator->save(settings->outputPath);
+        TextureCache::getInstance()->printStatistics(std::cout);
         std::cout << "finish" << std::endl;
         renderClock.Done();
     }
@@ -67,7 +99,14 @@ RenderSettings *Render::settings = nullptr;
 int main(int argc, const char *argv[]) {
     Spectrum::init();
     std::vector<std::string> filenames;
+    bool writeSnapshot = false;
     for (int i = 1; i < argc; ++i) {
-        Render::RenderScene(argv[i]);
+        if (std::string(argv[i]) == "--snapshot")
+            writeSnapshot = true;
+        else
+            filenames.emplace_back(argv[i]);
+    }
+    for (const auto &filename : filenames) {
+        Render::RenderScene(filename, writeSnapshot);
     }
 }
\ No newline at end of file
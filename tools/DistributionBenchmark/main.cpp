@@ -0,0 +1,109 @@
+/**
+ * @file main.cpp
+ * @author agent
+ * @brief Sampling throughput of Distribution2D, alias tables against binary search.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ *
+ */
+
+#include "FunctionLayer/Distribution/Distribution.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+//* Usage: DistributionBenchmark [width] [height] [samples]
+//* The distribution is a synthetic environment map: a sky gradient, a small bright sun and a black
+//* lower hemisphere, weighted by sin(theta) as InfiniteSphereLight does.
+
+/// @brief Distribution2D as it was before the contiguous storage: one heap allocated
+/// Distribution1D per row and binary searches for both dimensions.
+struct LegacyDistribution2D {
+    LegacyDistribution2D(const double *data, int nu, int nv) {
+        std::vector<double> marginalFunc;
+        for (int v = 0; v < nv; ++v) {
+            conditional.emplace_back(new Distribution1D(&data[size_t(v) * nu], nu));
+            marginalFunc.push_back(conditional[v]->funcInt);
+        }
+        marginal.reset(new Distribution1D(marginalFunc.data(), nv));
+    }
+
+    Point2d SampleContinuous(const Point2d &u, double *pdf) const {
+        double pdfs[2];
+        int v;
+        double d1 = marginal->SampleContinuous(u[1], &pdfs[1], &v);
+        double d0 = conditional[v]->SampleContinuous(u[0], &pdfs[0]);
+        *pdf = pdfs[0] * pdfs[1];
+        return Point2d(d0, d1);
+    }
+
+    std::vector<std::unique_ptr<Distribution1D>> conditional;
+    std::unique_ptr<Distribution1D> marginal;
+};
+
+static std::vector<double> environment(int nu, int nv) {
+    std::vector<double> data(size_t(nu) * nv);
+    for (int v = 0; v < nv; ++v) {
+        double theta = M_PI * (v + 0.5) / nv;
+        for (int u = 0; u < nu; ++u) {
+            double phi = 2 * M_PI * (u + 0.5) / nu;
+            double sky = theta < M_PI / 2 ? 0.2 + 0.8 * std::cos(theta) : 0.0;
+            double sunDistance = std::hypot(theta - 0.6, std::min(std::abs(phi - 1.0), 2 * M_PI - std::abs(phi - 1.0)));
+            double sun = sunDistance < 0.02 ? 5e4 : 0.0;
+            data[size_t(v) * nu + u] = (sky + sun) * std::sin(theta);
+        }
+    }
+    return data;
+}
+
+template<typename Distribution>
+static void run(const char *name, const Distribution &distribution, const std::vector<Point2d> &samples) {
+    double checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const Point2d &u : samples) {
+        double pdf;
+        Point2d p = distribution.SampleContinuous(u, &pdf);
+        checksum += p[0] + p[1] + pdf;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%-8s %8.2f ns/sample  %8.2f Msamples/s  (checksum %.6g)\n",
+                name, 1e9 * seconds / samples.size(), samples.size() / seconds * 1e-6, checksum);
+}
+
+template<typename Build>
+static auto timeBuild(const char *name, const Build &build) {
+    auto start = std::chrono::steady_clock::now();
+    auto distribution = build();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%-8s build %8.2f ms\n", name, seconds * 1e3);
+    return distribution;
+}
+
+int main(int argc, char **argv) {
+    int nu = argc > 1 ? std::atoi(argv[1]) : 2048;
+    int nv = argc > 2 ? std::atoi(argv[2]) : 1024;
+    size_t count = argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 16u << 20;
+    std::printf("%dx%d distribution, %zu samples\n", nu, nv, count);
+
+    std::vector<double> data = environment(nu, nv);
+    //* drawn up front so the random number generator is not part of the timing
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<Point2d> samples(count);
+    for (Point2d &u : samples)
+        u = Point2d(uniform(rng), uniform(rng));
+
+    auto legacy = timeBuild("legacy", [&] { return LegacyDistribution2D(data.data(), nu, nv); });
+    auto cdf = timeBuild("cdf", [&] { return Distribution2D(data.data(), nu, nv, EDistributionSampling::CDF); });
+    auto alias = timeBuild("alias", [&] { return Distribution2D(data.data(), nu, nv, EDistributionSampling::ALIAS); });
+
+    run("legacy", legacy, samples);
+    run("cdf", cdf, samples);
+    run("alias", alias, samples);
+    return 0;
+}
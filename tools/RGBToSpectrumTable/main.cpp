@@ -0,0 +1,49 @@
+/**
+ * @file main.cpp
+ * @author agent
+ * @brief Build step that fits the rgb to spectrum table and writes it as a source file.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright NJUMeta (c) 2022
+ * www.njumeta.com
+ *
+ */
+
+#include "CoreLayer/ColorSpace/Color.h"
+#include "CoreLayer/ColorSpace/RGBToSpectrum.h"
+#include <cstdio>
+
+//* Built with the same spectrum settings as Moer, so that the table matches its bins.
+//* Usage: RGBToSpectrumTable <output.cpp>
+
+static void writeArray(FILE *file, const char *name, const float *values, size_t count)
+{
+    std::fprintf(file, "static const float %s[%zu] = {\n", name, count);
+    for (size_t i = 0; i < count; i++)
+        std::fprintf(file, "%.9g,%s", values[i], i % 8 == 7 ? "\n" : " ");
+    std::fprintf(file, "};\n\n");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 2) {
+        std::fprintf(stderr, "usage: %s <output.cpp>\n", argv[0]);
+        return 1;
+    }
+    FILE *file = std::fopen(argv[1], "w");
+    if (!file) {
+        std::fprintf(stderr, "cannot write %s\n", argv[1]);
+        return 1;
+    }
+
+    SampledSpectrum::init();
+    const RGBToSpectrumTable *table = RGBToSpectrumTable::get();
+
+    std::fprintf(file, "// Generated by tools/RGBToSpectrumTable for %d spectrum samples, do not edit.\n\n", nSpectrumSamples);
+    std::fprintf(file, "#include \"CoreLayer/ColorSpace/RGBToSpectrum.h\"\n\n");
+    writeArray(file, "fittedZNodes", table->getZNodes(), RGBToSpectrumTable::resolution);
+    writeArray(file, "fittedCoefficients", table->getCoefficients(), RGBToSpectrumTable::coefficientCount);
+    std::fprintf(file, "const RGBToSpectrumTable RGBToSpectrumTable::precomputed(fittedZNodes, fittedCoefficients);\n");
+    return std::fclose(file) == 0 ? 0 : 1;
+}